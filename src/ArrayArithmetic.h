@@ -23,12 +23,19 @@
 #ifndef _ARRAY_ARITHMETIC_H_
 #define _ARRAY_ARITHMETIC_H_
 
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
 #if __APPLE__
 // The Accelerate framework is a library of tuned vector operations
 #include <Accelerate/Accelerate.h>
 #endif
 #if __SSE__
 #include <xmmintrin.h>
+#if __SSE2__
+#include <emmintrin.h>
+#endif
 #elif __ARM_NEON__
 // __ARM_NEON__ is defined by the compiler if the arguments "-mfloat-abi=softfp -mfpu=neon" are passed.
 #include <arm_neon.h>
@@ -158,6 +165,82 @@ class ArrayArithmetic {
       #endif
     }
     
+    /**
+     * output = inputs[0] + inputs[1] + ... + inputs[numInputs-1], where numInputs is at least one.
+     * Each output sample is written once, instead of once per pairwise addition.
+     */
+    static inline void sum(float **inputs, int numInputs, float *output, int startIndex, int endIndex) {
+      #if __APPLE__
+      if (numInputs == 1) {
+        memcpy(output+startIndex, inputs[0]+startIndex, (endIndex-startIndex)*sizeof(float));
+        return;
+      }
+      vDSP_vadd(inputs[0]+startIndex, 1, inputs[1]+startIndex, 1, output+startIndex, 1, endIndex-startIndex);
+      for (int k = 2; k < numInputs; k++) {
+        vDSP_vadd(output+startIndex, 1, inputs[k]+startIndex, 1, output+startIndex, 1, endIndex-startIndex);
+      }
+      #elif __SSE__
+      int i = startIndex;
+      
+      // align buffer to 16-byte boundary
+      for (; (i & 0x3) && i < endIndex; i++) {
+        float s = inputs[0][i];
+        for (int k = 1; k < numInputs; k++) s += inputs[k][i];
+        output[i] = s;
+      }
+      
+      // four vectors are accumulated in registers for each pass over the inputs
+      for (; i + 16 <= endIndex; i += 16) {
+        __m128 acc0 = _mm_load_ps(inputs[0]+i);
+        __m128 acc1 = _mm_load_ps(inputs[0]+i+4);
+        __m128 acc2 = _mm_load_ps(inputs[0]+i+8);
+        __m128 acc3 = _mm_load_ps(inputs[0]+i+12);
+        for (int k = 1; k < numInputs; k++) {
+          float *input = inputs[k]+i;
+          acc0 = _mm_add_ps(acc0, _mm_load_ps(input));
+          acc1 = _mm_add_ps(acc1, _mm_load_ps(input+4));
+          acc2 = _mm_add_ps(acc2, _mm_load_ps(input+8));
+          acc3 = _mm_add_ps(acc3, _mm_load_ps(input+12));
+        }
+        _mm_store_ps(output+i, acc0);
+        _mm_store_ps(output+i+4, acc1);
+        _mm_store_ps(output+i+8, acc2);
+        _mm_store_ps(output+i+12, acc3);
+      }
+      for (; i + 4 <= endIndex; i += 4) {
+        __m128 acc = _mm_load_ps(inputs[0]+i);
+        for (int k = 1; k < numInputs; k++) acc = _mm_add_ps(acc, _mm_load_ps(inputs[k]+i));
+        _mm_store_ps(output+i, acc);
+      }
+      
+      for (; i < endIndex; i++) {
+        float s = inputs[0][i];
+        for (int k = 1; k < numInputs; k++) s += inputs[k][i];
+        output[i] = s;
+      }
+      #elif __ARM_NEON__
+      int i = startIndex;
+      for (; i + 4 <= endIndex; i += 4) {
+        float32x4_t acc = vld1q_f32((const float32_t *) (inputs[0]+i));
+        for (int k = 1; k < numInputs; k++) {
+          acc = vaddq_f32(acc, vld1q_f32((const float32_t *) (inputs[k]+i)));
+        }
+        vst1q_f32((float32_t *) (output+i), acc);
+      }
+      for (; i < endIndex; i++) {
+        float s = inputs[0][i];
+        for (int k = 1; k < numInputs; k++) s += inputs[k][i];
+        output[i] = s;
+      }
+      #else
+      for (int i = startIndex; i < endIndex; i++) {
+        float s = inputs[0][i];
+        for (int k = 1; k < numInputs; k++) s += inputs[k][i];
+        output[i] = s;
+      }
+      #endif
+    }
+    
     // output = input0 - input1
     static inline void subtract(float *input0, float *input1, float *output, int startIndex, int endIndex) {
       #if __APPLE__
@@ -457,23 +540,95 @@ class ArrayArithmetic {
       #endif
     }
   
-    static inline void fill(float *input, float constant, int startIndex, int endIndex) {
+    /** Returns <code>true</code> if all elements of the input in the given range are zero. */
+    static inline bool isZero(float *input, int startIndex, int endIndex) {
       #if __APPLE__
-      vDSP_vfill(&constant, input+startIndex, 1, endIndex-startIndex);
+      float maxMagnitude = 0.0f;
+      vDSP_maxmgv(input+startIndex, 1, &maxMagnitude, endIndex-startIndex);
+      return (maxMagnitude == 0.0f);
       #elif __SSE__
       input += startIndex;
       int n = endIndex - startIndex;
-      
-      switch (startIndex & 0x3) {
+      int n4 = n & 0xFFFFFFFC; // force n to be a multiple of 4
+      const __m128 zeroVec = _mm_setzero_ps();
+      __m128 nonZeroVec = zeroVec;
+      while (n4) {
+        nonZeroVec = _mm_or_ps(nonZeroVec, _mm_cmpneq_ps(_mm_loadu_ps(input), zeroVec));
+        n4 -= 4; input += 4;
+      }
+      if (_mm_movemask_ps(nonZeroVec) != 0) return false;
+      switch (n & 0x3) {
+        case 3: if (*input++ != 0.0f) return false;
+        case 2: if (*input++ != 0.0f) return false;
+        case 1: if (*input++ != 0.0f) return false;
         case 0: default: break;
-        case 1: *input++ = constant; --n;
-        case 2: *input++ = constant; --n;
-        case 3: *input++ = constant; --n;
       }
+      return true;
+      #else
+      for (int i = startIndex; i < endIndex; i++) {
+        if (input[i] != 0.0f) return false;
+      }
+      return true;
+      #endif
+    }
+  
+    /**
+     * Returns the sum of input0[i] * input1[i] over the first <code>n</code> elements. The inputs
+     * need not be aligned.
+     */
+    static inline float dot(float *input0, float *input1, int n) {
+      #if __APPLE__
+      float result = 0.0f;
+      vDSP_dotpr(input0, 1, input1, 1, &result, n);
+      return result;
+      #elif __SSE__
+      __m128 acc0 = _mm_setzero_ps();
+      __m128 acc1 = _mm_setzero_ps();
+      int i = 0;
+      for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(input0+i), _mm_loadu_ps(input1+i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(input0+i+4), _mm_loadu_ps(input1+i+4)));
+      }
+      for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(input0+i), _mm_loadu_ps(input1+i)));
+      }
+      float partials[4];
+      _mm_storeu_ps(partials, _mm_add_ps(acc0, acc1));
+      float result = (partials[0] + partials[1]) + (partials[2] + partials[3]);
+      for (; i < n; i++) result += input0[i] * input1[i];
+      return result;
+      #elif __ARM_NEON__
+      float32x4_t acc = vdupq_n_f32(0.0f);
+      int i = 0;
+      for (; i + 4 <= n; i += 4) {
+        acc = vmlaq_f32(acc, vld1q_f32((const float32_t *) (input0+i)),
+            vld1q_f32((const float32_t *) (input1+i)));
+      }
+      float result = vgetq_lane_f32(acc, 0) + vgetq_lane_f32(acc, 1) +
+          vgetq_lane_f32(acc, 2) + vgetq_lane_f32(acc, 3);
+      for (; i < n; i++) result += input0[i] * input1[i];
+      return result;
+      #else
+      float result = 0.0f;
+      for (int i = 0; i < n; i++) result += input0[i] * input1[i];
+      return result;
+      #endif
+    }
+  
+    static inline void fill(float *input, float constant, int startIndex, int endIndex) {
+      #if __APPLE__
+      vDSP_vfill(&constant, input+startIndex, 1, endIndex-startIndex);
+      #elif __SSE__
+      // the range may be shorter than the number of samples needed to reach alignment
+      for (; (startIndex & 0x3) && startIndex < endIndex; ++startIndex) {
+        input[startIndex] = constant;
+      }
+      input += startIndex;
+      int n = endIndex - startIndex;
       
       int n4 = n & 0xFFFFFFFC; // force n to be a multiple of 4
       const __m128 constVec = _mm_set1_ps(constant);
-      while (n4) {
+      while (n4 > 0) {
         _mm_store_ps(input, constVec);
         n4 -= 4; input += 4;
       }
@@ -506,7 +661,239 @@ class ArrayArithmetic {
       }
       #endif
     }
-    
+
+    /**
+     * Computes cos(2*pi*input), i.e. the cosine of a phase given in cycles. Input and output may be
+     * the same. Outside of the Apple branch, the phase is wrapped into [-1/2, 1/2] and the cosine is
+     * computed with a polynomial of degree eleven, which is accurate to within 1e-7. This replaces
+     * large lookup tables, which do not stay in the cache when many oscillators are processed.
+     */
+    static inline void cosine(float *input, float *output, int startIndex, int endIndex) {
+      #if __APPLE__
+      int n = endIndex - startIndex;
+      float twoPi = 2.0f * M_PI;
+      vDSP_vsmul(input+startIndex, 1, &twoPi, output+startIndex, 1, n);
+      vvcosf(output+startIndex, output+startIndex, &n);
+      #else
+      int i = startIndex;
+      #if __SSE__ || __ARM_NEON__
+      for (; (i & 0x3) && i < endIndex; ++i) {
+        output[i] = cosineOfPhase(input[i]);
+      }
+      #if __SSE__
+      // adding and subtracting 1.5*2^23 rounds to the nearest integer
+      const __m128 roundVec = _mm_set1_ps(12582912.0f);
+      const __m128 signMask = _mm_set1_ps(-0.0f);
+      const __m128 quarterVec = _mm_set1_ps(0.25f);
+      const __m128 twoPiVec = _mm_set1_ps(2.0f * M_PI);
+      const __m128 c1 = _mm_set1_ps(1.0f);
+      const __m128 c3 = _mm_set1_ps(-1.0f/6.0f);
+      const __m128 c5 = _mm_set1_ps(1.0f/120.0f);
+      const __m128 c7 = _mm_set1_ps(-1.0f/5040.0f);
+      const __m128 c9 = _mm_set1_ps(1.0f/362880.0f);
+      const __m128 c11 = _mm_set1_ps(-1.0f/39916800.0f);
+      for (; i + 4 <= endIndex; i += 4) {
+        __m128 p = _mm_loadu_ps(input+i);
+        p = _mm_sub_ps(p, _mm_sub_ps(_mm_add_ps(p, roundVec), roundVec));
+        // cos(2*pi*|p|) = sin(2*pi*(1/4 - |p|)), with the argument in [-pi/2, pi/2]
+        __m128 x = _mm_mul_ps(_mm_sub_ps(quarterVec, _mm_andnot_ps(signMask, p)), twoPiVec);
+        __m128 x2 = _mm_mul_ps(x, x);
+        __m128 y = _mm_add_ps(c9, _mm_mul_ps(x2, c11));
+        y = _mm_add_ps(c7, _mm_mul_ps(x2, y));
+        y = _mm_add_ps(c5, _mm_mul_ps(x2, y));
+        y = _mm_add_ps(c3, _mm_mul_ps(x2, y));
+        y = _mm_add_ps(c1, _mm_mul_ps(x2, y));
+        _mm_store_ps(output+i, _mm_mul_ps(x, y));
+      }
+      #else
+      const float32x4_t roundVec = vdupq_n_f32(12582912.0f);
+      const float32x4_t quarterVec = vdupq_n_f32(0.25f);
+      const float32x4_t c3 = vdupq_n_f32(-1.0f/6.0f);
+      const float32x4_t c5 = vdupq_n_f32(1.0f/120.0f);
+      const float32x4_t c7 = vdupq_n_f32(-1.0f/5040.0f);
+      const float32x4_t c9 = vdupq_n_f32(1.0f/362880.0f);
+      const float32x4_t c11 = vdupq_n_f32(-1.0f/39916800.0f);
+      for (; i + 4 <= endIndex; i += 4) {
+        float32x4_t p = vld1q_f32(input+i);
+        p = vsubq_f32(p, vsubq_f32(vaddq_f32(p, roundVec), roundVec));
+        float32x4_t x = vmulq_n_f32(vsubq_f32(quarterVec, vabsq_f32(p)), 2.0f * M_PI);
+        float32x4_t x2 = vmulq_f32(x, x);
+        float32x4_t y = vmlaq_f32(c9, x2, c11);
+        y = vmlaq_f32(c7, x2, y);
+        y = vmlaq_f32(c5, x2, y);
+        y = vmlaq_f32(c3, x2, y);
+        y = vmlaq_f32(vdupq_n_f32(1.0f), x2, y);
+        vst1q_f32(output+i, vmulq_f32(x, y));
+      }
+      #endif
+      #endif
+      for (; i < endIndex; ++i) {
+        output[i] = cosineOfPhase(input[i]);
+      }
+      #endif
+    }
+
+    /** Returns cos(2*pi*phase). The scalar counterpart of <code>cosine()</code>. */
+    static inline float cosineOfPhase(float phase) {
+      phase -= floorf(phase + 0.5f);
+      float x = (0.25f - fabsf(phase)) * (2.0f * M_PI);
+      float x2 = x * x;
+      return x * (1.0f + x2 * (-1.0f/6.0f + x2 * (1.0f/120.0f + x2 * (-1.0f/5040.0f +
+          x2 * (1.0f/362880.0f + x2 * (-1.0f/39916800.0f))))));
+    }
+
+    /**
+     * Fills the output with a linear ramp, output[i] = start + (i-startIndex)*step. Each sample is
+     * computed from the start value instead of being accumulated, such that long ramps do not drift.
+     */
+    static inline void ramp(float *output, float start, float step, int startIndex, int endIndex) {
+      #if __APPLE__
+      vDSP_vramp(&start, &step, output+startIndex, 1, endIndex-startIndex);
+      #else
+      int i = startIndex;
+      #if __SSE__ || __ARM_NEON__
+      for (; (i & 0x3) && i < endIndex; ++i) {
+        output[i] = start + ((float) (i-startIndex)) * step;
+      }
+      #if __SSE__
+      const __m128 startVec = _mm_set1_ps(start);
+      const __m128 stepVec = _mm_set1_ps(step);
+      const __m128 fourVec = _mm_set1_ps(4.0f);
+      __m128 k = _mm_add_ps(_mm_set1_ps((float) (i-startIndex)), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+      for (; i + 4 <= endIndex; i += 4) {
+        _mm_store_ps(output+i, _mm_add_ps(startVec, _mm_mul_ps(k, stepVec)));
+        k = _mm_add_ps(k, fourVec);
+      }
+      #else
+      const float32x4_t startVec = vdupq_n_f32(start);
+      const float32x4_t fourVec = vdupq_n_f32(4.0f);
+      const float offsets[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+      float32x4_t k = vaddq_f32(vdupq_n_f32((float) (i-startIndex)), vld1q_f32(offsets));
+      for (; i + 4 <= endIndex; i += 4) {
+        vst1q_f32(output+i, vmlaq_n_f32(startVec, k, step));
+        k = vaddq_f32(k, fourVec);
+      }
+      #endif
+      #endif
+      for (; i < endIndex; ++i) {
+        output[i] = start + ((float) (i-startIndex)) * step;
+      }
+      #endif
+    }
+
+    /**
+     * Fills the output with the phase of an oscillator in [0, 1), at a constant frequency. The phase
+     * is a 32-bit fixed-point fraction of a cycle, which wraps around exactly and so does not lose
+     * precision over time. It is advanced by <code>step</code> per sample (i.e. frequency*2^32/sampleRate,
+     * see <code>phaseStep()</code>). Returns the phase following the last sample.
+     */
+    static inline uint32_t phasor(float *output, uint32_t phase, uint32_t step, int startIndex, int endIndex) {
+      int i = startIndex;
+      #if __SSE2__ || __ARM_NEON__
+      for (; (i & 0x3) && i < endIndex; ++i, phase += step) {
+        output[i] = phaseToFloat(phase);
+      }
+      #if __SSE2__
+      const __m128 scaleVec = _mm_set1_ps(1.0f/16777216.0f);
+      const __m128i stepVec = _mm_set1_epi32((int) (4*step));
+      __m128i phaseVec = _mm_set_epi32((int) (phase+3*step), (int) (phase+2*step), (int) (phase+step), (int) phase);
+      for (; i + 4 <= endIndex; i += 4, phase += 4*step) {
+        _mm_store_ps(output+i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(phaseVec, 8)), scaleVec));
+        phaseVec = _mm_add_epi32(phaseVec, stepVec);
+      }
+      #else
+      const uint32x4_t stepVec = vdupq_n_u32(4*step);
+      const uint32_t phases[4] = {phase, phase+step, phase+2*step, phase+3*step};
+      uint32x4_t phaseVec = vld1q_u32(phases);
+      for (; i + 4 <= endIndex; i += 4, phase += 4*step) {
+        vst1q_f32(output+i, vmulq_n_f32(vcvtq_f32_u32(vshrq_n_u32(phaseVec, 8)), 1.0f/16777216.0f));
+        phaseVec = vaddq_u32(phaseVec, stepVec);
+      }
+      #endif
+      #endif
+      for (; i < endIndex; ++i, phase += step) {
+        output[i] = phaseToFloat(phase);
+      }
+      return phase;
+    }
+
+    /**
+     * Fills the output with the phase of an oscillator in [0, 1), as above, but with the frequency
+     * given per sample. <code>phaseScale</code> is the phase step per Hz, i.e. 2^32/sampleRate. The
+     * frequency and output may be the same. Returns the phase following the last sample.
+     */
+    static inline uint32_t phasor(float *frequency, float phaseScale, float *output, uint32_t phase,
+        int startIndex, int endIndex) {
+      int i = startIndex;
+      #if __SSE2__ || __ARM_NEON__
+      for (; (i & 0x3) && i < endIndex; ++i) {
+        uint32_t step = phaseStep(frequency[i], phaseScale);
+        output[i] = phaseToFloat(phase);
+        phase += step;
+      }
+      #if __SSE2__
+      const __m128 scaleVec = _mm_set1_ps(1.0f/16777216.0f);
+      const __m128 phaseScaleVec = _mm_set1_ps(phaseScale);
+      const __m128 roundVec = _mm_set1_ps(12582912.0f);
+      for (; i + 4 <= endIndex; i += 4) {
+        // wrap the steps into [-2^31, 2^31] such that they can be converted to 32-bit integers
+        __m128 x = _mm_mul_ps(_mm_loadu_ps(frequency+i), phaseScaleVec);
+        __m128 cycles = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.0f/4294967296.0f)), roundVec), roundVec);
+        x = _mm_sub_ps(x, _mm_mul_ps(cycles, _mm_set1_ps(4294967296.0f)));
+        __m128i steps = _mm_cvttps_epi32(x);
+        // the phase at each sample is the running sum of the preceding steps
+        __m128i sums = _mm_add_epi32(steps, _mm_slli_si128(steps, 4));
+        sums = _mm_add_epi32(sums, _mm_slli_si128(sums, 8));
+        __m128i phaseVec = _mm_add_epi32(_mm_set1_epi32((int) phase), _mm_sub_epi32(sums, steps));
+        _mm_store_ps(output+i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(phaseVec, 8)), scaleVec));
+        phase += (uint32_t) _mm_cvtsi128_si32(_mm_shuffle_epi32(sums, 0xFF));
+      }
+      #else
+      const uint32x4_t zeroVec = vdupq_n_u32(0);
+      for (; i + 4 <= endIndex; i += 4) {
+        float32x4_t x = vmulq_n_f32(vld1q_f32(frequency+i), phaseScale);
+        float32x4_t cycles = vmulq_n_f32(x, 1.0f/4294967296.0f);
+        cycles = vsubq_f32(vaddq_f32(cycles, vdupq_n_f32(12582912.0f)), vdupq_n_f32(12582912.0f));
+        x = vmlsq_n_f32(x, cycles, 4294967296.0f);
+        uint32x4_t steps = vreinterpretq_u32_s32(vcvtq_s32_f32(x));
+        uint32x4_t sums = vaddq_u32(steps, vextq_u32(zeroVec, steps, 3));
+        sums = vaddq_u32(sums, vextq_u32(zeroVec, sums, 2));
+        uint32x4_t phaseVec = vaddq_u32(vdupq_n_u32(phase), vsubq_u32(sums, steps));
+        vst1q_f32(output+i, vmulq_n_f32(vcvtq_f32_u32(vshrq_n_u32(phaseVec, 8)), 1.0f/16777216.0f));
+        phase += vgetq_lane_u32(sums, 3);
+      }
+      #endif
+      #endif
+      for (; i < endIndex; ++i) {
+        uint32_t step = phaseStep(frequency[i], phaseScale);
+        output[i] = phaseToFloat(phase);
+        phase += step;
+      }
+      return phase;
+    }
+
+    /**
+     * Returns the 32-bit fixed-point phase step of the given frequency, see <code>phasor()</code>.
+     * Steps of more than one cycle are wrapped, such that the conversion to an integer is defined for
+     * any frequency. NaN and infinite frequencies do not advance the phase.
+     */
+    static inline uint32_t phaseStep(float frequency, double phaseScale) {
+      double step = frequency * phaseScale;
+      if (!(fabs(step) < 4294967296.0)) step = fmod(step, 4294967296.0); // NaN for inf
+      return (step == step) ? (uint32_t) (int64_t) step : 0;
+    }
+  
+    /** Returns the 32-bit fixed-point phase of the fractional part of the given cycle, or zero if it is not finite. */
+    static inline uint32_t fractionToPhase(float cycle) {
+      double phase = (cycle - floor(cycle)) * 4294967296.0; // NaN for inf
+      return (phase == phase) ? (uint32_t) (int64_t) phase : 0;
+    }
+
+    /** Converts a 32-bit fixed-point phase to a float in [0, 1). Only the upper 24 bits are kept. */
+    static inline float phaseToFloat(uint32_t phase) {
+      return ((float) (phase >> 8)) * (1.0f/16777216.0f);
+    }
+
   private:
     ArrayArithmetic(); // no instances of this object are allowed
     ~ArrayArithmetic();
@@ -0,0 +1,108 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include "AtomDispatchTable.h"
+#include "NameRegistry.h"
+#include "StaticUtils.h"
+
+AtomDispatchTable::AtomDispatchTable(PdMessage *keys) {
+  bangIndex = -1;
+
+  int numSymbols = 0;
+  for (int i = 0; i < keys->getNumElements(); i++) {
+    if (keys->isSymbol(i)) numSymbols++;
+  }
+  // keep the table at most half full such that probe sequences stay short
+  unsigned int capacity = 1;
+  while (capacity < 2 * (unsigned int) numSymbols) capacity <<= 1;
+  SymbolKey emptyKey = {NULL, 0, -1};
+  symbolKeys.resize(capacity, emptyKey);
+
+  for (int i = 0; i < keys->getNumElements(); i++) {
+    switch (keys->getType(i)) {
+      case FLOAT: {
+        FloatKey floatKey = {keys->getFloat(i), i};
+        floatKeys.push_back(floatKey);
+        break;
+      }
+      case SYMBOL: {
+        char *symbol = keys->getSymbol(i);
+        unsigned int hash = hashName(symbol);
+        unsigned int slot = hash & (capacity - 1);
+        while (symbolKeys[slot].symbol != NULL &&
+            (symbolKeys[slot].hash != hash || strcmp(symbolKeys[slot].symbol, symbol))) {
+          slot = (slot + 1) & (capacity - 1);
+        }
+        if (symbolKeys[slot].symbol == NULL) { // a repeated key is never matched
+          symbolKeys[slot].symbol = StaticUtils::copyString(symbol);
+          symbolKeys[slot].hash = hash;
+          symbolKeys[slot].index = i;
+        }
+        break;
+      }
+      case BANG: {
+        if (bangIndex < 0) bangIndex = i;
+        break;
+      }
+      default: break;
+    }
+  }
+
+  // a stable sort keeps equal keys in their original order, such that the first one is kept
+  std::stable_sort(floatKeys.begin(), floatKeys.end(), floatKeyIsLess);
+  vector<FloatKey> uniqueKeys;
+  for (unsigned int i = 0; i < floatKeys.size(); i++) {
+    if (uniqueKeys.empty() || uniqueKeys.back().constant != floatKeys[i].constant) {
+      uniqueKeys.push_back(floatKeys[i]);
+    }
+  }
+  floatKeys.swap(uniqueKeys);
+}
+
+AtomDispatchTable::~AtomDispatchTable() {
+  for (unsigned int i = 0; i < symbolKeys.size(); i++) {
+    free(symbolKeys[i].symbol);
+  }
+}
+
+bool AtomDispatchTable::floatKeyIsLess(const FloatKey &a, const FloatKey &b) {
+  return a.constant < b.constant;
+}
+
+int AtomDispatchTable::getIndex(MessageAtom *atom) {
+  switch (atom->type) {
+    case FLOAT: {
+      unsigned int numKeys = floatKeys.size();
+      if (numKeys == 0) return -1;
+      // binary search without a data dependent branch, ending on the largest key <= constant
+      const FloatKey *base = &floatKeys[0];
+      while (numKeys > 1) {
+        unsigned int half = numKeys / 2;
+        base = (base[half].constant <= atom->constant) ? base + half : base;
+        numKeys -= half;
+      }
+      return (base->constant == atom->constant) ? base->index : -1;
+    }
+    case SYMBOL: {
+      if (symbolKeys.empty()) return -1;
+      unsigned int capacity = symbolKeys.size();
+      unsigned int hash = hashName(atom->symbol);
+      for (unsigned int slot = hash & (capacity - 1); symbolKeys[slot].symbol != NULL;
+          slot = (slot + 1) & (capacity - 1)) {
+        if (symbolKeys[slot].hash == hash && !strcmp(symbolKeys[slot].symbol, atom->symbol)) {
+          return symbolKeys[slot].index;
+        }
+      }
+      return -1;
+    }
+    case BANG: return bangIndex;
+    default: return -1;
+  }
+}
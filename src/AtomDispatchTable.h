@@ -0,0 +1,58 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#ifndef _ATOM_DISPATCH_TABLE_H_
+#define _ATOM_DISPATCH_TABLE_H_
+
+#include <vector>
+#include "PdMessage.h"
+
+using namespace std;
+
+/**
+ * Maps message atoms to the index of the first equal key in a list of keys, as used by [route] and
+ * [select]. The table is built once from the keys. Symbols are found through an open addressing
+ * hash table, such that at most one string comparison is made per lookup, and floats through a
+ * sorted key table. The cost of a lookup therefore does not grow with the number of keys.
+ */
+class AtomDispatchTable {
+
+  public:
+    AtomDispatchTable(PdMessage *keys);
+    ~AtomDispatchTable();
+
+    /** Returns the index of the first key equal to the given atom, or -1 if there is none. */
+    int getIndex(MessageAtom *atom);
+
+  private:
+    AtomDispatchTable(const AtomDispatchTable &);
+    AtomDispatchTable &operator=(const AtomDispatchTable &);
+
+    typedef struct SymbolKey {
+      char *symbol; // NULL if the slot is empty
+      unsigned int hash;
+      int index;
+    } SymbolKey;
+
+    typedef struct FloatKey {
+      float constant;
+      int index;
+    } FloatKey;
+
+    static bool floatKeyIsLess(const FloatKey &a, const FloatKey &b);
+
+    /** The symbol hash table. Its length is a power of two. */
+    vector<SymbolKey> symbolKeys;
+
+    /** Float keys, sorted by value. Only the first of several equal keys is kept. */
+    vector<FloatKey> floatKeys;
+
+    /** The index of the first bang key, or -1. */
+    int bangIndex;
+};
+
+#endif // _ATOM_DISPATCH_TABLE_H_
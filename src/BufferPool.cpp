@@ -27,6 +27,7 @@
  *
  */
 
+#include "ArrayArithmetic.h"
 #include "BufferPool.h"
 #include "DspObject.h"
 
@@ -35,6 +36,11 @@ BufferPool::BufferPool(unsigned short size) {
  
   zeroBuffer = ALLOC_ALIGNED_BUFFER(bufferSize * sizeof(float));
   memset(zeroBuffer, 0, bufferSize*sizeof(float)); // zero the zero buffer!
+  
+  constantBuffers = NULL;
+  numConstantBuffers = 0;
+  constantBufferStride = (bufferSize + 3) & ~3; // keep each constant buffer 16-byte aligned
+  deferDepth = 0;
 }
 
 BufferPool::~BufferPool() {
@@ -46,7 +52,27 @@ BufferPool::~BufferPool() {
     FREE_ALIGNED_BUFFER(pool.top());
     pool.pop();
   }
+  for (unsigned int i = 0; i < deferred.size(); i++) {
+    FREE_ALIGNED_BUFFER(deferred[i]);
+  }
   FREE_ALIGNED_BUFFER(zeroBuffer);
+  if (constantBuffers != NULL) FREE_ALIGNED_BUFFER(constantBuffers);
+}
+
+float *BufferPool::getConstantBuffer(float constant) {
+  if (constant == 0.0f) return zeroBuffer;
+  
+  map<float, float *>::iterator it = constantBufferMap.find(constant);
+  if (it != constantBufferMap.end()) return it->second;
+  
+  if (numConstantBuffers == MAX_CONSTANT_BUFFERS) return NULL;
+  if (constantBuffers == NULL) {
+    constantBuffers = ALLOC_ALIGNED_BUFFER(MAX_CONSTANT_BUFFERS * constantBufferStride * sizeof(float));
+  }
+  float *buffer = constantBuffers + (numConstantBuffers++ * constantBufferStride);
+  ArrayArithmetic::fill(buffer, constant, 0, bufferSize);
+  constantBufferMap[constant] = buffer;
+  return buffer;
 }
 
 float *BufferPool::getBuffer(unsigned int numDependencies) {
@@ -72,7 +98,8 @@ void BufferPool::releaseBuffer(float *buffer) {
       --((*it).second);
       if ((*it).second <= 0) {
         reserved.erase(it);
-        pool.push(buffer);
+        if (deferDepth > 0) deferred.push_back(buffer);
+        else pool.push(buffer);
 //        printf("%i/%i buffer used.\n", getNumReservedBuffers(), getNumTotalBuffers());
         break;
       }
@@ -83,6 +110,8 @@ void BufferPool::releaseBuffer(float *buffer) {
 
 void BufferPool::reserveBuffer(float *buffer, unsigned int reserveCount) {
   if (buffer == zeroBuffer) return; // no need to reserve the zero buffer
+  float constant;
+  if (isConstantBuffer(buffer, &constant)) return; // nor constant buffers
   
   for (list<std::pair<float *, unsigned int> >::iterator it = reserved.begin(); it != reserved.end(); ++it) {
     if ((*it).first == buffer) {
@@ -95,6 +124,25 @@ void BufferPool::reserveBuffer(float *buffer, unsigned int reserveCount) {
       "This may be ok if the buffer is global such as an adc~ input buffer.\n", buffer, reserveCount);
 }
 
+bool BufferPool::isReservedBuffer(float *buffer) {
+  for (list<std::pair<float *, unsigned int> >::iterator it = reserved.begin(); it != reserved.end(); ++it) {
+    if ((*it).first == buffer) return true;
+  }
+  return false;
+}
+
+void BufferPool::beginDeferredRelease() {
+  ++deferDepth;
+}
+
+void BufferPool::endDeferredRelease() {
+  if (deferDepth == 0 || --deferDepth > 0) return;
+  for (unsigned int i = 0; i < deferred.size(); i++) {
+    pool.push(deferred[i]);
+  }
+  deferred.clear();
+}
+
 /*
 void BufferPool::resizeBuffers(unsigned int newBufferSize) {
   for (list<std::pair<float *, unsigned int> >::iterator it = reserved.begin(); it != reserved.end(); ++it) {
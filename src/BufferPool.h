@@ -31,9 +31,14 @@
 #define _BUFFER_POOL_
 
 #include <list>
+#include <map>
 #include <stack>
+#include <vector>
 using namespace std;
 
+/** The maximum number of distinct constants which are folded in one context. */
+#define MAX_CONSTANT_BUFFERS 64
+
 class BufferPool {
   public:
     BufferPool(unsigned short bufferSize);
@@ -51,11 +56,47 @@ class BufferPool {
     /** Add to the reserve cound of the given buffer. */
     void reserveBuffer(float *buffer, unsigned int reserveCount);
   
+    /** Returns <code>true</code> if the given buffer is currently reserved from this pool. */
+    bool isReservedBuffer(float *buffer);
+  
+    /**
+     * Until the matching call to <code>endDeferredRelease()</code>, released buffers are held back
+     * instead of being made available again. Objects which are ordered in the meantime therefore
+     * never share a buffer, and may be processed in any interleaving. Calls may be nested.
+     */
+    void beginDeferredRelease();
+  
+    /** Makes all buffers released since the outermost <code>beginDeferredRelease()</code> available. */
+    void endDeferredRelease();
+  
     /** Resizes all buffers in the pool (reserved and available). */
 //    void resizeBuffers(unsigned int newBufferSize);
   
     float *getZeroBuffer() { return zeroBuffer; }
   
+    /**
+     * Returns a shared buffer filled with the given constant. These buffers are used for folded
+     * constant signals and are never reserved or released. They must not be written to. Returns
+     * <code>NULL</code> if no more constant buffers are available.
+     */
+    float *getConstantBuffer(float constant);
+  
+    /**
+     * Returns <code>true</code> if the given buffer is the zero buffer or a constant buffer, in which
+     * case its value is written to <code>constant</code>. Constant buffers are allocated in one
+     * contiguous block, such that this check does not depend on their number.
+     */
+    bool isConstantBuffer(float *buffer, float *constant) {
+      if (buffer == zeroBuffer) {
+        *constant = 0.0f;
+        return true;
+      } else if (buffer >= constantBuffers && buffer < constantBuffers + numConstantBuffers*constantBufferStride) {
+        *constant = buffer[0];
+        return true;
+      }
+      return false;
+    }
+  
     unsigned int getNumReservedBuffers() { return reserved.size(); }
     unsigned int getNumAvailableBuffers() { return pool.size(); }
     unsigned int getNumTotalBuffers() { return (pool.size() + reserved.size()); }
@@ -67,8 +108,20 @@ class BufferPool {
     /** A pool of available buffers. */
     stack<float *> pool;
   
+    /** Buffers which have been released while the release is deferred. */
+    vector<float *> deferred;
+    unsigned int deferDepth;
+  
     float *zeroBuffer;
   
+    /** All constant buffers, each <code>constantBufferStride</code> floats apart. Allocated when first needed. */
+    float *constantBuffers;
+    unsigned int numConstantBuffers;
+    unsigned int constantBufferStride;
+  
+    /** Constant buffers, indexed by their value. */
+    map<float, float *> constantBufferMap;
+  
     unsigned short bufferSize;
 };
 
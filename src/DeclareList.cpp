@@ -27,6 +27,7 @@
  *
  */
 
+#include <algorithm>
 #include <string.h>
 #include "DeclareList.h"
 #include "StaticUtils.h"
@@ -39,26 +40,22 @@ DeclareList::~DeclareList() {
   // nothing to do
 }
 
-void DeclareList::addPath(const char *path) {
+bool DeclareList::addPath(const char *path) {
+  string fullPath;
   if (isFullPath(path)) {
     // if the path is full, then just add it to the list
-    if (hasTrailingSlash(path)) {
-      // if a trailing slash exists, then it can be added to the list
-      declareList.push_back(string(path));
-    } else {
-      // if no trailing slash exists, then one must be added
-      declareList.push_back(string(path) + string("/"));
-    }
+    fullPath = string(path);
   } else {
-    // if it is not a full path, then make it relative to the root path
-    if (hasTrailingSlash(path)) {
-      // front is root path
-      declareList.push_back(declareList.front() + string(path));
-    } else {
-      // if no trailing slash exists, then one should be added
-      declareList.push_back(declareList.front() + string(path) + string("/"));
-    }
+    // if it is not a full path, then make it relative to the root path (the front of the list)
+    fullPath = declareList.front() + string(path);
   }
+  // if no trailing slash exists, then one must be added
+  if (!hasTrailingSlash(path)) fullPath += string("/");
+
+  // a path which is already declared would never be searched again
+  if (std::find(declareList.begin(), declareList.end(), fullPath) != declareList.end()) return false;
+  declareList.push_back(fullPath);
+  return true;
 }
 
 bool DeclareList::isFullPath(const char *path) {
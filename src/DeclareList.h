@@ -40,7 +40,6 @@ using namespace std;
  * it is a list of paths where abstractions may be found. The DeclareList only maintains full paths.
  * If a path is [declare]d as a relative path, then it will be resolved to a pull path relative
  * to the root path of the original patch.
- * NOTE(mhroth): currently it does not do duplicate checking for given paths, though it probably should
  */
 class DeclareList  {
   
@@ -50,9 +49,10 @@ class DeclareList  {
   
     /**
      * Add a full or relative path to the list. Relative paths are resolved relative to the
-     * root path (which should be the first entry in the list).
+     * root path (which should be the first entry in the list). Returns <code>false</code> if the
+     * path is already in the list, in which case the list does not change.
      */
-    void addPath(const char *path);
+    bool addPath(const char *path);
   
     /** A convenience function returning the first entryin the list. */
     char *getRootPath();
@@ -27,21 +27,54 @@
  *
  */
 
+#include "BufferPool.h"
 #include "DspAdc.h"
 #include "PdGraph.h"
 
 MessageObject *DspAdc::newObject(PdMessage *initMessage, PdGraph *graph) {
-  return new DspAdc(graph);
+  return new DspAdc(initMessage, graph);
 }
 
-DspAdc::DspAdc(PdGraph *graph) : DspObject(0, 0, 0, graph->getNumInputChannels(), graph) {
-  // nothing to do
+DspAdc::DspAdc(PdMessage *initMessage, PdGraph *graph) : DspObject(0, 0, 0,
+    initMessage->isFloat(0) ? initMessage->getNumElements() : graph->getNumInputChannels(),
+    graph) {
+  int numInputChannels = graph->getNumInputChannels();
+  if (initMessage->isFloat(0)) {
+    for (int i = 0; i < initMessage->getNumElements(); i++) {
+      channels.push_back(initMessage->isFloat(i) ? ((int) initMessage->getFloat(i)) - 1 : -1);
+    }
+  } else {
+    for (int i = 0; i < numInputChannels; i++) channels.push_back(i);
+  }
 }
 
 DspAdc::~DspAdc() {
   // nothing to do
 }
 
+string DspAdc::toString() {
+  if (channels.size() == (unsigned int) graph->getNumInputChannels()) {
+    bool isDefault = true;
+    for (unsigned int i = 0; i < channels.size(); i++) isDefault &= (channels[i] == (int) i);
+    if (isDefault) return string(getObjectLabel());
+  }
+  string str = string(getObjectLabel());
+  for (unsigned int i = 0; i < channels.size(); i++) {
+    char channel[16];
+    snprintf(channel, sizeof(channel), " %i", channels[i]+1);
+    str += channel;
+  }
+  return str;
+}
+
 float *DspAdc::getDspBufferAtOutlet(int outletIndex) {
-  return graph->getGlobalDspBufferAtInlet(outletIndex);
+  // the buffers are passed on when the process order is computed, and again if they change
+  int channel = channels[outletIndex];
+  return (channel < 0 || channel >= graph->getNumInputChannels()) ? graph->getBufferPool()->getZeroBuffer() : graph->getGlobalDspBufferAtInlet(channel);
+}
+
+void DspAdc::updateChannelBuffer(int channel) {
+  for (unsigned int i = 0; i < channels.size(); i++) {
+    if (channels[i] == channel) setUnfoldedBufferAtReaders(i, getDspBufferAtOutlet(i));
+  }
 }
@@ -32,11 +32,17 @@
 
 #include "DspObject.h"
 
+/**
+ * [adc~], [adc~ channel...]
+ * Without arguments, there is one outlet for each input channel of the context. Otherwise there
+ * is one outlet for each given (1-based) channel. Channels which the context does not have are
+ * silent.
+ */
 class DspAdc : public DspObject {
   
   public:
     static MessageObject *newObject(PdMessage *initMessage, PdGraph *graph);
-    DspAdc(PdGraph *graph);
+    DspAdc(PdMessage *initMessage, PdGraph *graph);
     ~DspAdc();
   
     static const char *getObjectLabel();
@@ -48,15 +54,23 @@ class DspAdc : public DspObject {
   
     bool canSetBufferAtOutlet(unsigned int outletIndex) { return false; }
   
+    ObjectType getObjectType() { return DSP_ADC; }
+  
     float *getDspBufferAtOutlet(int outletIndex);
+  
+    /**
+     * Passes the current buffer of the given input channel on to the objects reading it, after the
+     * context has bound the channel to a different buffer.
+     */
+    void updateChannelBuffer(int channel);
+  
+  private:
+    /** The (0-based) input channel of each outlet. It may be one which the context does not have. */
+    vector<int> channels;
 };
 
 inline const char *DspAdc::getObjectLabel() {
   return "adc~";
 }
 
-inline std::string DspAdc::toString() {
-  return DspAdc::getObjectLabel();
-}
-
 #endif // _DSP_ADC_H_
@@ -50,6 +50,17 @@ void DspAdd::onInletConnectionUpdate(unsigned int inletIndex) {
       ? &processSignal : &processScalar;
 }
 
+bool DspAdd::isSilentWithInput(const bool *isInletSilent) const {
+  bool isSignal = !incomingDspConnections[0].empty() && !incomingDspConnections[1].empty();
+  return isInletSilent[0] && (isSignal ? isInletSilent[1] : (constant == 0.0f));
+}
+
+float *DspAdd::getFoldedBuffer() {
+  // [+~ 0]
+  bool isScalar = (incomingDspConnections[0].empty() || incomingDspConnections[1].empty());
+  return (isScalar && constant == 0.0f) ? dspBufferAtInlet[0] : NULL;
+}
+
 std::string DspAdd::toString() {
   const char *fmt = (constant == 0.0f) ? "%s" : "%s %g";
   char str[snprintf(NULL, 0, fmt, getObjectLabel(), constant)+1];
@@ -72,5 +83,5 @@ void DspAdd::processSignal(DspObject *dspObject, int fromIndex, int toIndex) {
 void DspAdd::processScalar(DspObject *dspObject, int fromIndex, int toIndex) {
   DspAdd *d = reinterpret_cast<DspAdd *>(dspObject);
   ArrayArithmetic::add(d->dspBufferAtInlet[0] , d->constant,
-      d->dspBufferAtOutlet[0], fromIndex, fromIndex);
+      d->dspBufferAtOutlet[0], fromIndex, toIndex);
 }
@@ -34,10 +34,9 @@ MessageObject *DspBandpassFilter::newObject(PdMessage *initMessage, PdGraph *gra
   return new DspBandpassFilter(initMessage, graph);
 }
 
-DspBandpassFilter::DspBandpassFilter(PdMessage *initMessage, PdGraph *graph) : DspFilter(3, graph) {
-  fc = initMessage->isFloat(0) ? initMessage->getFloat(0) : graph->getSampleRate()/2.0f;
-  q = initMessage->isFloat(1) ? initMessage->getFloat(1) : 1.0f;
-  calcFiltCoeff(fc, q);
+DspBandpassFilter::DspBandpassFilter(PdMessage *initMessage, PdGraph *graph) : DspFilter(3, 1, graph) {
+  calcFiltCoeff(initMessage->isFloat(0) ? initMessage->getFloat(0) : graph->getSampleRate()/2.0f,
+      initMessage->isFloat(1) ? initMessage->getFloat(1) : 1.0f);
 }
 
 DspBandpassFilter::~DspBandpassFilter() {
@@ -46,6 +45,9 @@ DspBandpassFilter::~DspBandpassFilter() {
 
 // http://www.musicdsp.org/files/Audio-EQ-Cookbook.txt
 void DspBandpassFilter::calcFiltCoeff(float fc, float q) {
+  // remember the unclipped parameters, such that either can be changed independently
+  this->fc = fc;
+  this->q = q;
   if (fc > 0.5f * graph->getSampleRate()) fc = 0.5f * graph->getSampleRate();
   else if (fc < 0.0f) fc = 0.0f;
   if (q < 0.0f) q = 0.0f;
@@ -53,18 +55,15 @@ void DspBandpassFilter::calcFiltCoeff(float fc, float q) {
   float wc = 2.0f*M_PI*fc/graph->getSampleRate();
   float alpha = sinf(wc)/(2.0f*q);
   
-  b[0] = alpha/(1.0f+alpha);
-  b[1] = 0.0f;
-  b[2] = -alpha/(1.0f+alpha);
-  b[3] = -2.0f*cosf(wc)/(1.0f+alpha);
-  b[4] = (1.0f-alpha)/(1.0f+alpha);
+  setCoefficients(alpha/(1.0f+alpha), 0.0f, -alpha/(1.0f+alpha),
+      -2.0f*cosf(wc)/(1.0f+alpha), (1.0f-alpha)/(1.0f+alpha));
 }
 
 void DspBandpassFilter::processMessage(int inletIndex, PdMessage *message) {
   switch (inletIndex) {
     case 0: {
       if (message->isSymbol(0, "clear")) {
-        x1 = x2 = dspBufferAtOutlet[0][0] = dspBufferAtOutlet[0][1] = 0.0f;
+        clear();
       }
       break;
     }
@@ -44,6 +44,8 @@ class DspBang : public DspObject {
     std::string toString();
   
     ConnectionType getConnectionType(int outletIndex) { return MESSAGE; }
+  
+    bool hasSideEffects() { return true; }
     
   private:
     static void processDsp(DspObject *dspObject, int fromIndex, int toIndex);
@@ -27,6 +27,7 @@
  *
  */
 
+#include <algorithm>
 #include "ArrayArithmetic.h"
 #include "BufferPool.h"
 #include "DspCatch.h"
@@ -62,25 +63,28 @@ string DspCatch::toString() {
 void DspCatch::addThrow(DspThrow *dspThrow) {
   if (!strcmp(dspThrow->getName(), name)) { // make sure that the throw~ really does match this catch~
     throwList.push_back(dspThrow); // NOTE(mhroth): no dupicate detection
-    
-    // update the process function
-    switch (throwList.size()) {
-      case 0: processFunction = &processNone; break;
-      case 1: processFunction = &processOne; break;
-      default: processFunction = &processMany; break;
-    }
+    updateThrows();
   }
 }
 
 void DspCatch::removeThrow(DspThrow *dspThrow) {
   if (!strcmp(dspThrow->getName(), name)) {
-    throwList.remove(dspThrow);
-    
-    switch (throwList.size()) {
-      case 0: processFunction = &processNone; break;
-      case 1: processFunction = &processOne; break;
-      default: processFunction = &processMany; break;
-    }
+    throwList.erase(std::remove(throwList.begin(), throwList.end(), dspThrow), throwList.end());
+    updateThrows();
+  }
+}
+
+void DspCatch::updateThrows() {
+  // the throw~ buffers are allocated with the objects and do not change
+  throwBuffers.clear();
+  for (unsigned int i = 0; i < throwList.size(); i++) {
+    if (throwList[i]->getBuffer() != NULL) throwBuffers.push_back(throwList[i]->getBuffer());
+  }
+  
+  switch (throwBuffers.size()) {
+    case 0: processFunction = &processNone; break;
+    case 1: processFunction = &processOne; break;
+    default: processFunction = &processMany; break;
   }
 }
 
@@ -91,19 +95,14 @@ void DspCatch::processNone(DspObject *dspObject, int fromIndex, int toIndex) {
 
 void DspCatch::processOne(DspObject *dspObject, int fromIndex, int toIndex) {
   DspCatch *d = reinterpret_cast<DspCatch *>(dspObject);
-  DspThrow *dspThrow = d->throwList.front();
-  memcpy(d->dspBufferAtOutlet[0], dspThrow->getBuffer(), toIndex*sizeof(float));
+  memcpy(d->dspBufferAtOutlet[0], d->throwBuffers[0], toIndex*sizeof(float));
 }
 
 // process at least two throw~s
 void DspCatch::processMany(DspObject *dspObject, int fromIndex, int toIndex) {
   DspCatch *d = reinterpret_cast<DspCatch *>(dspObject);
-  list<DspThrow *>::iterator it = d->throwList.begin();
-  ArrayArithmetic::add((*it++)->getBuffer(), (*it++)->getBuffer(), d->dspBufferAtOutlet[0], 0, toIndex);
-  while (it != d->throwList.end()) {
-    ArrayArithmetic::add(d->dspBufferAtOutlet[0], (*it++)->getBuffer(), d->dspBufferAtOutlet[0],
-        0, toIndex);
-  };
+  ArrayArithmetic::sum(&(d->throwBuffers[0]), (int) d->throwBuffers.size(), d->dspBufferAtOutlet[0],
+      0, toIndex);
 }
 
 // catch objects should be processed after their corresponding throw object even though
@@ -116,8 +115,8 @@ list<DspObject *> DspCatch::getProcessOrder() {
     isOrdered = true;
     list<DspObject *> processList;
     
-    for (std::list<DspThrow *>::iterator throwIt = throwList.begin(); throwIt != throwList.end(); ++throwIt) {
-      list<DspObject *> parentProcessList = (*throwIt)->getProcessOrder();
+    for (unsigned int i = 0; i < throwList.size(); i++) {
+      list<DspObject *> parentProcessList = throwList[i]->getProcessOrder();
       // combine the process lists
       processList.splice(processList.end(), parentProcessList);
     }
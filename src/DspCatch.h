@@ -61,7 +61,13 @@ class DspCatch : public DspObject {
     static void processMany(DspObject *dspObject, int fromIndex, int toIndex);
     
     char *name;
-    list<DspThrow *> throwList; // list of associated throw~ objects
+    vector<DspThrow *> throwList; // list of associated throw~ objects
+  
+    /** The buffers of all associated throw~s, summed in a single pass. */
+    vector<float *> throwBuffers;
+  
+    /** Updates the throw~ buffers and the process function after the list of throw~s has changed. */
+    void updateThrows();
 };
 
 #endif // _DSP_CATCH_H_
@@ -41,6 +41,11 @@ class DspClip : public DspObject {
 
     static const char *getObjectLabel();
     std::string toString();
+  
+    bool isSilentWithInput(const bool *isInletSilent) const {
+      return isInletSilent[0] && lowerBound <= 0.0f && upperBound >= 0.0f;
+    }
+    bool isStateless() { return true; }
 
   private:
    static void processScalar(DspObject *dspObject, int fromIndex, int toIndex);
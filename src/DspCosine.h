@@ -32,7 +32,7 @@
 
 #include "DspObject.h"
 
-/** [cos~] */
+/** [cos~]. Computes cos(2*pi*x) with <code>ArrayArithmetic::cosine()</code>, as [osc~] does. */
 class DspCosine : public DspObject {
 
   public:
@@ -45,10 +45,6 @@ class DspCosine : public DspObject {
 
   private:
     static void procesSignal(DspObject *dspObject, int fromIndex, int toIndex);
-  
-    float sampleRate;
-    static float *cos_table; // the Cosine lookup table
-    static int refCount; // a reference counter for Cosine table. Now we know when to free it.
 };
 
 inline std::string DspCosine::toString() {
@@ -28,51 +28,64 @@
  */
 
 #include "ArrayArithmetic.h"
+#include "BufferPool.h"
 #include "DspDac.h"
 #include "PdGraph.h"
 
 MessageObject *DspDac::newObject(PdMessage *initMessage, PdGraph *graph) {
-  return new DspDac(graph);
+  return new DspDac(initMessage, graph);
 }
 
-DspDac::DspDac(PdGraph *graph) : DspObject(0, graph->getNumOutputChannels(), 0, 0, graph) {
-  // cache pointers to global output buffers in dspBufferAtOutlet
-  int numInlets = graph->getNumOutputChannels();
-  if (numInlets > 2) dspBufferAtOutlet[2] = (float *) calloc(numInlets-2, sizeof(float *));
-  
-  for (int i = 0; i < numInlets; i++) {
-    setDspBufferAtOutlet(graph->getGlobalDspBufferAtOutlet(i), i);
+DspDac::DspDac(PdMessage *initMessage, PdGraph *graph) : DspObject(0,
+    initMessage->isFloat(0) ? initMessage->getNumElements() : graph->getNumOutputChannels(),
+    0, 0, graph) {
+  int numOutputChannels = graph->getNumOutputChannels();
+  if (initMessage->isFloat(0)) {
+    for (int i = 0; i < initMessage->getNumElements(); i++) {
+      channels.push_back(initMessage->isFloat(i) ? ((int) initMessage->getFloat(i)) - 1 : -1);
+    }
+  } else {
+    for (int i = 0; i < numOutputChannels; i++) channels.push_back(i);
   }
-  
   processFunction = &processSignal;
 }
 
 DspDac::~DspDac() {
-  free(dspBufferAtOutlet[2]);
+  // nothing to do
+}
+
+string DspDac::toString() {
+  if (channels.size() == (unsigned int) graph->getNumOutputChannels()) {
+    bool isDefault = true;
+    for (unsigned int i = 0; i < channels.size(); i++) isDefault &= (channels[i] == (int) i);
+    if (isDefault) return string(getObjectLabel());
+  }
+  string str = string(getObjectLabel());
+  for (unsigned int i = 0; i < channels.size(); i++) {
+    char channel[16];
+    snprintf(channel, sizeof(channel), " %i", channels[i]+1);
+    str += channel;
+  }
+  return str;
+}
+
+bool DspDac::isSilentWithInput(const bool *isInletSilent) const {
+  for (unsigned int i = 0; i < incomingDspConnections.size(); i++) {
+    if (!isInletSilent[i]) return false;
+  }
+  return true;
 }
 
 void DspDac::processSignal(DspObject *dspObject, int fromIndex, int toIndex) {
   DspDac *d = reinterpret_cast<DspDac *>(dspObject);
-  switch (d->incomingDspConnections.size()) {
-    default: {
-      /* TODO(mhroth): fit this into the new buffer reference architecture
-      for (int i = 2; i < numDspInlets; i++) {
-        float *globalOutputBuffer = graph->getGlobalDspBufferAtOutlet(i);
-        ArrayArithmetic::add(globalOutputBuffer, localDspBufferAtInlet[i], globalOutputBuffer, 0, blockSizeInt);
-      }
-      */
-      // allow fallthrough
-    }
-    case 2: {
-      ArrayArithmetic::add(d->dspBufferAtOutlet[1], d->dspBufferAtInlet[1],
-          d->dspBufferAtOutlet[1], 0, toIndex);
-      // allow fallthrough
-    }
-    case 1: {
-      ArrayArithmetic::add(d->dspBufferAtOutlet[0], d->dspBufferAtInlet[0],
-          d->dspBufferAtOutlet[0], 0, toIndex);
-      // allow fallthrough
-    }
-    case 0: break;
+  // the output buffers are looked up for each block, as they may be bound to the host's buffers
+  float *zeroBuffer = d->graph->getBufferPool()->getZeroBuffer();
+  int numOutputChannels = d->graph->getNumOutputChannels();
+  int numInlets = (int) d->channels.size();
+  for (int i = 0; i < numInlets; i++) {
+    float *input = d->getDspBufferAtInlet(i);
+    if (d->channels[i] < 0 || d->channels[i] >= numOutputChannels || input == zeroBuffer) continue;
+    float *output = d->graph->getGlobalDspBufferAtOutlet(d->channels[i]);
+    ArrayArithmetic::add(output, input, output, 0, toIndex);
   }
 }
@@ -32,24 +32,32 @@
 
 #include "DspObject.h"
 
+/**
+ * [dac~], [dac~ channel...]
+ * Without arguments, there is one inlet for each output channel of the context. Otherwise there
+ * is one inlet for each given (1-based) channel. Channels which the context does not have are
+ * ignored.
+ */
 class DspDac : public DspObject {
   
   public:
     static MessageObject *newObject(PdMessage *initMessage, PdGraph *graph);
-    DspDac(PdGraph *graph);
+    DspDac(PdMessage *initMessage, PdGraph *graph);
     ~DspDac();
   
     static const char *getObjectLabel();
     std::string toString();
   
+    bool isSilentWithInput(const bool *isInletSilent) const;
+    bool hasSideEffects() { return true; }
+  
   private:
     static void processSignal(DspObject *dspObject, int fromIndex, int toIndex);
+  
+    /** The (0-based) output channel of each inlet. It may be one which the context does not have. */
+    vector<int> channels;
 };
 
-inline std::string DspDac::toString() {
-  return DspDac::getObjectLabel();
-}
-
 inline const char *DspDac::getObjectLabel() {
   return "dac~";
 }
@@ -43,6 +43,8 @@ class DspDelayWrite : public DspObject {
     std::string toString();
     ObjectType getObjectType();
   
+    bool hasSideEffects() { return true; }
+  
     const char *getName();
   
     inline float *getBuffer(int *index, int *length) {
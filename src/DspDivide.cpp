@@ -50,6 +50,12 @@ void DspDivide::onInletConnectionUpdate(unsigned int inletIndex) {
       ? &processSignal : &processScalar;
 }
 
+float *DspDivide::getFoldedBuffer() {
+  // [/~ 1]
+  bool isScalar = (incomingDspConnections[0].empty() || incomingDspConnections[1].empty());
+  return (isScalar && constant == 1.0f) ? dspBufferAtInlet[0] : NULL;
+}
+
 string DspDivide::toString() {
   const char *fmt = (constant == 0.0f) ? "%s" : "%s %g";
   char str[snprintf(NULL, 0, fmt, getObjectLabel(), constant)+1];
@@ -41,6 +41,9 @@ class DspDivide : public DspObject {
 
     static const char *getObjectLabel();
     std::string toString();
+  
+    float *getFoldedBuffer();
+    bool isStateless() { return true; }
 
   private:
     static void processSignal(DspObject *dspObject, int fromIndex, int toIndex);
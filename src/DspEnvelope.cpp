@@ -27,6 +27,7 @@
  *
  */
 
+#include <algorithm>
 #include "ArrayArithmetic.h"
 #include "DspEnvelope.h"
 #include "PdGraph.h"
@@ -42,12 +43,12 @@ DspEnvelope::DspEnvelope(PdMessage *initMessage, PdGraph *graph) : DspObject(0,
   if (initMessage->isFloat(0)) {
     if (initMessage->isFloat(1)) {
       // if two parameters are provided, set the window size and window interval
-      windowSize = initMessage->getFloat(0);
-      windowInterval = initMessage->getFloat(1);
+      windowSize = (int) initMessage->getFloat(0);
+      windowInterval = (int) initMessage->getFloat(1);
     } else {
       // if one parameter is provided, set the window size
       windowSize = (int) initMessage->getFloat(0);
-      setWindowInterval(windowSize/2);
+      windowInterval = windowSize / 2;
     }
   } else {
     // otherwise, use default values for the window size and interval
@@ -55,20 +56,15 @@ DspEnvelope::DspEnvelope(PdMessage *initMessage, PdGraph *graph) : DspObject(0,
     windowInterval = windowSize / 2;
   }
   
-  // NOTE(mhroth): I haven't thought very much if this fix could be better done. The issue is that
-  // if the blocksize is large (e.g., larger than the windowInterval), then env~ will never send
-  // a message. With more logic, a block size larger than the window size could be accomodated. But
-  // I am too lazy to consider this option at the moment. Thus, currently the window size and interval
-  // must be at least as large as the block size.
-  if (windowSize < graph->getBlockSize()) {
-    graph->printErr("env~ window size must be at least as large as the block size. %i reset to %i.",
-        windowSize, graph->getBlockSize());
-    windowSize = graph->getBlockSize();
+  if (windowSize < 2) {
+    graph->printErr("env~ window size must be at least 2 samples. %i reset to %i.",
+        windowSize, DEFAULT_WINDOW_SIZE);
+    windowSize = DEFAULT_WINDOW_SIZE;
   }
-  if (windowInterval < graph->getBlockSize()) {
-    graph->printErr("env~ window interval must be at least as large as the block size. %i reset to %i.",
-        windowInterval, graph->getBlockSize());
-    windowInterval = graph->getBlockSize();
+  if (windowInterval < 1) {
+    graph->printErr("env~ window interval must be at least 1 sample. %i reset to %i.",
+        windowInterval, windowSize/2);
+    windowInterval = windowSize / 2;
   }
   
   processFunction = &processSignal;
@@ -77,8 +73,10 @@ DspEnvelope::DspEnvelope(PdMessage *initMessage, PdGraph *graph) : DspObject(0,
 }
 
 DspEnvelope::~DspEnvelope() {
-  free(signalBuffer);
-  free(hanningCoefficients);
+  FREE_ALIGNED_BUFFER(hanningCoefficients);
+  FREE_ALIGNED_BUFFER(squareBuffer);
+  free(windowSums);
+  free(windowPositions);
 }
 
 string DspEnvelope::toString() {
@@ -87,28 +85,10 @@ string DspEnvelope::toString() {
   return string(str);
 }
 
-void DspEnvelope::setWindowInterval(int newInterval) {
-  int i = newInterval % graph->getBlockSize();
-  if (i == 0) {
-    // windowInterval is a multiple of blockSize. Awesome :)
-    this->windowInterval = newInterval;
-  } else if (i <= graph->getBlockSize()/2) {
-    // windowInterval is closer to the smaller multiple of blockSize
-    this->windowInterval = (newInterval/graph->getBlockSize())*graph->getBlockSize();
-  } else {
-    // windowInterval is closer to the larger multiple of blockSize
-    this->windowInterval = ((newInterval/graph->getBlockSize())+1)*graph->getBlockSize();
-  }
-}
-
 void DspEnvelope::initBuffers() {
-  // ensure that the buffer is big enough to take the number of whole blocks needed to fill it
-  numSamplesReceived = 0;
-  numSamplesReceivedSinceLastInterval = 0;
-  int numBlocksPerWindow = (windowSize % graph->getBlockSize() == 0) ? (windowSize/graph->getBlockSize()) : (windowSize/graph->getBlockSize()) + 1;
-  int bufferSize = numBlocksPerWindow * graph->getBlockSize();
-  signalBuffer = (float *) malloc(bufferSize * sizeof(float));
-  hanningCoefficients = (float *) malloc(bufferSize * sizeof(float));
+  int blockSize = graph->getBlockSize();
+  squareBuffer = ALLOC_ALIGNED_BUFFER(blockSize * sizeof(float));
+  hanningCoefficients = ALLOC_ALIGNED_BUFFER(windowSize * sizeof(float));
   float N_1 = (float) (windowSize - 1); // (N == windowSize) - 1
   float hanningSum = 0.0f;
   for (int i = 0; i < windowSize; i++) {
@@ -120,37 +100,63 @@ void DspEnvelope::initBuffers() {
     // normalise the hanning coefficients such that they represent a normalised weighted averaging
     hanningCoefficients[i] /= hanningSum;
   }
+  
+  // enough slots for all windows overlapping the window size plus those opened during one block
+  maxWindows = (windowSize + blockSize) / windowInterval + 2;
+  windowSums = (float *) malloc(maxWindows * sizeof(float));
+  windowPositions = (int *) malloc(maxWindows * sizeof(int));
+  firstWindow = 0;
+  numWindows = 0;
+  
+  // the windows which would have opened before the start have so far only seen silence. The first
+  // envelope is thus sent after at most one interval, not after a whole window.
+  for (int i = (windowSize-1) / windowInterval; i > 0; i--) {
+    windowSums[numWindows] = 0.0f;
+    windowPositions[numWindows] = i * windowInterval;
+    numWindows++;
+  }
+  samplesUntilNextWindow = 0;
 }
 
-// windowSize and windowInterval are constrained to be multiples of the block size
 void DspEnvelope::processSignal(DspObject *dspObject, int fromIndex, int toIndex) {
   DspEnvelope *d = reinterpret_cast<DspEnvelope *>(dspObject);
+  int n = toIndex - fromIndex;
   
-  // copy the input into the signal buffer
-  memcpy(d->signalBuffer + d->numSamplesReceived, d->dspBufferAtInlet[0], toIndex*sizeof(float));
-  d->numSamplesReceived += toIndex;
-  d->numSamplesReceivedSinceLastInterval += toIndex;
-  if (d->numSamplesReceived >= d->windowSize) {
-    d->numSamplesReceived = 0;
+  // the input is squared only once, no matter how many windows overlap this block
+  ArrayArithmetic::multiply(d->dspBufferAtInlet[0], d->dspBufferAtInlet[0], d->squareBuffer,
+      fromIndex, toIndex);
+  float *squares = d->squareBuffer + fromIndex;
+  
+  // open the windows which start during this block
+  while (d->samplesUntilNextWindow < n) {
+    int k = (d->firstWindow + d->numWindows) % d->maxWindows;
+    d->windowSums[k] = 0.0f;
+    d->windowPositions[k] = -d->samplesUntilNextWindow;
+    d->numWindows++;
+    d->samplesUntilNextWindow += d->windowInterval;
   }
-  if (d->numSamplesReceivedSinceLastInterval == d->windowInterval) {
-    d->numSamplesReceivedSinceLastInterval -= d->windowInterval;
-    // apply hanning window to signal and calculate Root Mean Square
-    float rms = 0.0f;
-    #if __APPLE__
-    float rmsBuffer[d->windowSize];
-    vDSP_vsq(d->signalBuffer, 1, rmsBuffer, 1, d->windowSize); // signalBuffer^2 
-    vDSP_vmul(rmsBuffer, 1, d->hanningCoefficients, 1, rmsBuffer, 1, d->windowSize); // * hanning window
-    vDSP_sve(rmsBuffer, 1, &rms, d->windowSize); // sum the result
-    #else
-    for (int i = 0; i < d->windowSize; ++i) {
-      rms += d->signalBuffer[i] * d->signalBuffer[i] * d->hanningCoefficients[i];
-    }
-    #endif
+  d->samplesUntilNextWindow -= n;
+  
+  // add the weighted energy of this block to each open window
+  for (int i = 0; i < d->numWindows; i++) {
+    int k = (d->firstWindow + i) % d->maxWindows;
+    int position = d->windowPositions[k];
+    int blockOffset = (position < 0) ? -position : 0;
+    int windowOffset = (position < 0) ? 0 : position;
+    int numSamples = std::min(n - blockOffset, d->windowSize - windowOffset);
+    d->windowSums[k] += ArrayArithmetic::dot(squares + blockOffset,
+        d->hanningCoefficients + windowOffset, numSamples);
+    d->windowPositions[k] = windowOffset + numSamples;
+  }
+  
+  // windows are complete in the order in which they were opened
+  while (d->numWindows > 0 && d->windowPositions[d->firstWindow] == d->windowSize) {
     // finish RMS calculation. sqrt is removed as it can be combined with the log operation.
     // result is normalised such that 1 RMS == 100 dB
-    rms = 10.0f * log10f(rms) + 100.0f;
-
+    float rms = 10.0f * log10f(d->windowSums[d->firstWindow]) + 100.0f;
+    d->firstWindow = (d->firstWindow + 1) % d->maxWindows;
+    d->numWindows--;
+    
     PdMessage *outgoingMessage = PD_MESSAGE_ON_STACK(1);
     // graph will schedule this at the beginning of the next block because the timestamp will be
     // behind the block start timestamp
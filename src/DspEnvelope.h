@@ -40,9 +40,8 @@ class DspEnvelope : public DspObject {
   
     /*
      * @param windowSize  The window size in samples of the analysis. Defaults to 1024.
-     * @param windowInterval  The window interval in samples of the analysis.
-     * The interval must be a multiple of the block size. If not, then it is reset to
-     * the nearest multiple. Defaults to windowSize/2, according to the mentioned constraints.
+     * @param windowInterval  The window interval in samples of the analysis. Defaults to
+     * windowSize/2. Neither the size nor the interval need to be related to the block size.
      */
     DspEnvelope(PdMessage *initMessage, PdGraph *graph);
     ~DspEnvelope();
@@ -52,21 +51,40 @@ class DspEnvelope : public DspObject {
 
     ConnectionType getConnectionType(int outletIndex) { return MESSAGE; }
   
+    bool hasSideEffects() { return true; }
+  
   private:
     static void processSignal(DspObject *dspObject, int fromIndex, int toIndex);
   
     /** Initialise the analysis buffers. */
     void initBuffers();
-    void setWindowInterval(int newInterval);
   
     int windowSize;
     int windowInterval;
   
-    int numSamplesReceived;
-    int numSamplesReceivedSinceLastInterval;
-  
-    float *signalBuffer;
     float *hanningCoefficients;
+  
+    /** The squared input of the current block. */
+    float *squareBuffer;
+  
+    /**
+     * The open analysis windows, in the order in which they were opened, as a ring of
+     * <code>maxWindows</code> slots starting at <code>firstWindow</code>. Each window accumulates
+     * the Hanning weighted sum of squares of the blocks that it overlaps.
+     */
+    float *windowSums;
+  
+    /**
+     * The number of samples which each open window has consumed. A negative value means that the
+     * window opens that many samples into the current block.
+     */
+    int *windowPositions;
+    int maxWindows;
+    int firstWindow;
+    int numWindows;
+  
+    /** The number of samples until the next window is opened. */
+    int samplesUntilNextWindow;
 };
 
 inline const char *DspEnvelope::getObjectLabel() {
@@ -32,45 +32,134 @@
 
 class PdGraph;
 
-DspFilter::DspFilter(int numMessageInlets, PdGraph *graph) : DspObject(numMessageInlets, 1, 0, 1, graph) {
-  x1 = x2 = y1 = y2 = 0.0f;
+DspFilter::DspFilter(int numMessageInlets, int numDspInlets, PdGraph *graph) :
+    DspObject(numMessageInlets, numDspInlets, 0, 1, graph) {
+  s1 = s2 = 0.0f;
+  setCoefficients(1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+  coefficientBuffer = (numDspInlets > 1) ? ALLOC_ALIGNED_BUFFER(blockSizeInt * sizeof(float)) : NULL;
 
   processFunction = &processFilter;
   processFunctionNoMessage = &processFilter;
 }
 
 DspFilter::~DspFilter() {
-  // nothing to do
+  if (coefficientBuffer != NULL) FREE_ALIGNED_BUFFER(coefficientBuffer);
 }
 
 void DspFilter::onInletConnectionUpdate(unsigned int inletIndex) {
   // TODO(mhroth)
 }
 
+bool DspFilter::isSilentWithInput(const bool *isInletSilent) const {
+  return isInletSilent[0] && fabsf(s1) < 1e-9f && fabsf(s2) < 1e-9f;
+}
+
+void DspFilter::onSleep() {
+  clear();
+}
+
+void DspFilter::clear() {
+  s1 = s2 = 0.0f;
+}
+
+void DspFilter::setCoefficients(float b0, float b1, float b2, float a1, float a2) {
+  b[0] = b0; b[1] = b1; b[2] = b2; b[3] = a1; b[4] = a2;
+  
+  // run the filter for four samples from a unit state or input, once for each column
+  for (int k = 0; k < 6; ++k) {
+    double z1 = (k == 0) ? 1.0 : 0.0;
+    double z2 = (k == 1) ? 1.0 : 0.0;
+    for (int i = 0; i < 4; ++i) {
+      double x = (k == i+2) ? 1.0 : 0.0;
+      double y = b0*x + z1;
+      z1 = b1*x - a1*y + z2;
+      z2 = b2*x - a2*y;
+      stepMatrix[8*k+i] = (float) y;
+    }
+    stepMatrix[8*k+4] = (float) z1;
+    stepMatrix[8*k+5] = (float) z2;
+    stepMatrix[8*k+6] = stepMatrix[8*k+7] = 0.0f;
+  }
+}
+
 void DspFilter::processFilter(DspObject *dspObject, int fromIndex, int toIndex) {
   DspFilter *d = reinterpret_cast<DspFilter *>(dspObject);
+  float *input = d->dspBufferAtInlet[0];
+  float *output = d->dspBufferAtOutlet[0];
+  const float b0 = d->b[0], b1 = d->b[1], b2 = d->b[2], a1 = d->b[3], a2 = d->b[4];
+  float z1 = d->s1, z2 = d->s2;
+  int i = fromIndex;
   
-  int n = toIndex - fromIndex; // number of samples to process
-  float bufferIn[n+2]; // new inlet buffer
-  bufferIn[0] = d->x2; bufferIn[1] = d->x1;
-  memcpy(bufferIn+2, d->dspBufferAtInlet[0]+fromIndex, n*sizeof(float));
-  
-  float bufferOut[n+2]; // new outlet buffer
-  bufferOut[0] = d->y2; bufferOut[1] = d->y1;
+  #if __SSE__ || __ARM_NEON__
+  // align the output to a 16-byte boundary
+  for (; (i & 0x3) && i < toIndex; ++i) {
+    float x = input[i];
+    float y = b0*x + z1;
+    z1 = b1*x - a1*y + z2;
+    z2 = b2*x - a2*y;
+    output[i] = y;
+  }
   
-  #if __APPLE__
-  vDSP_deq22(bufferIn, 1, d->b, bufferOut, 1, n);
+  const float *m = d->stepMatrix;
+  #if __SSE__
+  const __m128 ys1 = _mm_loadu_ps(m), ss1 = _mm_loadu_ps(m+4);
+  const __m128 ys2 = _mm_loadu_ps(m+8), ss2 = _mm_loadu_ps(m+12);
+  const __m128 yx0 = _mm_loadu_ps(m+16), sx0 = _mm_loadu_ps(m+20);
+  const __m128 yx1 = _mm_loadu_ps(m+24), sx1 = _mm_loadu_ps(m+28);
+  const __m128 yx2 = _mm_loadu_ps(m+32), sx2 = _mm_loadu_ps(m+36);
+  const __m128 yx3 = _mm_loadu_ps(m+40), sx3 = _mm_loadu_ps(m+44);
+  for (; i + 4 <= toIndex; i += 4) {
+    // the input is read completely before the output is written, such that they may be the same
+    __m128 x = _mm_loadu_ps(input+i);
+    __m128 x0 = _mm_shuffle_ps(x, x, 0x00);
+    __m128 x1 = _mm_shuffle_ps(x, x, 0x55);
+    __m128 x2 = _mm_shuffle_ps(x, x, 0xAA);
+    __m128 x3 = _mm_shuffle_ps(x, x, 0xFF);
+    __m128 v1 = _mm_set1_ps(z1);
+    __m128 v2 = _mm_set1_ps(z2);
+    __m128 y = _mm_add_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(ys1, v1), _mm_mul_ps(ys2, v2)),
+                   _mm_add_ps(_mm_mul_ps(yx0, x0), _mm_mul_ps(yx1, x1))),
+        _mm_add_ps(_mm_mul_ps(yx2, x2), _mm_mul_ps(yx3, x3)));
+    __m128 s = _mm_add_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(ss1, v1), _mm_mul_ps(ss2, v2)),
+                   _mm_add_ps(_mm_mul_ps(sx0, x0), _mm_mul_ps(sx1, x1))),
+        _mm_add_ps(_mm_mul_ps(sx2, x2), _mm_mul_ps(sx3, x3)));
+    _mm_store_ps(output+i, y);
+    z1 = _mm_cvtss_f32(s);
+    z2 = _mm_cvtss_f32(_mm_shuffle_ps(s, s, 0x55));
+  }
   #else
-  int _toIndex = n + 2;
-  for (int i = 2; i < _toIndex; ++i) {
-    bufferOut[i] = d->b[0]*bufferIn[i] + d->b[1]*bufferIn[i-1] + d->b[2]*bufferIn[i-2] -
-        d->b[3]*bufferOut[i-1] - d->b[4]*bufferOut[i-2];
+  const float32x4_t ys1 = vld1q_f32(m), ss1 = vld1q_f32(m+4);
+  const float32x4_t ys2 = vld1q_f32(m+8), ss2 = vld1q_f32(m+12);
+  const float32x4_t yx0 = vld1q_f32(m+16), sx0 = vld1q_f32(m+20);
+  const float32x4_t yx1 = vld1q_f32(m+24), sx1 = vld1q_f32(m+28);
+  const float32x4_t yx2 = vld1q_f32(m+32), sx2 = vld1q_f32(m+36);
+  const float32x4_t yx3 = vld1q_f32(m+40), sx3 = vld1q_f32(m+44);
+  for (; i + 4 <= toIndex; i += 4) {
+    float x0 = input[i], x1 = input[i+1], x2 = input[i+2], x3 = input[i+3];
+    float32x4_t y = vmulq_n_f32(ys1, z1);
+    float32x4_t s = vmulq_n_f32(ss1, z1);
+    y = vmlaq_n_f32(y, ys2, z2); s = vmlaq_n_f32(s, ss2, z2);
+    y = vmlaq_n_f32(y, yx0, x0); s = vmlaq_n_f32(s, sx0, x0);
+    y = vmlaq_n_f32(y, yx1, x1); s = vmlaq_n_f32(s, sx1, x1);
+    y = vmlaq_n_f32(y, yx2, x2); s = vmlaq_n_f32(s, sx2, x2);
+    y = vmlaq_n_f32(y, yx3, x3); s = vmlaq_n_f32(s, sx3, x3);
+    vst1q_f32(output+i, y);
+    z1 = vgetq_lane_f32(s, 0);
+    z2 = vgetq_lane_f32(s, 1);
   }
   #endif
+  #endif
   
-  memcpy(d->dspBufferAtOutlet[0]+fromIndex, bufferOut+2, n*sizeof(float));
+  for (; i < toIndex; ++i) {
+    float x = input[i];
+    float y = b0*x + z1;
+    z1 = b1*x - a1*y + z2;
+    z2 = b2*x - a2*y;
+    output[i] = y;
+  }
   
   // retain state
-  d->x2 = bufferIn[n]; d->x1 = bufferIn[n+1];
-  d->y2 = bufferOut[n]; d->y1 = bufferOut[n+1];
+  d->s1 = z1; d->s2 = z2;
 }
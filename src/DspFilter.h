@@ -32,20 +32,54 @@
 
 #include "DspObject.h"
 
-/** The superclass of lop~, hip~, bp~, and biquad~ */
+/**
+ * The superclass of lop~, hip~, bp~, and biquad~. The filter is computed in transposed direct form II,
+ * in place on the inlet buffer if it is shared with the outlet. Four samples at a time are computed
+ * as a state-space step, such that the outputs of the step are computed in SIMD lanes and only the
+ * two state variables depend on the previous step.
+ */
 class DspFilter : public DspObject {
   
   public:
-    DspFilter(int numMessageInlets, PdGraph *graph);
+    DspFilter(int numMessageInlets, int numDspInlets, PdGraph *graph);
     ~DspFilter();
 
     void onInletConnectionUpdate(unsigned int inletIndex);
   
+    /** A filter with silent input is silent once its state has decayed below audibility. */
+    bool isSilentWithInput(const bool *isInletSilent) const;
+  
+    /** The decayed state is flushed to zero, which also avoids processing denormals. */
+    void onSleep();
+  
   protected:  
     static void processFilter(DspObject *dspObject, int fromIndex, int toIndex);
+  
+    /**
+     * Sets the transfer function of the filter to
+     * (b0 + b1*z^-1 + b2*z^-2) / (1 + a1*z^-1 + a2*z^-2), and precomputes the state-space step.
+     */
+    void setCoefficients(float b0, float b1, float b2, float a1, float a2);
+  
+    /** Resets the filter state. */
+    void clear();
     
-    float x1, x2, y1, y2;
-    float b[5]; // filter coefficients
+    /** The filter state. */
+    float s1, s2;
+  
+    float b[5]; // filter coefficients (b0, b1, b2, a1, a2)
+  
+    /**
+     * The response of four consecutive samples to each of the two state variables and the four inputs.
+     * Column k (of eight floats) holds the four outputs, followed by the two resulting state variables.
+     */
+    float stepMatrix[6*8];
+  
+    /**
+     * A block of per-sample coefficients, used by subclasses which support signal-rate parameters.
+     * It is only allocated if the filter has more than one signal inlet.
+     */
+    float *coefficientBuffer;
 };
 
 #endif // _DSP_FILTER_H_
@@ -34,7 +34,7 @@ MessageObject *DspHighpassFilter::newObject(PdMessage *initMessage, PdGraph *gra
   return new DspHighpassFilter(initMessage, graph);
 }
 
-DspHighpassFilter::DspHighpassFilter(PdMessage *initMessage, PdGraph *graph) : DspFilter(2, graph) {
+DspHighpassFilter::DspHighpassFilter(PdMessage *initMessage, PdGraph *graph) : DspFilter(2, 2, graph) {
   // by default, the filter is initialised completely open
   calcFiltCoeff(initMessage->isFloat(0) ? initMessage->getFloat(0) : 0.0f);
 }
@@ -49,11 +49,40 @@ void DspHighpassFilter::calcFiltCoeff(float fc) {
   else if (fc < 0.0f) fc = 10.0f;
   
   float alpha = graph->getSampleRate() / ((2.0f*M_PI*fc) + graph->getSampleRate());
-  b[0] = alpha;
-  b[1] = -alpha;
-  b[2] = 0.0f;
-  b[3] = -alpha;
-  b[4] = 0.0f;
+  setCoefficients(alpha, -alpha, 0.0f, -alpha, 0.0f);
+}
+
+void DspHighpassFilter::onInletConnectionUpdate(unsigned int inletIndex) {
+  processFunction = processFunctionNoMessage = (incomingDspConnections[1].size() > 0)
+      ? &processSignalCutoff : &processFilter;
+}
+
+void DspHighpassFilter::processSignalCutoff(DspObject *dspObject, int fromIndex, int toIndex) {
+  DspHighpassFilter *d = reinterpret_cast<DspHighpassFilter *>(dspObject);
+  float *input = d->dspBufferAtInlet[0];
+  float *cutoff = d->dspBufferAtInlet[1];
+  float *output = d->dspBufferAtOutlet[0];
+  float *alpha = d->coefficientBuffer;
+  const float sampleRate = d->graph->getSampleRate();
+  const float maxCutoff = 0.5f * sampleRate;
+  const float twoPi = 2.0f * (float) M_PI; // not promoted to double in the loop
+  
+  // the coefficients are computed without branches, such that the loop is vectorised
+  for (int i = fromIndex; i < toIndex; ++i) {
+    float fc = cutoff[i];
+    fc = (fc > maxCutoff) ? maxCutoff : fc;
+    fc = (fc < 0.0f) ? 10.0f : fc;
+    alpha[i] = sampleRate / ((twoPi*fc) + sampleRate);
+  }
+  
+  float z1 = d->s1;
+  for (int i = fromIndex; i < toIndex; ++i) {
+    float x = input[i];
+    float y = alpha[i]*x + z1;
+    z1 = alpha[i] * (y - x);
+    output[i] = y;
+  }
+  d->s1 = z1;
 }
 
 void DspHighpassFilter::processMessage(int inletIndex, PdMessage *message) {
@@ -66,8 +95,7 @@ void DspHighpassFilter::processMessage(int inletIndex, PdMessage *message) {
         }
         case SYMBOL: {
           if (message->isSymbol(0, "clear")) {
-            x1 = x2 = 0.0f;
-            dspBufferAtOutlet[0][0] = dspBufferAtOutlet[0][1] = 0.0f;
+            clear();
           }
           break;
         }
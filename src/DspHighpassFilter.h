@@ -35,6 +35,7 @@
 /**
  * [hip~], [hip~ float]
  * A one-tap IIR filter: y[i] = a * (y[i-1] + x[i] - x[i-1])
+ * The cutoff frequency may also be given as a signal at the right inlet.
  */
 class DspHighpassFilter : public DspFilter {
   
@@ -46,7 +47,12 @@ class DspHighpassFilter : public DspFilter {
     static const char *getObjectLabel();
     std::string toString();
   
+    void onInletConnectionUpdate(unsigned int inletIndex);
+  
   private:
+    /** Filters with the cutoff frequency given per sample by the signal at the right inlet. */
+    static void processSignalCutoff(DspObject *dspObject, int fromIndex, int toIndex);
+  
     void processMessage(int inletIndex, PdMessage *message);
     void calcFiltCoeff(float cutoffFrequency);
 };
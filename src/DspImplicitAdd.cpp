@@ -28,7 +28,9 @@
  */
 
 #include "ArrayArithmetic.h"
+#include "BufferPool.h"
 #include "DspImplicitAdd.h"
+#include "PdGraph.h"
 
 MessageObject *DspImplicitAdd::newObject(PdMessage *initMessage, PdGraph *graph) {
   return new DspImplicitAdd(initMessage, graph);
@@ -42,6 +44,13 @@ DspImplicitAdd::~DspImplicitAdd() {
   // nothing to do
 }
 
+float *DspImplicitAdd::getFoldedBuffer() {
+  float *zeroBuffer = graph->getBufferPool()->getZeroBuffer();
+  if (dspBufferAtInlet[0] == zeroBuffer) return dspBufferAtInlet[1];
+  if (dspBufferAtInlet[1] == zeroBuffer) return dspBufferAtInlet[0];
+  return NULL;
+}
+
 void DspImplicitAdd::processSignal(DspObject *dspObject, int fromIndex, int toIndex) {
   DspImplicitAdd *d = reinterpret_cast<DspImplicitAdd *>(dspObject);
   ArrayArithmetic::add(d->dspBufferAtInlet[0], d->dspBufferAtInlet[1], d->dspBufferAtOutlet[0], 0, toIndex);
@@ -46,6 +46,10 @@ public:
   static const char *getObjectLabel();
   std::string toString();
   
+  bool isSilentWithInput(const bool *isInletSilent) const { return isInletSilent[0] && isInletSilent[1]; }
+  float *getFoldedBuffer();
+  bool isStateless() { return true; }
+  
   private:
     static void processSignal(DspObject *dspObject, int fromIndex, int toIndex);
 };
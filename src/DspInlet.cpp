@@ -68,6 +68,11 @@ void DspInlet::setDspBufferAtInlet(float *buffer, unsigned int inletIndex) {
   }
 }
 
+void DspInlet::setUnfoldedBufferAtInlet(float *buffer, unsigned int inletIndex) {
+  DspObject::setUnfoldedBufferAtInlet(buffer, inletIndex);
+  setUnfoldedBufferAtReaders(0, buffer); // the buffer is passed on unchanged
+}
+
 float *DspInlet::getDspBufferAtOutlet(int outletIndex) {
   return (dspBufferAtInlet[0] == NULL) ? graph->getBufferPool()->getZeroBuffer() : dspBufferAtInlet[0];
 }
@@ -57,6 +57,7 @@ class DspInlet : public DspObject {
     bool doesProcessAudio();
   
     void setDspBufferAtInlet(float *buffer, unsigned int inletIndex);
+    void setUnfoldedBufferAtInlet(float *buffer, unsigned int inletIndex);
     bool canSetBufferAtOutlet(unsigned int outletIndex);
     float *getDspBufferAtOutlet(int outletIndex);
 };
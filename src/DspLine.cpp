@@ -78,48 +78,25 @@ void DspLine::processMessage(int inletIndex, PdMessage *message) {
 }
 
 void DspLine::processDspWithIndex(int fromIndex, int toIndex) {
+  // the number of samples to be processed this iteration. It may be zero if several messages are
+  // received at once.
+  int n = toIndex - fromIndex;
+  if (n <= 0) return;
+
   if (numSamplesToTarget <= 0.0f) { // if we have already reached the target
-    int n = toIndex - fromIndex;
-    if (n > 0) { // n may be zero
-      ArrayArithmetic::fill(dspBufferAtOutlet[0], target, fromIndex, toIndex);
-      lastOutputSample = target;
-    }
+    ArrayArithmetic::fill(dspBufferAtOutlet[0], target, fromIndex, toIndex);
+    lastOutputSample = target;
+  } else if (numSamplesToTarget < n) {
+    // if we will arrive at the target while processing
+    int targetIndexInt = fromIndex + numSamplesToTarget;
+    ArrayArithmetic::ramp(dspBufferAtOutlet[0], lastOutputSample, slope, fromIndex, targetIndexInt);
+    ArrayArithmetic::fill(dspBufferAtOutlet[0], target, targetIndexInt, toIndex);
+    lastOutputSample = target;
+    numSamplesToTarget = 0;
   } else {
-    // the number of samples to be processed this iteration
-    int n = toIndex - fromIndex;
-    if (n > 0) { // n may be zero
-      // if there is anything to process at all (several messages may be received at once)
-      if (numSamplesToTarget < n) {
-        int targetIndexInt = fromIndex + numSamplesToTarget;
-        #if __APPLE__
-        vDSP_vramp(&lastOutputSample, &slope, dspBufferAtOutlet[0]+fromIndex, 1, targetIndexInt-fromIndex);
-        vDSP_vfill(&target, dspBufferAtOutlet[0]+targetIndexInt, 1, toIndex-targetIndexInt);
-        #else
-        // if we will process more samples than we have remaining to the target
-        // i.e., if we will arrive at the target while processing
-        dspBufferAtOutlet[0][fromIndex] = lastOutputSample;
-        for (int i = fromIndex+1; i < targetIndexInt; i++) {
-          dspBufferAtOutlet[0][i] = dspBufferAtOutlet[0][i-1] + slope;
-        }
-        for (int i = targetIndexInt; i < toIndex; i++) {
-          dspBufferAtOutlet[0][i] = target;
-        }
-        #endif
-        lastOutputSample = target;
-        numSamplesToTarget = 0;
-      } else {
-        // if the target is far off
-        #if __APPLE__
-        vDSP_vramp(&lastOutputSample, &slope, dspBufferAtOutlet[0]+fromIndex, 1, n);
-        #else
-        dspBufferAtOutlet[0][fromIndex] = lastOutputSample;
-        for (int i = fromIndex+1; i < toIndex; i++) {
-          dspBufferAtOutlet[0][i] = dspBufferAtOutlet[0][i-1] + slope;
-        }
-        #endif
-        lastOutputSample = dspBufferAtOutlet[0][toIndex-1] + slope;
-        numSamplesToTarget -= n;
-      }
-    }
+    // if the target is far off
+    ArrayArithmetic::ramp(dspBufferAtOutlet[0], lastOutputSample, slope, fromIndex, toIndex);
+    lastOutputSample += n * slope;
+    numSamplesToTarget -= n;
   }
 }
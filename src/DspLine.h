@@ -43,6 +43,11 @@ class DspLine : public DspObject {
     static const char *getObjectLabel();
     std::string toString();
   
+    /** [line~] is silent once it has come to rest at zero. */
+    bool isSilentWithInput(const bool *isInletSilent) const {
+      return numSamplesToTarget <= 0.0f && target == 0.0f;
+    }
+  
   private:
     void processMessage(int inletIndex, PdMessage *message);
     void processDspWithIndex(int fromIndex, int toIndex);
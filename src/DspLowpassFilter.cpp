@@ -34,7 +34,7 @@ MessageObject *DspLowpassFilter::newObject(PdMessage *initMessage, PdGraph *grap
   return new DspLowpassFilter(initMessage, graph);
 }
 
-DspLowpassFilter::DspLowpassFilter(PdMessage *initMessage, PdGraph *graph) : DspFilter(2, graph) {
+DspLowpassFilter::DspLowpassFilter(PdMessage *initMessage, PdGraph *graph) : DspFilter(2, 2, graph) {
   calcFiltCoeff(initMessage->isFloat(0) ? initMessage->getFloat(0) : graph->getSampleRate()/2.0f);
 }
 
@@ -49,11 +49,40 @@ void DspLowpassFilter::calcFiltCoeff(float fc) {
   
   float wc = 2.0f*M_PI*fc;
   float alpha = wc / (wc + graph->getSampleRate());
-  b[0] = alpha;
-  b[1] = 0.0f;
-  b[2] = 0.0f;
-  b[3] = -(1.0f-alpha);
-  b[4] = 0.0f;
+  setCoefficients(alpha, 0.0f, 0.0f, -(1.0f-alpha), 0.0f);
+}
+
+void DspLowpassFilter::onInletConnectionUpdate(unsigned int inletIndex) {
+  processFunction = processFunctionNoMessage = (incomingDspConnections[1].size() > 0)
+      ? &processSignalCutoff : &processFilter;
+}
+
+void DspLowpassFilter::processSignalCutoff(DspObject *dspObject, int fromIndex, int toIndex) {
+  DspLowpassFilter *d = reinterpret_cast<DspLowpassFilter *>(dspObject);
+  float *input = d->dspBufferAtInlet[0];
+  float *cutoff = d->dspBufferAtInlet[1];
+  float *output = d->dspBufferAtOutlet[0];
+  float *alpha = d->coefficientBuffer;
+  const float sampleRate = d->graph->getSampleRate();
+  const float maxCutoff = 0.5f * sampleRate;
+  const float twoPi = 2.0f * (float) M_PI; // not promoted to double in the loop
+  
+  // the coefficients are computed without branches, such that the loop is vectorised
+  for (int i = fromIndex; i < toIndex; ++i) {
+    float fc = cutoff[i];
+    fc = (fc > maxCutoff) ? maxCutoff : fc;
+    fc = (fc < 0.0f) ? 0.0f : fc;
+    float wc = twoPi*fc;
+    alpha[i] = wc / (wc + sampleRate);
+  }
+  
+  float z1 = d->s1;
+  for (int i = fromIndex; i < toIndex; ++i) {
+    float y = alpha[i]*input[i] + z1;
+    z1 = (1.0f-alpha[i]) * y;
+    output[i] = y;
+  }
+  d->s1 = z1;
 }
 
 void DspLowpassFilter::processMessage(int inletIndex, PdMessage *message) {
@@ -66,7 +95,7 @@ void DspLowpassFilter::processMessage(int inletIndex, PdMessage *message) {
         }
         case SYMBOL: {
           if (message->isSymbol(0, "clear")) {
-            x1 = x2 = dspBufferAtOutlet[0][0] = dspBufferAtOutlet[0][1] = 0.0f;
+            clear();
           }
           break;
         }
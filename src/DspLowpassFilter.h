@@ -35,6 +35,7 @@
 /**
  * [lop~]
  * Specficially implement a one-tap IIR filter: y = alpha * x_0 + (1-alpha) * y_-1
+ * The cutoff frequency may also be given as a signal at the right inlet.
  */
 class DspLowpassFilter : public DspFilter {
   
@@ -48,7 +49,12 @@ class DspLowpassFilter : public DspFilter {
   
     void processMessage(int inletIndex, PdMessage *message);
   
+    void onInletConnectionUpdate(unsigned int inletIndex);
+  
   private:
+    /** Filters with the cutoff frequency given per sample by the signal at the right inlet. */
+    static void processSignalCutoff(DspObject *dspObject, int fromIndex, int toIndex);
+  
     void calcFiltCoeff(float cutoffFrequency);
 };
 
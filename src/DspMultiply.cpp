@@ -28,9 +28,9 @@
  */
 
 #include "ArrayArithmetic.h"
+#include "BufferPool.h"
 #include "DspMultiply.h"
-
-class PdGraph;
+#include "PdGraph.h"
 
 MessageObject *DspMultiply::newObject(PdMessage *initMessage, PdGraph *graph) {
   return new DspMultiply(initMessage, graph);
@@ -63,6 +63,19 @@ void DspMultiply::onInletConnectionUpdate(unsigned int inletIndex) {
   }
 }
 
+bool DspMultiply::isSilentWithInput(const bool *isInletSilent) const {
+  bool isSignal = !incomingDspConnections[0].empty() && !incomingDspConnections[1].empty();
+  return isInletSilent[0] || (isSignal ? isInletSilent[1] : (constant == 0.0f));
+}
+
+float *DspMultiply::getFoldedBuffer() {
+  if (incomingDspConnections[0].empty() || incomingDspConnections[1].empty()) {
+    if (constant == 0.0f) return graph->getBufferPool()->getZeroBuffer(); // [*~ 0]
+    if (constant == 1.0f) return dspBufferAtInlet[0]; // [*~ 1]
+  }
+  return NULL;
+}
+
 void DspMultiply::processMessage(int inletIndex, PdMessage *message) {
   switch (inletIndex) {
     case 0: if (message->isFloat(0)) inputConstant = message->getFloat(0); break;
@@ -42,6 +42,9 @@ class DspMultiply : public DspObject {
     static const char *getObjectLabel();
     std::string toString();
   
+    bool isSilentWithInput(const bool *isInletSilent) const;
+    float *getFoldedBuffer();
+    bool isStateless() { return true; }
 
   private:
     static void processSignal(DspObject *dspObject, int fromIndex, int toIndex);
@@ -31,6 +31,7 @@
 #include "BufferPool.h"
 #include "DspImplicitAdd.h"
 #include "DspObject.h"
+#include "PdContext.h"
 #include "PdGraph.h"
 
 
@@ -48,6 +49,9 @@ DspObject::DspObject(int numMessageInlets, int numDspInlets, int numMessageOutle
 
 void DspObject::init(int numDspInlets, int numDspOutlets, int blockSize) {
   blockSizeInt = blockSize;
+  isFolded = false;
+  unfoldedProcessFunction = NULL;
+  unfoldedBuffer = NULL;
   processFunction = &processFunctionDefaultNoMessage;
   processFunctionNoMessage = &processFunctionDefaultNoMessage;
   
@@ -70,6 +74,7 @@ DspObject::~DspObject() {
   clearMessageQueue();
   
   // inlet and outlet buffers are managed by the BufferPool
+  if (unfoldedBuffer != NULL) FREE_ALIGNED_BUFFER(unfoldedBuffer);
   if (getNumDspInlets() > 2) free(dspBufferAtInlet[2]);
   if (getNumDspOutlets() > 2) free(dspBufferAtOutlet[2]);
 }
@@ -81,6 +86,10 @@ ConnectionType DspObject::getConnectionType(int outletIndex) {
   return DSP;
 }
 
+ConnectionType DspObject::getInletConnectionType(int inletIndex) {
+  return (inletIndex >= 0 && inletIndex < (int) getNumDspInlets()) ? DSP : MESSAGE;
+}
+
 float *DspObject::getDspBufferAtInlet(int inletIndex) {
   return (inletIndex < 2)
       ? dspBufferAtInlet[inletIndex] : ((float **) dspBufferAtInlet[2])[inletIndex-2];
@@ -192,7 +201,15 @@ void DspObject::clearMessageQueue() {
 void DspObject::receiveMessage(int inletIndex, PdMessage *message) {
   // Queue the message to be processed during the DSP round only if the graph is switched on.
   // Otherwise messages would begin to pile up because the graph is not processed.
-  if (graph->isSwitchedOn()) {
+  if (isFolded && graph->getContext()->hasValidProcessOrder()) {
+    // the object is processed again in its place, such that the process order remains valid
+    unfold();
+  }
+  if (isFolded) {
+    // The process order is about to be recomputed, and with it the folding of this object. The
+    // message is applied immediately.
+    processMessage(inletIndex, message);
+  } else if (graph->isSwitchedOn()) {
     // Copy the message to the heap so that it is available to process later.
     // The message is released once it is consumed in processDsp().
     messageQueue.push(make_pair(message->copyToHeap(), inletIndex));
@@ -200,6 +217,9 @@ void DspObject::receiveMessage(int inletIndex, PdMessage *message) {
     // only process the message if the process function is set to the default no-message function.
     // If it is set to anything else, then it is assumed that messages should not be processed.
     if (processFunction == processFunctionNoMessage) processFunction = &processFunctionMessage;
+    
+    // the message may change the output of this object, so its graph must be processed again
+    graph->wake();
   }
 }
 
@@ -210,23 +230,35 @@ void DspObject::processFunctionDefaultNoMessage(DspObject *dspObject, int fromIn
   dspObject->processDspWithIndex(fromIndex, toIndex);
 }
 
+void DspObject::processFunctionFolded(DspObject *dspObject, int fromIndex, int toIndex) {
+  // nothing to do, the outlet buffer is known without processing
+}
+
 void DspObject::processFunctionMessage(DspObject *dspObject, int fromIndex, int toIndex) {
-  double blockIndexOfLastMessage = 0.0; // reset the block index of the last received message
+  // Split points are rounded down to the control granularity. Messages which fall into the same
+  // control period are applied one after another without processing in between, and no empty
+  // segments are processed.
+  int granularity = dspObject->graph->getContext()->getControlGranularity();
+  int blockIndexOfLastSplit = fromIndex;
   do { // there is at least one message
     MessageLetPair messageLetPair = dspObject->messageQueue.front();
     PdMessage *message = messageLetPair.first;
     unsigned int inletIndex = messageLetPair.second;
     
-    double blockIndexOfCurrentMessage = dspObject->graph->getBlockIndex(message);
-    dspObject->processFunctionNoMessage(dspObject,
-        ceil(blockIndexOfLastMessage), ceil(blockIndexOfCurrentMessage));
+    int blockIndexOfCurrentMessage = (int) ceil(dspObject->graph->getBlockIndex(message));
+    blockIndexOfCurrentMessage -= blockIndexOfCurrentMessage % granularity;
+    if (blockIndexOfCurrentMessage > toIndex) blockIndexOfCurrentMessage = toIndex;
+    if (blockIndexOfCurrentMessage > blockIndexOfLastSplit) {
+      dspObject->processFunctionNoMessage(dspObject, blockIndexOfLastSplit, blockIndexOfCurrentMessage);
+      blockIndexOfLastSplit = blockIndexOfCurrentMessage;
+    }
     dspObject->processMessage(inletIndex, message);
     message->freeMessage(); // free the message from the head, the message has been consumed.
     dspObject->messageQueue.pop();
-    
-    blockIndexOfLastMessage = blockIndexOfCurrentMessage;
   } while (!dspObject->messageQueue.empty());
-  dspObject->processFunctionNoMessage(dspObject, ceil(blockIndexOfLastMessage), toIndex);
+  if (blockIndexOfLastSplit < toIndex) {
+    dspObject->processFunctionNoMessage(dspObject, blockIndexOfLastSplit, toIndex);
+  }
   
   // because messages are received much less often than on a per-block basis, once messages are
   // processed in this block, return to the default process function which assumes that no messages
@@ -258,12 +290,78 @@ bool DspObject::isLeafNode() {
   }
 }
 
+DspObject *DspObject::redirectBufferAtInlet(unsigned int inletIndex, float *buffer, int *outletIndex,
+    float **previousBuffer) {
+  if (incomingDspConnections[inletIndex].size() != 1) return NULL;
+  ObjectLetPair objectLetPair = incomingDspConnections[inletIndex].front();
+  DspObject *dspObject = reinterpret_cast<DspObject *>(objectLetPair.first);
+  int index = objectLetPair.second;
+  
+  // Graphs and objects which pass buffers through are not processed themselves. The pool buffer of
+  // the object has already been released by this object, and is not needed anymore.
+  if (dspObject->getObjectType() == OBJECT_PD || !dspObject->doesProcessAudio() ||
+      dspObject->isFolded || !dspObject->canSetBufferAtOutlet(index) ||
+      dspObject->getOutgoingDspConnections(index).size() != 1 ||
+      dspObject->getDspBufferAtOutlet(index) != getDspBufferAtInlet(inletIndex)) {
+    return NULL;
+  }
+  
+  *outletIndex = index;
+  *previousBuffer = getDspBufferAtInlet(inletIndex);
+  dspObject->setDspBufferAtOutlet(buffer, index);
+  setDspBufferAtInlet(buffer, inletIndex);
+  return dspObject;
+}
+
+void DspObject::restoreRedirectedObject(DspObject **redirectedObject, int outletIndex,
+    float *previousBuffer) {
+  if (*redirectedObject != NULL) {
+    (*redirectedObject)->setDspBufferAtOutlet(previousBuffer, outletIndex);
+    *redirectedObject = NULL;
+    graph->getContext()->invalidateProcessOrder();
+  }
+}
+
+float *DspObject::getFoldedOutletBuffer() {
+  if (getNumDspOutlets() != 1 || !canSetBufferAtOutlet(0) || hasPendingMessages()) return NULL;
+  for (int i = 0; i < incomingMessageConnections.size(); i++) {
+    if (!incomingMessageConnections[i].empty()) return NULL;
+  }
+  
+  float *buffer = getFoldedBuffer();
+  if (buffer != NULL || !isStateless()) return buffer;
+  
+  // if all input is constant, then so is the output. It is computed once.
+  BufferPool *bufferPool = graph->getBufferPool();
+  float constant = 0.0f;
+  for (int i = 0; i < getNumDspInlets(); i++) {
+    if (!bufferPool->isConstantBuffer(getDspBufferAtInlet(i), &constant)) return NULL;
+  }
+  float *output = ALLOC_ALIGNED_BUFFER(blockSizeInt * sizeof(float));
+  dspBufferAtOutlet[0] = output;
+  processFunction(this, 0, blockSizeInt);
+  dspBufferAtOutlet[0] = NULL;
+  constant = output[0];
+  bool isConstant = (constant == constant); // NaN is not folded
+  for (int i = 1; i < blockSizeInt && isConstant; i++) {
+    isConstant = (output[i] == constant);
+  }
+  FREE_ALIGNED_BUFFER(output);
+  return isConstant ? bufferPool->getConstantBuffer(constant) : NULL;
+}
+
 list<DspObject *> DspObject::getProcessOrder() {
   if (isOrdered) {
     // if this object has already been ordered, then move on
     return list<DspObject *>();
   } else {
     isOrdered = true;
+    if (isFolded) {
+      // the object is folded again below if its output is still known
+      isFolded = false;
+      if (processFunction == &processFunctionFolded) processFunction = unfoldedProcessFunction;
+    }
+    
     list<DspObject *> processList;
     for (int i = 0; i < incomingMessageConnections.size(); i++) {
       for (list<ObjectLetPair>::iterator it = incomingMessageConnections[i].begin();
@@ -293,6 +391,7 @@ list<DspObject *> DspObject::getProcessOrder() {
           DspObject *dspObject = reinterpret_cast<DspObject *>(objectLetPair.first);
           float *buffer = dspObject->getDspBufferAtOutlet(objectLetPair.second);
           setDspBufferAtInlet(buffer, i);
+          dspObject->addBufferReader(objectLetPair.second, this, i);
           // NOTE(mhroth): inlet buffer is released once all inlet buffers have been resolved
           // This is so that a buffer at an earlier inlet is not used when resolving buffers
           // while in the getProcessOrder() function of a following inlet.
@@ -318,6 +417,9 @@ list<DspObject *> DspObject::getProcessOrder() {
           ObjectLetPair leftOlPair = *it++;
           list<DspObject *> parentProcessList = leftOlPair.first->getProcessOrder();
           processList.splice(processList.end(), parentProcessList);
+          DspObject *leftObject = reinterpret_cast<DspObject *>(leftOlPair.first);
+          unsigned int leftOutletIndex = leftOlPair.second;
+          float *leftBuffer = leftObject->getDspBufferAtOutlet(leftOutletIndex);
           
           while (it != incomingDspConnections[i].end()) {
             ObjectLetPair rightOlPair = *it++;
@@ -325,29 +427,49 @@ list<DspObject *> DspObject::getProcessOrder() {
             processList.splice(processList.end(), parentProcessList);
             
             DspImplicitAdd *dspAdd = new DspImplicitAdd(dspAddInitMessage, getGraph());
-            float *buffer = reinterpret_cast<DspObject *>(leftOlPair.first)->getDspBufferAtOutlet(leftOlPair.second);
-            dspAdd->setDspBufferAtInlet(buffer, 0);
-            bufferPool->releaseBuffer(buffer);
+            dspAdd->setDspBufferAtInlet(leftBuffer, 0);
+            leftObject->addBufferReader(leftOutletIndex, dspAdd, 0);
+            DspObject *rightObject = reinterpret_cast<DspObject *>(rightOlPair.first);
+            float *rightBuffer = rightObject->getDspBufferAtOutlet(rightOlPair.second);
+            dspAdd->setDspBufferAtInlet(rightBuffer, 1);
+            rightObject->addBufferReader(rightOlPair.second, dspAdd, 1);
             
-            buffer = reinterpret_cast<DspObject *>(rightOlPair.first)->getDspBufferAtOutlet(rightOlPair.second);
-            dspAdd->setDspBufferAtInlet(buffer, 1);
-            bufferPool->releaseBuffer(buffer);
+            // if the sum is known, the +~~ is folded
+            float *foldedBuffer = dspAdd->getFoldedOutletBuffer();
+            if (foldedBuffer != NULL) {
+              if (bufferPool->isReservedBuffer(foldedBuffer)) bufferPool->reserveBuffer(foldedBuffer, 1);
+              dspAdd->fold();
+            }
+            bufferPool->releaseBuffer(leftBuffer);
+            bufferPool->releaseBuffer(rightBuffer);
             
             // assign the output buffer of the +~~
-            dspAdd->setDspBufferAtOutlet(bufferPool->getBuffer(1), 0);
-            
+            leftBuffer = (foldedBuffer != NULL) ? foldedBuffer : bufferPool->getBuffer(1);
+            dspAdd->setDspBufferAtOutlet(leftBuffer, 0);
             processList.push_back(dspAdd);
-            leftOlPair = make_pair(dspAdd, 0);
+            leftObject = dspAdd;
+            leftOutletIndex = 0;
           }
           
-          float *buffer = reinterpret_cast<DspObject *>(leftOlPair.first)->getDspBufferAtOutlet(leftOlPair.second);
-          setDspBufferAtInlet(buffer, i);
+          setDspBufferAtInlet(leftBuffer, i);
+          leftObject->addBufferReader(leftOutletIndex, this, i);
           // inlet buffer is released once all inlet buffers have been resolved
           break;
         }
       }
     }
     
+    // if the output is known without processing, it is passed on directly. A pool buffer must be
+    // reserved for all receivers before the inlet buffers are released. Buffers which the pool does
+    // not own (e.g. of [send~]) outlive the process order anyway.
+    float *foldedBuffer = getFoldedOutletBuffer();
+    if (foldedBuffer != NULL) {
+      if (bufferPool->isReservedBuffer(foldedBuffer)) {
+        bufferPool->reserveBuffer(foldedBuffer, outgoingDspConnections[0].size());
+      }
+      fold();
+    }
+    
     // release the inlet buffers only after everything has been set up
     for (int i = 0; i < getNumDspInlets(); i++) {
       float *buffer = getDspBufferAtInlet(i);
@@ -355,16 +477,71 @@ list<DspObject *> DspObject::getProcessOrder() {
     }
     
     // set the outlet buffers
-    for (int i = 0; i < getNumDspOutlets(); i++) {
-      if (canSetBufferAtOutlet(i)) {
-        float *buffer = bufferPool->getBuffer(outgoingDspConnections[i].size());
-        setDspBufferAtOutlet(buffer, i);
+    if (isFolded) {
+      setDspBufferAtOutlet(foldedBuffer, 0);
+    } else {
+      if (unfoldedBuffer != NULL) {
+        FREE_ALIGNED_BUFFER(unfoldedBuffer);
+        unfoldedBuffer = NULL;
+      }
+      for (int i = 0; i < getNumDspOutlets(); i++) {
+        if (canSetBufferAtOutlet(i)) {
+          float *buffer = bufferPool->getBuffer(outgoingDspConnections[i].size());
+          setDspBufferAtOutlet(buffer, i);
+        }
       }
     }
     
     // NOTE(mhroth): even if an object does not process audio, its buffer still needs to be connected.
     // They may be passed on to other objects, such as s~/r~ pairs
+    // folded objects keep their place, such that they can be unfolded without reordering
     if (doesProcessAudio()) processList.push_back(this);
     return processList;
   }
 }
+
+void DspObject::resetOrderedFlag() {
+  MessageObject::resetOrderedFlag();
+  bufferReaders.clear();
+}
+
+void DspObject::addBufferReader(unsigned int outletIndex, DspObject *reader, unsigned int inletIndex) {
+  bufferReaders.push_back(make_pair(outletIndex, ObjectLetPair(reader, inletIndex)));
+}
+
+void DspObject::setUnfoldedBufferAtReaders(unsigned int outletIndex, float *buffer) {
+  for (list<pair<unsigned int, ObjectLetPair> >::iterator it = bufferReaders.begin();
+      it != bufferReaders.end(); ++it) {
+    if ((*it).first == outletIndex) {
+      DspObject *reader = reinterpret_cast<DspObject *>((*it).second.first);
+      reader->setUnfoldedBufferAtInlet(buffer, (*it).second.second);
+    }
+  }
+}
+
+void DspObject::setUnfoldedBufferAtInlet(float *buffer, unsigned int inletIndex) {
+  DspObject::setDspBufferAtInlet(buffer, inletIndex);
+  if (isFolded) unfold();
+}
+
+void DspObject::fold() {
+  isFolded = true;
+  unfoldedProcessFunction = processFunction;
+  processFunction = &processFunctionFolded;
+  
+  // the buffer into which the object writes once unfolded is allocated here, off the audio thread
+  if (unfoldedBuffer == NULL) {
+    unfoldedBuffer = ALLOC_ALIGNED_BUFFER(blockSizeInt * sizeof(float));
+  }
+  memset(unfoldedBuffer, 0, blockSizeInt * sizeof(float));
+}
+
+void DspObject::unfold() {
+  isFolded = false;
+  if (processFunction == &processFunctionFolded) processFunction = unfoldedProcessFunction;
+  
+  // the folded buffer may be shared, so the object writes into its own buffer from fold()
+  setDspBufferAtOutlet(unfoldedBuffer, 0);
+  graph->invalidateSilenceMap();
+  setUnfoldedBufferAtReaders(0, unfoldedBuffer);
+}
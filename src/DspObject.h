@@ -78,6 +78,9 @@ class DspObject : public MessageObject {
   
     /** Returns the connection type of the given outlet. */
     virtual ConnectionType getConnectionType(int outletIndex);
+  
+    /** The signal inlets are the first <code>getNumDspInlets()</code> inlets. */
+    virtual ConnectionType getInletConnectionType(int inletIndex);
 
     /** Get and set buffers at inlets and outlets. */
     virtual void setDspBufferAtInlet(float *buffer, unsigned int inletIndex);
@@ -100,6 +103,24 @@ class DspObject : public MessageObject {
 
     virtual list<DspObject *> getProcessOrder();
   
+    /** Also forgets the readers registered during the previous ordering. */
+    void resetOrderedFlag();
+  
+    /**
+     * Registers an object reading the buffer at the given outlet of this object. Called during
+     * process ordering, such that a folded object can later redirect its readers when unfolding.
+     */
+    virtual void addBufferReader(unsigned int outletIndex, DspObject *reader, unsigned int inletIndex);
+  
+    /** Returns <code>true</code> if this object is not processed, as its output is known. */
+    bool isFoldedAway() { return isFolded; }
+  
+    /**
+     * Sets the buffer at the given inlet after the connected object has unfolded, without changing
+     * the process order. A folded object unfolds in turn, as its output may no longer be known.
+     */
+    virtual void setUnfoldedBufferAtInlet(float *buffer, unsigned int inletIndex);
+  
     virtual unsigned int getNumInlets() {
       return max(incomingMessageConnections.size(), incomingDspConnections.size());
     }
@@ -127,11 +148,49 @@ class DspObject : public MessageObject {
     /** Returns only outgoing dsp connections from the given outlet. */
     virtual list<ObjectLetPair> getOutgoingDspConnections(unsigned int outletIndex);
   
+    /**
+     * Returns <code>true</code> if all outlets of this object are guaranteed to be silent during
+     * the next block, given the silence at each dsp inlet and that no further messages arrive.
+     * Objects with internal state may only return <code>true</code> once that state has settled.
+     * This is used to put idle graphs to sleep. By default, objects are never assumed to be silent.
+     */
+    virtual bool isSilentWithInput(const bool *isInletSilent) const { return false; }
+  
+    /**
+     * Returns <code>true</code> if this object has effects beyond writing to its outlet buffers, such
+     * as adding to the global output or writing a named buffer. A graph only sleeps if all of these
+     * objects are silent. Objects which only write to their outlets need not be silent themselves.
+     */
+    virtual bool hasSideEffects() { return false; }
+  
+    /**
+     * Called when the graph of this object falls asleep, after this object has been found silent.
+     * Objects whose state has decayed below audibility flush it to zero.
+     */
+    virtual void onSleep() {}
+  
+    /** Returns <code>true</code> if messages are waiting to be processed in the next block. */
+    bool hasPendingMessages() const { return !messageQueue.empty(); }
+  
+    /**
+     * Constant folding. Returns the buffer holding the output of this object if it is known without
+     * processing, e.g. the inlet buffer of an identity such as [*~ 1]. It is called during process
+     * ordering once all inlet buffers have been resolved. Returns <code>NULL</code> by default.
+     */
+    virtual float *getFoldedBuffer() { return NULL; }
+  
+    /**
+     * Returns <code>true</code> if the output of this object depends only on its current input and
+     * arguments. The output of such objects is folded into a constant buffer if all input is constant.
+     */
+    virtual bool isStateless() { return false; }
+  
     static const char *getObjectLabel() { return "obj~"; }
     
   protected:
     static void processFunctionDefaultNoMessage(DspObject *dspObject, int fromIndex, int toIndex);
     static void processFunctionMessage(DspObject *dspObject, int fromIndex, int toIndex);
+    static void processFunctionFolded(DspObject *dspObject, int fromIndex, int toIndex);
   
     /* IMPORTANT: one of these two functions MUST be overridden (or processFunction()) */
     virtual void processDspWithIndex(double fromIndex, double toIndex);
@@ -146,6 +205,59 @@ class DspObject : public MessageObject {
   
     /** Immediately deletes all messages in the message queue without executing them. */
     void clearMessageQueue();
+  
+    /**
+     * Returns the folded buffer at the single outlet of this object, or <code>NULL</code> if the
+     * object must be processed. Objects which may receive messages are never folded.
+     */
+    float *getFoldedOutletBuffer();
+  
+    /**
+     * Makes the object connected to the given inlet write its output directly into
+     * <code>buffer</code>, if it is the only connection of an ordinary processing object. Must be
+     * called after this object has been ordered. Returns the redirected object, or <code>NULL</code>.
+     * Its outlet index and previous outlet buffer are returned such that it can later be restored.
+     */
+    DspObject *redirectBufferAtInlet(unsigned int inletIndex, float *buffer, int *outletIndex,
+        float **previousBuffer);
+  
+    /**
+     * Returns an object redirected by <code>redirectBufferAtInlet()</code> its previous outlet
+     * buffer, and clears the given reference to it. The redirected buffer may be in use by other
+     * objects until the process order is recomputed, which is done before the context lock is
+     * released.
+     */
+    void restoreRedirectedObject(DspObject **redirectedObject, int outletIndex, float *previousBuffer);
+  
+    /**
+     * Stops processing this object, whose outlet buffer is known, while keeping its place. The buffer
+     * used once it is unfolded is allocated here.
+     */
+    void fold();
+  
+    /**
+     * Gives this folded object its own outlet buffer and passes it on to all readers. The object is
+     * processed again from the next block on, in its place in the existing process order.
+     */
+    void unfold();
+  
+    /** Sets the given buffer at the inlets of all registered readers of the given outlet. */
+    void setUnfoldedBufferAtReaders(unsigned int outletIndex, float *buffer);
+  
+    /**
+     * True if this object has been folded away. It keeps its place in the process order, but is not
+     * processed until it is unfolded.
+     */
+    bool isFolded;
+  
+    /** The process function of a folded object, restored when it is unfolded. */
+    void (*unfoldedProcessFunction)(DspObject *dspObject, int fromIndex, int toIndex);
+  
+    /** The outlet buffer of a folded object once it is unfolded, until the process order is recomputed. */
+    float *unfoldedBuffer;
+  
+    /** The objects reading each outlet buffer, as (outlet index, (reader, inlet index)). */
+    list<pair<unsigned int, ObjectLetPair> > bufferReaders;
     
     // both float and int versions of the blocksize are stored as different internal mechanisms
     // require different number formats
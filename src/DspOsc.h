@@ -30,9 +30,16 @@
 #ifndef _DSP_OSC_H_
 #define _DSP_OSC_H_
 
+#include <stdint.h>
 #include "DspObject.h"
 
-/** [osc~], [osc~ float] */
+/**
+ * [osc~], [osc~ float]
+ * The frequency may be given as a float or as a signal on the left inlet. A float on the right inlet
+ * resets the phase, in cycles. The phase is accumulated as a 32-bit fixed-point fraction of a cycle,
+ * which wraps around exactly and does not lose precision over time, and is converted to a cosine
+ * with <code>ArrayArithmetic::cosine()</code>, which shares its core with [cos~].
+ */
 class DspOsc : public DspObject {
   
   public:
@@ -47,19 +54,13 @@ class DspOsc : public DspObject {
   
   private:
     static void processScalar(DspObject *dspObject, int fromIndex, int toIndex);
+    static void processSignal(DspObject *dspObject, int fromIndex, int toIndex);
     void processMessage(int inletIndex, PdMessage *message);
   
-    float frequency; // frequency and phase are stored as integers because they are used
-    float sampleStep;
-    int phase;     // in for-loops to traverse the lookup table
-  
-    static float *cos_table; // the cosine lookup table
-    static int refCount; // a reference counter for cos_table. Now we know when to free it.
-  
-    #if __SSE3__
-    __m128i inc; // the amount by which to increment indicies every step
-    __m128i indicies; // the table lookup indicies
-    #endif
+    float frequency;
+    double phaseScale; // the phase increment per Hz, i.e. 2^32/sampleRate
+    uint32_t step; // the phase increment per sample at a constant frequency
+    uint32_t phase; // the current phase, as a fraction of a cycle scaled by 2^32
 };
 
 inline const char *DspOsc::getObjectLabel() {
@@ -61,3 +61,8 @@ void DspOutlet::setDspBufferAtInlet(float *buffer, unsigned int inletIndex) {
     dspObject->setDspBufferAtInlet(dspBufferAtInlet[0], letPair.second);
   }
 }
+
+void DspOutlet::setUnfoldedBufferAtInlet(float *buffer, unsigned int inletIndex) {
+  DspObject::setUnfoldedBufferAtInlet(buffer, inletIndex);
+  setUnfoldedBufferAtReaders(0, buffer); // the buffer is passed on unchanged
+}
@@ -61,6 +61,7 @@ class DspOutlet : public DspObject {
     float *getDspBufferAtOutlet(int outletIndex);
   
     void setDspBufferAtInlet(float *buffer, unsigned int inletIndex);
+    void setUnfoldedBufferAtInlet(float *buffer, unsigned int inletIndex);
     bool canSetBufferAtOutlet(unsigned int outletIndex);
 };
 
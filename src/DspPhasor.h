@@ -30,9 +30,14 @@
 #ifndef _DSP_PHASOR_H_
 #define _DSP_PHASOR_H_
 
+#include <stdint.h>
 #include "DspObject.h"
 
-/** [phasor~], [phasor~ float] */
+/**
+ * [phasor~], [phasor~ float]
+ * The frequency may be given as a float or as a signal on the left inlet. A float on the right inlet
+ * resets the phase. The phase is generated with <code>ArrayArithmetic::phasor()</code>, as in [osc~].
+ */
 class DspPhasor : public DspObject {
 
   public:
@@ -50,11 +55,9 @@ class DspPhasor : public DspObject {
     void processMessage(int inletIndex, PdMessage *message);
   
     float frequency;
-  
-    #if __SSE3__
-    __m64 inc; // the amount by which to increment indicies every step
-    __m64 indicies; // the table lookup indicies
-    #endif
+    double phaseScale; // the phase increment per Hz, i.e. 2^32/sampleRate
+    uint32_t step; // the phase increment per sample at a constant frequency
+    uint32_t phase; // the current phase, as a fraction of a cycle scaled by 2^32
 };
 
 inline const char *DspPhasor::getObjectLabel() {
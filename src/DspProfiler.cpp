@@ -0,0 +1,82 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#include <algorithm>
+#include "DspObject.h"
+#include "DspProfiler.h"
+
+DspProfiler::DspProfiler() {
+  enabled = false;
+  ring = NULL;
+  head = 0;
+  numSamples = 0;
+}
+
+DspProfiler::~DspProfiler() {
+  free(ring);
+}
+
+void DspProfiler::setEnabled(bool enabled) {
+  if (enabled && ring == NULL) {
+    ring = (ProfileSample *) malloc(RING_CAPACITY * sizeof(ProfileSample));
+  }
+  clear();
+  this->enabled = enabled;
+}
+
+void DspProfiler::clear() {
+  head = 0;
+  numSamples = 0;
+}
+
+static bool compareSamples(const std::pair<DspObject *, uint64_t> &a, const std::pair<DspObject *, uint64_t> &b) {
+  return (a.first == b.first) ? (a.second < b.second) : (a.first < b.first);
+}
+
+ZGProfileEntry *DspProfiler::getProfile(unsigned int *n) {
+  *n = 0;
+  if (numSamples == 0) return NULL;
+
+  // group the samples by object, sorted by elapsed time such that percentiles can be read directly
+  vector<std::pair<DspObject *, uint64_t> > samples;
+  samples.reserve(numSamples);
+  for (unsigned int i = 0; i < numSamples; ++i) {
+    samples.push_back(make_pair(ring[i].dspObject, ring[i].elapsedNs));
+  }
+  std::sort(samples.begin(), samples.end(), compareSamples);
+
+  unsigned int numObjects = 1;
+  for (unsigned int i = 1; i < samples.size(); ++i) {
+    if (samples[i].first != samples[i-1].first) ++numObjects;
+  }
+
+  ZGProfileEntry *profile = (ZGProfileEntry *) calloc(numObjects, sizeof(ZGProfileEntry));
+  unsigned int start = 0;
+  for (unsigned int k = 0; k < numObjects; ++k) {
+    unsigned int end = start;
+    uint64_t sum = 0;
+    while (end < samples.size() && samples[end].first == samples[start].first) {
+      sum += samples[end++].second;
+    }
+    unsigned int count = end - start;
+
+    ZGProfileEntry *entry = profile + k;
+    DspObject *dspObject = samples[start].first;
+    entry->object = dspObject;
+    snprintf(entry->label, sizeof(entry->label), "%s", dspObject->toString().c_str());
+    entry->numSamples = count;
+    entry->minMicros = samples[start].second / 1000.0;
+    entry->maxMicros = samples[end-1].second / 1000.0;
+    entry->meanMicros = (sum / 1000.0) / count;
+    entry->p99Micros = samples[start + (unsigned int) ceil(0.99 * count) - 1].second / 1000.0;
+
+    start = end;
+  }
+
+  *n = numObjects;
+  return profile;
+}
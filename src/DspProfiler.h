@@ -0,0 +1,92 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#ifndef _DSP_PROFILER_H_
+#define _DSP_PROFILER_H_
+
+#include <stdint.h>
+#if __APPLE__
+#include <mach/mach_time.h>
+#else
+#include <time.h>
+#endif
+#include "ZenGarden.h"
+
+class DspObject;
+
+/**
+ * The <code>DspProfiler</code> records the time spent in the process function of every
+ * <code>DspObject</code> of a context, including subgraphs, into a fixed-size ring. Recording
+ * can be switched on and off at runtime. When it is off, the only cost is one branch per graph
+ * per block. Statistics are aggregated per object only when requested.
+ */
+class DspProfiler {
+
+  public:
+    DspProfiler();
+    ~DspProfiler();
+
+    /** Turn recording on or off. All previously recorded samples are discarded. */
+    void setEnabled(bool enabled);
+
+    bool isEnabled() { return enabled; }
+
+    /** Returns the current time of a monotonic clock in nanoseconds. */
+    static inline uint64_t getTime() {
+      #if __APPLE__
+      static mach_timebase_info_data_t timebase = {0, 0};
+      if (timebase.denom == 0) mach_timebase_info(&timebase);
+      return (mach_absolute_time() * timebase.numer) / timebase.denom;
+      #else
+      timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return ((uint64_t) ts.tv_sec) * 1000000000ULL + (uint64_t) ts.tv_nsec;
+      #endif
+    }
+
+    /** Records a single call to the process function of the given object. */
+    inline void record(DspObject *dspObject, uint64_t elapsedNs) {
+      ring[head].dspObject = dspObject;
+      ring[head].elapsedNs = elapsedNs;
+      head = (head + 1) & (RING_CAPACITY - 1);
+      if (numSamples < RING_CAPACITY) ++numSamples;
+    }
+
+    /**
+     * Discards all recorded samples. This must be done whenever objects which may be referenced
+     * in the ring are deleted.
+     */
+    void clear();
+
+    /**
+     * Returns an array of statistics, one per recorded object, with length n. The array must be
+     * freed by the caller.
+     */
+    ZGProfileEntry *getProfile(unsigned int *n);
+
+  private:
+    /** The number of samples kept in the ring. Must be a power of two. */
+    static const unsigned int RING_CAPACITY = 65536;
+
+    typedef struct ProfileSample {
+      DspObject *dspObject;
+      uint64_t elapsedNs;
+    } ProfileSample;
+
+    bool enabled;
+
+    /** The ring of samples. It is only allocated once profiling is first enabled. */
+    ProfileSample *ring;
+
+    /** The index at which the next sample will be written. */
+    unsigned int head;
+
+    /** The number of valid samples in the ring. */
+    unsigned int numSamples;
+};
+
+#endif // _DSP_PROFILER_H_
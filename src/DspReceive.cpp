@@ -38,21 +38,23 @@ MessageObject *DspReceive::newObject(PdMessage *initMessage, PdGraph *graph) {
 DspReceive::DspReceive(PdMessage *initMessage, PdGraph *graph) : DspObject(1, 0, 0, 1, graph) {
   if (initMessage->isSymbol(0)) {
     name = StaticUtils::copyString(initMessage->getSymbol(0));
-    dspBufferAtOutlet[0] = ALLOC_ALIGNED_BUFFER(graph->getBlockSize() * sizeof(float));
   } else {
     name = NULL;
     graph->printErr("receive~ not initialised with a name.");
   }
-  processFunction = &processSignal;
   
-  // this pointer contains the send buffer
-  // default to zero buffer
-  dspBufferAtInlet[0] = graph->getBufferPool()->getZeroBuffer();
+  // the outlet refers to the buffer of the associated send~ once it is registered.
+  // Default to the zero buffer
+  dspBufferAtOutlet[0] = graph->getBufferPool()->getZeroBuffer();
 }
 
 DspReceive::~DspReceive() {
   free(name);
-  FREE_ALIGNED_BUFFER(dspBufferAtOutlet[0]);
+}
+
+void DspReceive::receiveMessage(int inletIndex, PdMessage *message) {
+  // this object is never processed, so messages are not queued
+  processMessage(inletIndex, message);
 }
 
 void DspReceive::processMessage(int inletIndex, PdMessage *message) {
@@ -60,8 +62,3 @@ void DspReceive::processMessage(int inletIndex, PdMessage *message) {
     graph->printErr("[receive~ %s]: message \"set %s\" is not supported.", name, message->getSymbol(1));
   }
 }
-
-void DspReceive::processSignal(DspObject *dspObject, int fromIndex, int toIndex) {
-  DspReceive *d = reinterpret_cast<DspReceive *>(dspObject);
-  memcpy(d->dspBufferAtOutlet[0], d->dspBufferAtInlet[0], toIndex*sizeof(float));
-}
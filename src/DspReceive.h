@@ -32,7 +32,12 @@
 
 #include "DspObject.h"
 
-/** [receive~ symbol], [r~ symbol] */
+/**
+ * [receive~ symbol], [r~ symbol]
+ *
+ * The outlet buffer is that of the associated send~, or the zero buffer if there is none. The
+ * object itself does no processing.
+ */
 class DspReceive : public DspObject {
   
   public:
@@ -46,13 +51,13 @@ class DspReceive : public DspObject {
   
     ObjectType getObjectType();
   
+    void receiveMessage(int inletIndex, PdMessage *message);
     void processMessage(int inletIndex, PdMessage *message);
   
     bool canSetBufferAtOutlet(unsigned int outletIndex);
+    bool doesProcessAudio() { return false; }
   
   private:
-    static void processSignal(DspObject *dspObject, int fromIndex, int toIndex);
-  
     char *name;
 };
 
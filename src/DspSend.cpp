@@ -27,6 +27,7 @@
  *
  */
 
+#include "BufferPool.h"
 #include "DspSend.h"
 #include "PdGraph.h"
 
@@ -38,30 +39,65 @@ DspSend::DspSend(PdMessage *initMessage, PdGraph *graph) : DspObject(0, 1, 0, 0,
   if (initMessage->isSymbol(0)) {
     name = StaticUtils::copyString(initMessage->getSymbol(0));
     dspBufferAtOutlet[0] = ALLOC_ALIGNED_BUFFER(graph->getBlockSize()*sizeof(float));
+    memset(dspBufferAtOutlet[0], 0, graph->getBlockSize()*sizeof(float));
   } else {
     name = NULL;
     graph->printErr("send~ not initialised with a name.");
   }
+  upstream = NULL;
+  upstreamOutletIndex = 0;
+  upstreamBuffer = NULL;
   processFunction = &processSignal;
 }
 
 DspSend::~DspSend() {
+  // the upstream object is not restored here, as it may already have been deleted
+  // along with the graph. Removing the object removes its connections first.
   free(name);
   FREE_ALIGNED_BUFFER(dspBufferAtOutlet[0]);
 }
 
-/*
- * It would be very nice to not have to use memcpys with send~ and receive~, but unfortunately
- * things become very complicated very quickly. If s~ is already in an attached graph, then
- * everything works out fine. If s~ does not yet exist, then it is also easy for r~ to use the
- * zero buffer as its output. Ideally, we'd like to remove s~ and r~ entirely from the dsp graph
- * and all objects receiving from r~ to simply refer to the buffer at s~. But for that we'd need
- * to make sure that the s~ buffer is accordingly retained and not reused before all r~ receivers
- * have had a chance to use it.
- */
+list<DspObject *> DspSend::getProcessOrder() {
+  if (isOrdered) return list<DspObject *>();
+  
+  // the upstream object receives a new outlet buffer when it is ordered again
+  upstream = NULL;
+  list<DspObject *> processList = DspObject::getProcessOrder();
+  if (dspBufferAtOutlet[0] == NULL) return processList;
+  
+  processFunction = &processSignal;
+  float constant = 0.0f;
+  if (graph->getBufferPool()->isConstantBuffer(dspBufferAtInlet[0], &constant)) {
+    // the input does not change for as long as this process order
+    ArrayArithmetic::fill(dspBufferAtOutlet[0], constant, 0, blockSizeInt);
+    processFunction = &processNone;
+  } else {
+    // if this send~ is the only receiver of the connected object, it writes into the send~ buffer
+    upstream = redirectBufferAtInlet(0, dspBufferAtOutlet[0], &upstreamOutletIndex, &upstreamBuffer);
+    if (upstream != NULL) processFunction = &processNone;
+  }
+  return processList;
+}
+
+void DspSend::setUnfoldedBufferAtInlet(float *buffer, unsigned int inletIndex) {
+  DspObject::setUnfoldedBufferAtInlet(buffer, inletIndex);
+  // the input is no longer constant
+  if (upstream == NULL && dspBufferAtOutlet[0] != NULL) processFunction = &processSignal;
+}
+
+void DspSend::removeConnectionFromObjectToInlet(MessageObject *messageObject, int outletIndex, int inletIndex) {
+  if (messageObject == upstream) {
+    restoreRedirectedObject(&upstream, upstreamOutletIndex, upstreamBuffer);
+  }
+  DspObject::removeConnectionFromObjectToInlet(messageObject, outletIndex, inletIndex);
+}
+
 void DspSend::processSignal(DspObject *dspObject, int fromIndex, int toIndex) {
-  // make a defensive copy of the input in case the buffer is reused before all receives
-  // have had the chance to refer to it
+  // the input is copied such that the published buffer outlives the (reused) inlet buffer
   DspSend *d = reinterpret_cast<DspSend *>(dspObject);
   memcpy(d->dspBufferAtOutlet[0], d->dspBufferAtInlet[0], toIndex*sizeof(float));
 }
+
+void DspSend::processNone(DspObject *dspObject, int fromIndex, int toIndex) {
+  // nothing to do, the buffer is written by the connected object or is constant
+}
@@ -32,7 +32,13 @@
 
 #include "DspObject.h"
 
-/** [send~ symbol], [s~ symbol] */
+/**
+ * [send~ symbol], [s~ symbol]
+ *
+ * The signal is published in a buffer owned by the send~, from which all associated receive~s read
+ * directly. Where possible the object connected to the send~ writes its output directly into that
+ * buffer, such that no copy is made at all.
+ */
 class DspSend : public DspObject {
   
   public:
@@ -45,11 +51,28 @@ class DspSend : public DspObject {
     std::string toString();
   
     ObjectType getObjectType();
+  
+    bool isSilentWithInput(const bool *isInletSilent) const { return isInletSilent[0]; }
+    bool hasSideEffects() { return true; }
+  
+    list<DspObject *> getProcessOrder();
+    void setUnfoldedBufferAtInlet(float *buffer, unsigned int inletIndex);
+  
+    void removeConnectionFromObjectToInlet(MessageObject *messageObject, int outletIndex, int inletIndex);
     
   private:
     static void processSignal(DspObject *dspObject, int fromIndex, int toIndex);
+    static void processNone(DspObject *dspObject, int fromIndex, int toIndex);
   
     char *name;
+  
+    /**
+     * The object which writes directly into the buffer of this send~, or <code>NULL</code>. Its
+     * original outlet buffer is kept, such that it can be returned if the connection is removed.
+     */
+    DspObject *upstream;
+    int upstreamOutletIndex;
+    float *upstreamBuffer;
 };
 
 inline std::string DspSend::toString() {
@@ -43,6 +43,9 @@ class DspSignal : public DspObject {
     static const char *getObjectLabel();
     std::string toString();
   
+    bool isSilentWithInput(const bool *isInletSilent) const { return constant == 0.0f; }
+    bool isStateless() { return true; }
+  
   private:
     static void processScalar(DspObject *dspObject, int fromIndex, int toIndex);
     void processMessage(int inletIndex, PdMessage *message);
@@ -45,6 +45,17 @@ DspSubtract::~DspSubtract() {
   // nothing to do
 }
 
+bool DspSubtract::isSilentWithInput(const bool *isInletSilent) const {
+  bool isSignal = !incomingDspConnections[0].empty() && !incomingDspConnections[1].empty();
+  return isInletSilent[0] && (isSignal ? isInletSilent[1] : (constant == 0.0f));
+}
+
+float *DspSubtract::getFoldedBuffer() {
+  // [-~ 0]
+  bool isScalar = (incomingDspConnections[0].empty() || incomingDspConnections[1].empty());
+  return (isScalar && constant == 0.0f) ? dspBufferAtInlet[0] : NULL;
+}
+
 string DspSubtract::toString() {
   const char *fmt = (constant == 0.0f) ? "%s" : "%s %g";
   char str[snprintf(NULL, 0, fmt, getObjectLabel(), constant)+1];
@@ -43,6 +43,10 @@ class DspSubtract : public DspObject {
     std::string toString();
   
     void onInletConnectionUpdate(unsigned int inletIndex);
+  
+    bool isSilentWithInput(const bool *isInletSilent) const;
+    float *getFoldedBuffer();
+    bool isStateless() { return true; }
 
   private:
     static void processSignal(DspObject *dspObject, int fromIndex, int toIndex);
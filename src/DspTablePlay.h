@@ -47,6 +47,8 @@ class DspTablePlay : public DspObject, public TableReceiverInterface {
   
     ConnectionType getConnectionType(int outletIndex);
   
+    bool hasSideEffects() { return true; }
+  
     void sendMessage(int outletIndex, PdMessage *message);
   
     char *getName();
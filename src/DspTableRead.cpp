@@ -54,8 +54,10 @@ void DspTableRead::processMessage(int inletIndex, PdMessage *message) {
     case 0: {
       if (message->isSymbol(0, "set") && message->isSymbol(1)) {
         // change the table from which this object reads
-        free(name);
+        char *oldName = name;
         name = StaticUtils::copyString(message->getSymbol(1));
+        graph->renameTableReceiver(this, oldName);
+        free(oldName);
         table = graph->getTable(name);
       }
       break;
@@ -27,6 +27,8 @@
  *
  */
 
+#include "ArrayArithmetic.h"
+#include "BufferPool.h"
 #include "DspThrow.h"
 #include "PdContext.h"
 #include "PdGraph.h"
@@ -39,11 +41,15 @@ DspThrow::DspThrow(PdMessage *initMessage, PdGraph *graph) : DspObject(0, 1, 0,
   if (initMessage->isSymbol(0)) {
     name = StaticUtils::copyString(initMessage->getSymbol(0));
     buffer = ALLOC_ALIGNED_BUFFER(graph->getBlockSize() * sizeof(float));
+    memset(buffer, 0, graph->getBlockSize() * sizeof(float));
   } else {
     name = NULL;
     buffer = NULL;
     graph->printErr("throw~ may not be initialised without a name. \"set\" message not supported.");
   }
+  upstream = NULL;
+  upstreamOutletIndex = 0;
+  upstreamBuffer = NULL;
   processFunction = &processSignal;
 }
 
@@ -58,11 +64,48 @@ void DspThrow::processMessage(int inletIndex, PdMessage *message) {
   }
 }
 
+list<DspObject *> DspThrow::getProcessOrder() {
+  if (isOrdered) return list<DspObject *>();
+  
+  upstream = NULL;
+  list<DspObject *> processList = DspObject::getProcessOrder();
+  if (buffer == NULL) return processList;
+  
+  processFunction = &processSignal;
+  float constant = 0.0f;
+  if (graph->getBufferPool()->isConstantBuffer(dspBufferAtInlet[0], &constant)) {
+    ArrayArithmetic::fill(buffer, constant, 0, blockSizeInt);
+    processFunction = &processNone;
+  } else {
+    // if this throw~ is the only receiver of the connected object, it writes into the throw~ buffer
+    upstream = redirectBufferAtInlet(0, buffer, &upstreamOutletIndex, &upstreamBuffer);
+    if (upstream != NULL) processFunction = &processNone;
+  }
+  return processList;
+}
+
+void DspThrow::setUnfoldedBufferAtInlet(float *buffer, unsigned int inletIndex) {
+  DspObject::setUnfoldedBufferAtInlet(buffer, inletIndex);
+  // the input is no longer constant
+  if (upstream == NULL && this->buffer != NULL) processFunction = &processSignal;
+}
+
+void DspThrow::removeConnectionFromObjectToInlet(MessageObject *messageObject, int outletIndex, int inletIndex) {
+  if (messageObject == upstream) {
+    restoreRedirectedObject(&upstream, upstreamOutletIndex, upstreamBuffer);
+  }
+  DspObject::removeConnectionFromObjectToInlet(messageObject, outletIndex, inletIndex);
+}
+
 void DspThrow::processSignal(DspObject *dspObject, int fromIndex, int toIndex) {
   DspThrow *d = reinterpret_cast<DspThrow *>(dspObject);
   memcpy(d->buffer, d->dspBufferAtInlet[0], toIndex*sizeof(float));
 }
 
+void DspThrow::processNone(DspObject *dspObject, int fromIndex, int toIndex) {
+  // nothing to do, the buffer is written by the connected object or is constant
+}
+
 bool DspThrow::isLeafNode() {
   return graph->getContext()->getDspCatch(name) == NULL;
 }
@@ -36,7 +36,8 @@ class DspCatch;
 
 /**
  * [throw~ symbol]
- * Implements the sending end of a many-to-one audio connection.
+ * Implements the sending end of a many-to-one audio connection. The signal is held in a buffer
+ * owned by the throw~, into which the connected object writes directly where possible.
  */
 class DspThrow : public DspObject {
   
@@ -55,12 +56,26 @@ class DspThrow : public DspObject {
     void processMessage(int inletIndex, PdMessage *message);
   
     bool isLeafNode();
+  
+    bool isSilentWithInput(const bool *isInletSilent) const { return isInletSilent[0]; }
+    bool hasSideEffects() { return true; }
+  
+    list<DspObject *> getProcessOrder();
+    void setUnfoldedBufferAtInlet(float *buffer, unsigned int inletIndex);
+  
+    void removeConnectionFromObjectToInlet(MessageObject *messageObject, int outletIndex, int inletIndex);
     
   private:
     static void processSignal(DspObject *dspObject, int fromIndex, int toIndex);
+    static void processNone(DspObject *dspObject, int fromIndex, int toIndex);
   
     char *name;
     float *buffer;
+  
+    /** The object writing directly into the buffer of this throw~, or <code>NULL</code>. */
+    DspObject *upstream;
+    int upstreamOutletIndex;
+    float *upstreamBuffer;
 };
 
 #endif // _DSP_THROW_H_
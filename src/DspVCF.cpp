@@ -27,73 +27,175 @@
  *
  */
 
-#include "ArrayArithmetic.h"
 #include "DspVCF.h"
 #include "PdGraph.h"
 
+// above this angular frequency the pole is always at zero, for any q that can be reasonably given
+#define MAX_ANGULAR_FREQUENCY 1000000.0f
+
+// pi as a float, such that the per-sample arithmetic is not promoted to double
+#define PI_F ((float) M_PI)
+
 MessageObject *DspVCF::newObject(PdMessage *initMessage, PdGraph *graph) {
   return new DspVCF(initMessage, graph);
 }
 
-DspVCF::DspVCF(PdMessage *initMessage, PdGraph *graph) : DspObject(3, 3, 0, 2, graph) {
-  sampleRate = graph->getSampleRate();
-  calculateFilterCoefficients(this->sampleRate/2.0f, 1.0f); // initialise the filter completely open
-  tap_0 = tap_1 = 0.0f;
+DspVCF::DspVCF(PdMessage *initMessage, PdGraph *graph) : DspObject(3, 2, 0, 2, graph) {
+  q = initMessage->isFloat(0) ? initMessage->getFloat(0) : 0.0f;
+  if (q < 0.0f) q = 0.0f;
+  re = im = 0.0f;
+  coefRe = ALLOC_ALIGNED_BUFFER(blockSizeInt * sizeof(float));
+  coefIm = ALLOC_ALIGNED_BUFFER(blockSizeInt * sizeof(float));
+  gain = ALLOC_ALIGNED_BUFFER(blockSizeInt * sizeof(float));
+  
+  processFunction = &processSignal;
+  processFunctionNoMessage = &processSignal;
 }
 
 DspVCF::~DspVCF() {
-  // nothing to do
+  FREE_ALIGNED_BUFFER(coefRe);
+  FREE_ALIGNED_BUFFER(coefIm);
+  FREE_ALIGNED_BUFFER(gain);
 }
 
 const char *DspVCF::getObjectLabel() {
   return "vcf~";
 }
 
-void DspVCF::calculateFilterCoefficients(float f, float q) {
-  float r, oneminusr, omega;
-  if (f < 0.001f) f = 10.0f;
-  if (q < 0.0f) q = 0.0f;
-  this->centerFrequency = f;
-  this->q = q;
-  omega = f * (2.0f * M_PI) / sampleRate;
-  if (q < 0.001) oneminusr = 1.0f;
-  else oneminusr = omega/q;
-  if (oneminusr > 1.0f) oneminusr = 1.0f;
-  r = 1.0f - oneminusr;
-  coef1 = 2.0f * sigbp_qcos(omega) * r;
-  coef2 = - r * r;
-  gain = 2 * oneminusr * (oneminusr + r * omega);
+bool DspVCF::isSilentWithInput(const bool *isInletSilent) const {
+  return isInletSilent[0] && fabsf(re) < 1e-9f && fabsf(im) < 1e-9f;
+}
+
+void DspVCF::onSleep() {
+  re = im = 0.0f;
+}
+
+// sin(x) for x in [-pi, pi]. The argument is folded into [-pi/2, pi/2], where a Taylor polynomial of
+// degree nine is accurate to within 4e-6.
+static inline float sinPi(float x) {
+  x = (x < PI_F - x) ? x : PI_F - x;
+  x = (x > -PI_F - x) ? x : -PI_F - x;
+  float x2 = x * x;
+  return x * (1.0f + x2 * (-1.0f/6.0f + x2 * (1.0f/120.0f + x2 * (-1.0f/5040.0f + x2 * (1.0f/362880.0f)))));
+}
+
+// adding and subtracting 1.5*2^23 rounds a float of smaller magnitude to the nearest integer
+#define ROUNDING_CONSTANT 12582912.0f
+
+// computes the coefficients of one sample, given the center frequency in radians per sample
+static inline void calculateCoefficients(float cf, float qinv, float ampcorrect,
+    float *coefRe, float *coefIm, float *gain) {
+  cf = (cf < 0.0f) ? 0.0f : cf;
+  cf = (cf > MAX_ANGULAR_FREQUENCY) ? MAX_ANGULAR_FREQUENCY : cf;
+  float r = (qinv > 0.0f) ? 1.0f - cf * qinv : 0.0f;
+  r = (r < 0.0f) ? 0.0f : r;
+  *gain = ampcorrect * (1.0f - r);
+  
+  // wrap the angle into [-pi, pi]. cos(w) = sin(w + pi/2).
+  float w = cf - 2.0f * PI_F * (((cf * (0.5f / PI_F)) + ROUNDING_CONSTANT) - ROUNDING_CONSTANT);
+  float v = w + 0.5f * PI_F;
+  v = (v > PI_F) ? v - 2.0f * PI_F : v;
+  *coefIm = r * sinPi(w);
+  *coefRe = r * sinPi(v);
 }
 
-float DspVCF::sigbp_qcos(float f) {
-  if (f >= -(0.5f * M_PI) && f <= (0.5f * M_PI)) {
-    float g = f*f;
-    return (((g*g*g * (-1.0f/720.0f) + g*g*(1.0f/24.0f)) - g*0.5) + 1);
-  } else {
-    return 0.0f;
+void DspVCF::calculateFilterCoefficients(float *centerFrequency, int fromIndex, int toIndex) {
+  const float isr = 2.0f * PI_F / graph->getSampleRate();
+  const float qinv = (q > 0.0f) ? 1.0f/q : 0.0f;
+  const float ampcorrect = 2.0f - 2.0f / (q + 2.0f);
+  int i = fromIndex;
+  
+  #if __SSE__
+  // align to a 16-byte boundary
+  for (; (i & 0x3) && i < toIndex; ++i) {
+    calculateCoefficients(centerFrequency[i] * isr, qinv, ampcorrect, coefRe+i, coefIm+i, gain+i);
+  }
+  const __m128 vIsr = _mm_set1_ps(isr);
+  const __m128 vQinv = _mm_set1_ps(qinv);
+  const __m128 vAmpcorrect = _mm_set1_ps(ampcorrect);
+  const __m128 vZero = _mm_setzero_ps();
+  const __m128 vOne = _mm_set1_ps(1.0f);
+  const __m128 vMax = _mm_set1_ps(MAX_ANGULAR_FREQUENCY);
+  const __m128 vRounding = _mm_set1_ps(ROUNDING_CONSTANT);
+  const __m128 vPi = _mm_set1_ps(PI_F);
+  const __m128 vNegPi = _mm_set1_ps(-PI_F);
+  const __m128 vHalfPi = _mm_set1_ps(0.5f * PI_F);
+  const __m128 vTwoPi = _mm_set1_ps(2.0f * PI_F);
+  const __m128 vInvTwoPi = _mm_set1_ps(0.5f / PI_F);
+  const __m128 c3 = _mm_set1_ps(-1.0f/6.0f);
+  const __m128 c5 = _mm_set1_ps(1.0f/120.0f);
+  const __m128 c7 = _mm_set1_ps(-1.0f/5040.0f);
+  const __m128 c9 = _mm_set1_ps(1.0f/362880.0f);
+  for (; i + 4 <= toIndex; i += 4) {
+    // the angular frequency and the pole radius
+    __m128 cf = _mm_mul_ps(_mm_loadu_ps(centerFrequency+i), vIsr);
+    cf = _mm_min_ps(_mm_max_ps(cf, vZero), vMax);
+    __m128 r = _mm_max_ps(_mm_sub_ps(vOne, _mm_mul_ps(cf, vQinv)), vZero);
+    r = _mm_and_ps(r, _mm_cmpgt_ps(vQinv, vZero));
+    _mm_store_ps(gain+i, _mm_mul_ps(vAmpcorrect, _mm_sub_ps(vOne, r)));
+    
+    // wrap the angle into [-pi, pi]
+    __m128 k = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(cf, vInvTwoPi), vRounding), vRounding);
+    __m128 w = _mm_sub_ps(cf, _mm_mul_ps(k, vTwoPi));
+    
+    // cos(w) = sin(w + pi/2), wrapped into [-pi, pi]
+    __m128 angles[2];
+    angles[0] = w;
+    angles[1] = _mm_add_ps(w, vHalfPi);
+    angles[1] = _mm_sub_ps(angles[1], _mm_and_ps(_mm_cmpgt_ps(angles[1], vPi), vTwoPi));
+    __m128 sines[2];
+    for (int j = 0; j < 2; ++j) {
+      __m128 x = angles[j];
+      x = _mm_min_ps(x, _mm_sub_ps(vPi, x));
+      x = _mm_max_ps(x, _mm_sub_ps(vNegPi, x));
+      __m128 x2 = _mm_mul_ps(x, x);
+      __m128 p = _mm_add_ps(c7, _mm_mul_ps(x2, c9));
+      p = _mm_add_ps(c5, _mm_mul_ps(x2, p));
+      p = _mm_add_ps(c3, _mm_mul_ps(x2, p));
+      p = _mm_add_ps(vOne, _mm_mul_ps(x2, p));
+      sines[j] = _mm_mul_ps(x, p);
+    }
+    _mm_store_ps(coefIm+i, _mm_mul_ps(r, sines[0]));
+    _mm_store_ps(coefRe+i, _mm_mul_ps(r, sines[1]));
+  }
+  #endif
+  
+  for (; i < toIndex; ++i) {
+    calculateCoefficients(centerFrequency[i] * isr, qinv, ampcorrect, coefRe+i, coefIm+i, gain+i);
   }
 }
 
 void DspVCF::processMessage(int inletIndex, PdMessage *message) {
-  // not sure what the other inlets do wrt messages
   if (inletIndex == 2) {
     if (message->isFloat(0)) {
       q = message->getFloat(0); // update the resonance (q)
+      if (q < 0.0f) q = 0.0f;
     }
   }
 }
 
-void DspVCF::processDspWithIndex(int fromIndex, int toIndex) {
-  /*
-  for (int i = fromIndex; i < toIndex; i++) {
-    calculateFilterCoefficients(dspBufferAtInlet1[i], q);
-    dspBufferAtOutlet0[i] = dspBufferAtInlet0[i] + (coef1 * tap_0) + (coef2 * tap_1);
-    tap_1 = tap_0;
-    tap_0 = dspBufferAtOutlet0[i];
+void DspVCF::processSignal(DspObject *dspObject, int fromIndex, int toIndex) {
+  DspVCF *d = reinterpret_cast<DspVCF *>(dspObject);
+  d->calculateFilterCoefficients(d->dspBufferAtInlet[1], fromIndex, toIndex);
+  
+  // the input is read before the output at the same index is written, such that buffers may be shared
+  float *input = d->dspBufferAtInlet[0];
+  float *outputBandpass = d->dspBufferAtOutlet[0];
+  float *outputLowpass = d->dspBufferAtOutlet[1];
+  float re = d->re;
+  float im = d->im;
+  for (int i = fromIndex; i < toIndex; ++i) {
+    float x = input[i];
+    float re2 = re;
+    re = d->gain[i] * x + d->coefRe[i] * re2 - d->coefIm[i] * im;
+    im = d->coefIm[i] * re2 + d->coefRe[i] * im;
+    outputBandpass[i] = re;
+    outputLowpass[i] = im;
   }
-  // dspBufferAtOutlet0[i] *= gain;
-  ArrayArithmetic::multiply(dspBufferAtOutlet0, gain, dspBufferAtOutlet0, fromIndex, toIndex);
-  */
-  // NOTE(mhroth): This object is definitely not working properly. It outputs only zero.
-  ArrayArithmetic::fill(dspBufferAtOutlet[0], 0, fromIndex, toIndex);
+  
+  // flush denormal and diverged state
+  if (!(fabsf(re) > 1e-20f && fabsf(re) < 1e20f)) re = 0.0f;
+  if (!(fabsf(im) > 1e-20f && fabsf(im) < 1e20f)) im = 0.0f;
+  d->re = re;
+  d->im = im;
 }
@@ -32,7 +32,13 @@
 
 #include "DspObject.h"
 
-/** [vcf~], a voltage controlled bandpass filter */
+/**
+ * [vcf~], a voltage controlled bandpass filter
+ * The left outlet is the band-pass output and the right outlet the low-pass output. The center
+ * frequency is given per sample by the signal at the middle inlet, and the q by messages at the right
+ * inlet. The coefficients are computed for the whole block first, four samples at a time where SIMD
+ * is available, after which the complex one-pole recursion is run per sample.
+ */
 class DspVCF : public DspObject {
   
   public:
@@ -42,22 +48,31 @@ class DspVCF : public DspObject {
   
     static const char *getObjectLabel();
     std::string toString();
+  
+    /** The filter is silent with silent input once its state has decayed. */
+    bool isSilentWithInput(const bool *isInletSilent) const;
+    void onSleep();
     
   private:
+    static void processSignal(DspObject *dspObject, int fromIndex, int toIndex);
     void processMessage(int inletIndex, PdMessage *message);
-    void processDspWithIndex(int fromIndex, int toIndex);
   
-    void calculateFilterCoefficients(float f, float q);
-    float sigbp_qcos(float f); // not entirely sure what this is doing. From Pd.
+    /**
+     * Computes the real and imaginary parts of the pole, and the gain, for each sample in the given
+     * range of the center frequency buffer.
+     */
+    void calculateFilterCoefficients(float *centerFrequency, int fromIndex, int toIndex);
     
-    float sampleRate;
-    float centerFrequency;
     float q;
-    float coef1;
-    float coef2;
-    float gain;
-    float tap_0;
-    float tap_1;
+  
+    /** The state of the filter, a complex number. */
+    float re;
+    float im;
+  
+    /** Per-sample coefficients, each of block size. */
+    float *coefRe;
+    float *coefIm;
+    float *gain;
 };
 
 inline std::string DspVCF::toString() {
@@ -149,29 +149,22 @@ void DspVariableLine::processSignal(DspObject *dspObject, int fromIndex, int toI
     int n = toIndex - fromIndex;
     if (n < (int) d->numSamplesToTarget) {
       // can update entire buffer
-      #if __APPLE__
-      vDSP_vramp(&(d->lastOutputSample), &(d->slope), d->dspBufferAtOutlet[0]+fromIndex, 1, n);
-      #else
-            
-      #endif
-      
-      d->lastOutputSample = d->dspBufferAtOutlet[0][toIndex-1] + d->slope;
+      ArrayArithmetic::ramp(d->dspBufferAtOutlet[0], d->lastOutputSample, d->slope, fromIndex, toIndex);
+      d->lastOutputSample += n * d->slope;
       d->numSamplesToTarget -= n;
     } else {
-      // must update slope in this buffer
-      #if __APPLE__
-      vDSP_vramp(&(d->lastOutputSample), &(d->slope), d->dspBufferAtOutlet[0]+fromIndex, 1, (int) d->numSamplesToTarget);
-      #else
-            
-      #endif
+      // must update slope in this buffer. The ramp ends within (or at the end of) this segment.
+      int targetIndex = fromIndex + (int) ceilf(d->numSamplesToTarget);
+      if (targetIndex > toIndex) targetIndex = toIndex;
+      ArrayArithmetic::ramp(d->dspBufferAtOutlet[0], d->lastOutputSample, d->slope, fromIndex, targetIndex);
+
       // update the path
       d->slope = 0.0f;
       d->lastOutputSample = d->target;
-      fromIndex += (int) ceilf(d->numSamplesToTarget);
       d->numSamplesToTarget = 0.0f;
       
       // process the remainder of the buffer
-     ArrayArithmetic::fill(d->dspBufferAtOutlet[0], d->lastOutputSample, fromIndex, toIndex);
+      ArrayArithmetic::fill(d->dspBufferAtOutlet[0], d->lastOutputSample, targetIndex, toIndex);
     }
   }
 }
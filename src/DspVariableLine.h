@@ -48,6 +48,11 @@ class DspVariableLine : public DspObject {
   
     // override sendMessage in order to update path
     void sendMessage(int outletIndex, PdMessage *message);
+  
+    /** [vline~] is silent once it has come to rest at zero with no segments pending. */
+    bool isSilentWithInput(const bool *isInletSilent) const {
+      return numSamplesToTarget <= 0.0f && lastOutputSample == 0.0f && messageList.empty();
+    }
     
   private:
     static void processSignal(DspObject *dspObject, int fromIndex, int toIndex);
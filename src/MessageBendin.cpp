@@ -0,0 +1,35 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#include "MessageBendin.h"
+
+MessageObject *MessageBendin::newObject(PdMessage *initMessage, PdGraph *graph) {
+  return new MessageBendin(initMessage, graph);
+}
+
+MessageBendin::MessageBendin(PdMessage *initMessage, PdGraph *graph) :
+    RemoteMessageReceiver(0, initMessage->isFloat(0) ? 1 : 2, graph) {
+  channel = initMessage->isFloat(0) ? ((int) initMessage->getFloat(0)) - 1 : -1;
+  name = StaticUtils::copyString((char *) "zg_bendin");
+}
+
+MessageBendin::~MessageBendin() {
+  free(name);
+}
+
+void MessageBendin::processMessage(int inletIndex, PdMessage *message) {
+  // the message is [bend, channel]
+  if (channel >= 0 && channel != (int) message->getFloat(1)) return;
+  
+  PdMessage *outgoingMessage = PD_MESSAGE_ON_STACK(1);
+  if (channel < 0) {
+    outgoingMessage->initWithTimestampAndFloat(message->getTimestamp(), message->getFloat(1));
+    sendMessage(1, outgoingMessage);
+  }
+  outgoingMessage->initWithTimestampAndFloat(message->getTimestamp(), message->getFloat(0));
+  sendMessage(0, outgoingMessage);
+}
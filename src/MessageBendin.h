@@ -0,0 +1,35 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#ifndef _MESSAGE_BENDIN_H_
+#define _MESSAGE_BENDIN_H_
+
+#include "RemoteMessageReceiver.h"
+
+/**
+ * [bendin], [bendin float]
+ * Outputs midi pitch bends in [0, 16383]. Without arguments, the bend and channel are output. If a
+ * (1-indexed) channel is given, only the bend on that channel is output.
+ */
+class MessageBendin : public RemoteMessageReceiver {
+  
+  public:
+    static MessageObject *newObject(PdMessage *initMessage, PdGraph *graph);
+    MessageBendin(PdMessage *initMessage, PdGraph *graph);
+    ~MessageBendin();
+    
+    static const char *getObjectLabel() { return "bendin"; }
+    std::string toString() { return MessageBendin::getObjectLabel(); }
+    ObjectType getObjectType() { return MESSAGE_BENDIN; }
+    
+  private:
+    void processMessage(int inletIndex, PdMessage *message);
+
+    int channel; // zero-indexed, -1 if omni
+};
+
+#endif // _MESSAGE_BENDIN_H_
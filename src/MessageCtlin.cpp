@@ -0,0 +1,50 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#include "MessageCtlin.h"
+
+MessageObject *MessageCtlin::newObject(PdMessage *initMessage, PdGraph *graph) {
+  return new MessageCtlin(initMessage, graph);
+}
+
+MessageCtlin::MessageCtlin(PdMessage *initMessage, PdGraph *graph) : RemoteMessageReceiver(0,
+    initMessage->isFloat(0) ? (initMessage->isFloat(1) ? 1 : 2) : 3, graph) {
+  controller = initMessage->isFloat(0) ? (int) initMessage->getFloat(0) : -1;
+  channel = (initMessage->isFloat(0) && initMessage->isFloat(1)) ? ((int) initMessage->getFloat(1)) - 1 : -1;
+  
+  // all control changes are sent to the same receiver name, and are filtered by each object
+  name = StaticUtils::copyString((char *) "zg_ctlin");
+}
+
+MessageCtlin::~MessageCtlin() {
+  free(name);
+}
+
+void MessageCtlin::processMessage(int inletIndex, PdMessage *message) {
+  // the message is [value, controller, channel]
+  if (controller >= 0 && controller != (int) message->getFloat(1)) return;
+  if (channel >= 0 && channel != (int) message->getFloat(2)) return;
+  
+  PdMessage *outgoingMessage = PD_MESSAGE_ON_STACK(1);
+  switch (getNumOutlets()) {
+    case 3: {
+      outgoingMessage->initWithTimestampAndFloat(message->getTimestamp(), message->getFloat(2));
+      sendMessage(2, outgoingMessage);
+      outgoingMessage->initWithTimestampAndFloat(message->getTimestamp(), message->getFloat(1));
+      sendMessage(1, outgoingMessage);
+      break;
+    }
+    case 2: {
+      outgoingMessage->initWithTimestampAndFloat(message->getTimestamp(), message->getFloat(2));
+      sendMessage(1, outgoingMessage);
+      break;
+    }
+    default: break;
+  }
+  outgoingMessage->initWithTimestampAndFloat(message->getTimestamp(), message->getFloat(0));
+  sendMessage(0, outgoingMessage);
+}
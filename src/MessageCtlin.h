@@ -0,0 +1,37 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#ifndef _MESSAGE_CTLIN_H_
+#define _MESSAGE_CTLIN_H_
+
+#include "RemoteMessageReceiver.h"
+
+/**
+ * [ctlin], [ctlin float], [ctlin float float]
+ * Outputs midi control changes. Without arguments, the value, controller number and channel are
+ * output. If a controller number is given, the value and channel of that controller are output.
+ * If a (1-indexed) channel is also given, only the value is output.
+ */
+class MessageCtlin : public RemoteMessageReceiver {
+  
+  public:
+    static MessageObject *newObject(PdMessage *initMessage, PdGraph *graph);
+    MessageCtlin(PdMessage *initMessage, PdGraph *graph);
+    ~MessageCtlin();
+    
+    static const char *getObjectLabel() { return "ctlin"; }
+    std::string toString() { return MessageCtlin::getObjectLabel(); }
+    ObjectType getObjectType() { return MESSAGE_CTLIN; }
+    
+  private:
+    void processMessage(int inletIndex, PdMessage *message);
+
+    int controller; // -1 if any
+    int channel; // zero-indexed, -1 if omni
+};
+
+#endif // _MESSAGE_CTLIN_H_
@@ -27,9 +27,12 @@
  *
  */
 
+#include <algorithm>
 #include "MessageMessageBox.h"
 #include "PdGraph.h"
 
+#define RES_BUFFER_LENGTH 64
+
 MessageObject *MessageMessageBox::newObject(PdMessage *initString, PdGraph *graph) {
   return new MessageMessageBox(initString->getSymbol(0), graph);
 }
@@ -64,7 +67,7 @@ MessageMessageBox::MessageMessageBox(char *initString, PdGraph *graph) : Message
     if (strcmp(initString.c_str(), ";") != 0) {
       char str[initString.size()+1]; strcpy(str, initString.c_str());
       message->initWithString(0.0, maxElements, str);
-      localMessageList.push_back(message->copyToHeap());
+      localMessageList.push_back(compileTemplate(message->copyToHeap(), NULL));
     }
   }
   
@@ -81,69 +84,176 @@ MessageMessageBox::MessageMessageBox(char *initString, PdGraph *graph) : Message
       PdMessage *message = PD_MESSAGE_ON_STACK(maxElements);
       char str[messageString.size()+1]; strcpy(str, messageString.c_str());
       message->initWithString(0.0, maxElements, str);
-      MessageNamedDestination namedDestination = 
-          make_pair(StaticUtils::copyString(name.c_str()), message->copyToHeap());
-      remoteMessageList.push_back(namedDestination);
+      remoteMessageList.push_back(compileTemplate(message->copyToHeap(),
+          StaticUtils::copyString(name.c_str())));
     }
   }
+  
+  maxConcatenations = 0;
+  for (unsigned int i = 0; i < localMessageList.size(); i++) {
+    maxConcatenations = std::max(maxConcatenations, localMessageList[i].numConcatenations);
+  }
+  for (unsigned int i = 0; i < remoteMessageList.size(); i++) {
+    maxConcatenations = std::max(maxConcatenations, remoteMessageList[i].numConcatenations);
+  }
 }
 
 MessageMessageBox::~MessageMessageBox() {
   // delete the message list and all of the messages in it
   for (int i = 0; i < localMessageList.size(); i++) {
-    localMessageList.at(i)->freeMessage();
+    localMessageList[i].message->freeMessage();
   }
   
   // delete the remote message list
   for (int i = 0; i < remoteMessageList.size(); i++) {
-    MessageNamedDestination namedDestination = remoteMessageList.at(i);
-    free(namedDestination.first);
-    namedDestination.second->freeMessage();
+    free(remoteMessageList[i].name);
+    remoteMessageList[i].message->freeMessage();
+  }
+}
+
+
+#pragma mark -
+#pragma mark Template Compilation
+
+bool MessageMessageBox::compileString(const char *string, vector<SubstitutionOp> &ops) {
+  vector<SubstitutionOp> compiledOps;
+  bool hasArgument = false;
+  const char *literalStart = string;
+  const char *pos = string;
+  while ((pos = strstr(pos, "\\$")) != NULL) {
+    if (pos[2] < '0' || pos[2] > '9') {
+      pos += 2; // not an argument reference, keep it as part of the literal
+      continue;
+    }
+    if (pos > literalStart) {
+      SubstitutionOp literalOp = {literalStart, (unsigned int) (pos - literalStart), 0};
+      compiledOps.push_back(literalOp);
+    }
+    // in message boxes $1 refers to the first (0th) element of the incoming message
+    SubstitutionOp argumentOp = {NULL, 0, pos[2] - '1'};
+    compiledOps.push_back(argumentOp);
+    hasArgument = true;
+    pos += 3;
+    literalStart = pos;
+  }
+  if (!hasArgument) return false;
+  
+  if (*literalStart != '\0') {
+    SubstitutionOp literalOp = {literalStart, (unsigned int) strlen(literalStart), 0};
+    compiledOps.push_back(literalOp);
+  }
+  ops.insert(ops.end(), compiledOps.begin(), compiledOps.end());
+  return true;
+}
+
+MessageTemplate MessageMessageBox::compileTemplate(PdMessage *message, char *name) {
+  MessageTemplate messageTemplate;
+  messageTemplate.message = message;
+  messageTemplate.name = name;
+  messageTemplate.numConcatenations = 0;
+  if (name != NULL) compileString(name, messageTemplate.nameOps);
+  
+  for (int i = 0; i < message->getNumElements(); i++) {
+    if (message->isSymbol(i)) {
+      ElementSubstitution substitution;
+      substitution.elementIndex = i;
+      if (compileString(message->getSymbol(i), substitution.ops)) {
+        if (substitution.ops.size() == 1) {
+          // the element is only a reference to an argument, which can be copied as is
+          substitution.argumentIndex = substitution.ops[0].argumentIndex;
+          substitution.ops.clear();
+        } else {
+          messageTemplate.numConcatenations++;
+        }
+        messageTemplate.substitutions.push_back(substitution);
+      }
+    }
+  }
+  return messageTemplate;
+}
+
+
+#pragma mark -
+#pragma mark Template Execution
+
+void MessageMessageBox::resolveOps(vector<SubstitutionOp> &ops, PdMessage *arguments,
+    char *buffer, unsigned int bufferLength) {
+  unsigned int bufferPos = 0;
+  for (unsigned int i = 0; i < ops.size() && bufferPos < bufferLength-1; i++) {
+    SubstitutionOp &op = ops[i];
+    int numCharsWritten = 0;
+    if (op.literal != NULL) {
+      numCharsWritten = std::min(op.length, bufferLength-1-bufferPos);
+      memcpy(buffer + bufferPos, op.literal, numCharsWritten);
+    } else if (op.argumentIndex >= 0 && op.argumentIndex < arguments->getNumElements()) {
+      switch (arguments->getType(op.argumentIndex)) {
+        case FLOAT: {
+          numCharsWritten = snprintf(buffer + bufferPos, bufferLength - bufferPos,
+              "%g", arguments->getFloat(op.argumentIndex));
+          break;
+        }
+        case SYMBOL: {
+          numCharsWritten = snprintf(buffer + bufferPos, bufferLength - bufferPos,
+              "%s", arguments->getSymbol(op.argumentIndex));
+          break;
+        }
+        default: break;
+      }
+    } else {
+      // index is out of bounds. Write a zero, as pd does.
+      numCharsWritten = snprintf(buffer + bufferPos, bufferLength - bufferPos, "0");
+    }
+    bufferPos = std::min(bufferPos + numCharsWritten, bufferLength-1);
+  }
+  buffer[bufferPos] = '\0';
+}
+
+void MessageMessageBox::fillTemplate(MessageTemplate &messageTemplate, PdMessage *arguments,
+    PdMessage *outgoingMessage, char *buffer) {
+  PdMessage *message = messageTemplate.message;
+  int numElements = message->getNumElements();
+  outgoingMessage->initWithTimestampAndNumElements(arguments->getTimestamp(), numElements);
+  memcpy(outgoingMessage->getElement(0), message->getElement(0), numElements*sizeof(MessageAtom));
+  
+  for (unsigned int i = 0; i < messageTemplate.substitutions.size(); i++) {
+    ElementSubstitution &substitution = messageTemplate.substitutions[i];
+    if (!substitution.ops.empty()) {
+      resolveOps(substitution.ops, arguments, buffer, RES_BUFFER_LENGTH);
+      outgoingMessage->parseAndSetMessageElement(substitution.elementIndex, buffer);
+      buffer += RES_BUFFER_LENGTH;
+    } else if (substitution.argumentIndex >= 0 &&
+        substitution.argumentIndex < arguments->getNumElements()) {
+      memcpy(outgoingMessage->getElement(substitution.elementIndex),
+          arguments->getElement(substitution.argumentIndex), sizeof(MessageAtom));
+    } else {
+      // index is out of bounds (or $0, which has no meaning in a message box). Write a zero.
+      outgoingMessage->setFloat(substitution.elementIndex, 0.0f);
+    }
   }
 }
 
 void MessageMessageBox::processMessage(int inletIndex, PdMessage *message) {
-#define RES_BUFFER_LENGTH 64
   char resolvedName[RES_BUFFER_LENGTH]; // resolution buffer for named destination
+  char *buffer = (char *) alloca(maxConcatenations * RES_BUFFER_LENGTH * sizeof(char));
   
   // NOTE(mhroth): if any message has more than 64 elements, that's very bad
   PdMessage *outgoingMessage = PD_MESSAGE_ON_STACK(64);
   
   // send local messages
   for (int i = 0; i < localMessageList.size(); i++) {
-    PdMessage *messageTemplate = localMessageList.at(i);
-    int numElements = messageTemplate->getNumElements();
-    outgoingMessage->initWithTimestampAndNumElements(message->getTimestamp(), numElements);
-    memcpy(outgoingMessage->getElement(0), messageTemplate->getElement(0), numElements*sizeof(MessageAtom));
-    for (int i = 0; i < numElements; i++) {
-      if (messageTemplate->isSymbol(i)) {
-        char *buffer = (char *) alloca(RES_BUFFER_LENGTH * sizeof(char));
-        // TODO(mhroth): resolve string, but may be in stack buffer
-        PdMessage::resolveString(messageTemplate->getSymbol(i), message, 1, buffer, RES_BUFFER_LENGTH);
-        outgoingMessage->parseAndSetMessageElement(i, buffer); // buffer is resolved to float or string
-      }
-    }
+    fillTemplate(localMessageList[i], message, outgoingMessage, buffer);
     sendMessage(0, outgoingMessage);
   }
 
   // send remote messages
   for (int i = 0; i < remoteMessageList.size(); i++) {
-    MessageNamedDestination namedDestination = remoteMessageList.at(i);
-
-    PdMessage::resolveString(namedDestination.first, message, 1, resolvedName, RES_BUFFER_LENGTH);
-    
-    PdMessage *messageTemplate = namedDestination.second;
-    int numElements = messageTemplate->getNumElements();
-    outgoingMessage->initWithTimestampAndNumElements(message->getTimestamp(), numElements);
-    memcpy(outgoingMessage->getElement(0), messageTemplate->getElement(0), numElements*sizeof(MessageAtom));
-    for (int i = 0; i < numElements; i++) {
-      if (messageTemplate->isSymbol(i)) {
-        char *buffer = (char *) alloca(RES_BUFFER_LENGTH * sizeof(char));
-        // TODO(mhroth): resolve string, but may be in stack buffer
-        PdMessage::resolveString(messageTemplate->getSymbol(i), message, 1, buffer, RES_BUFFER_LENGTH);
-        outgoingMessage->setSymbol(i, buffer);
-      }
+    MessageTemplate &messageTemplate = remoteMessageList[i];
+    char *name = messageTemplate.name;
+    if (!messageTemplate.nameOps.empty()) {
+      resolveOps(messageTemplate.nameOps, message, resolvedName, RES_BUFFER_LENGTH);
+      name = resolvedName;
     }
-    graph->sendMessageToNamedReceivers(resolvedName, outgoingMessage);
+    fillTemplate(messageTemplate, message, outgoingMessage, buffer);
+    graph->sendMessageToNamedReceivers(name, outgoingMessage);
   }
 }
@@ -32,7 +32,43 @@
 
 #include "MessageObject.h"
 
-typedef std::pair<char *, PdMessage *> MessageNamedDestination;
+/**
+ * One step of a compiled <code>$</code>-substitution. Either a run of literal characters, or a
+ * reference to an element of the incoming message.
+ */
+typedef struct SubstitutionOp {
+  const char *literal; // NULL if this step refers to an argument
+  unsigned int length; // length of the literal
+  int argumentIndex; // index of the argument in the incoming message
+} SubstitutionOp;
+
+/** Describes how one element of a message template is filled in from the incoming message. */
+typedef struct ElementSubstitution {
+  unsigned int elementIndex;
+  
+  /**
+   * If the element consists of exactly one <code>$</code> argument, the index of the argument and
+   * <code>ops</code> is empty. Otherwise the element is built by concatenating <code>ops</code>.
+   */
+  int argumentIndex;
+  vector<SubstitutionOp> ops;
+} ElementSubstitution;
+
+/**
+ * A message template which has been compiled at construction. Literal elements are stored in
+ * <code>message</code> and only the listed substitutions are evaluated when the box is triggered.
+ */
+typedef struct MessageTemplate {
+  PdMessage *message;
+  vector<ElementSubstitution> substitutions;
+  
+  /** The receiver name of a remote message, or NULL for messages sent from the outlet. */
+  char *name;
+  vector<SubstitutionOp> nameOps; // empty if the name does not contain a <code>$</code> argument
+  
+  /** The number of substitutions which must be concatenated into a string. */
+  unsigned int numConcatenations;
+} MessageTemplate;
 
 /** Implements the functionality of Pd's message box. */
 class MessageMessageBox : public MessageObject {
@@ -48,8 +84,35 @@ class MessageMessageBox : public MessageObject {
   private:
     void processMessage(int inletIndex, PdMessage *message);
   
-    vector<PdMessage *> localMessageList;
-    vector<MessageNamedDestination> remoteMessageList;
+    /** Compiles the <code>$</code> arguments of the given message into a template. */
+    static MessageTemplate compileTemplate(PdMessage *message, char *name);
+  
+    /**
+     * Splits a string into literal runs and argument references. Returns <code>false</code> if
+     * the string contains no argument reference, in which case no ops are added.
+     */
+    static bool compileString(const char *string, vector<SubstitutionOp> &ops);
+  
+    /**
+     * Writes the concatenation described by <code>ops</code> into <code>buffer</code>, using the
+     * elements of <code>arguments</code>.
+     */
+    static void resolveOps(vector<SubstitutionOp> &ops, PdMessage *arguments, char *buffer,
+        unsigned int bufferLength);
+  
+    /**
+     * Copies the template into <code>outgoingMessage</code> and fills in all substitutions.
+     * Concatenated symbols are written into <code>buffer</code>, which must have space for
+     * <code>numConcatenations</code> strings.
+     */
+    static void fillTemplate(MessageTemplate &messageTemplate, PdMessage *arguments,
+        PdMessage *outgoingMessage, char *buffer);
+  
+    vector<MessageTemplate> localMessageList;
+    vector<MessageTemplate> remoteMessageList;
+  
+    /** The largest <code>numConcatenations</code> of all templates. */
+    unsigned int maxConcatenations;
 };
 
 inline const char *MessageMessageBox::getObjectLabel() {
@@ -40,6 +40,7 @@ MessageObject::MessageObject(int numMessageInlets, int numMessageOutlets, PdGrap
   
   // initialise outgoing connections list
   outgoingMessageConnections = vector<list<ObjectLetPair> >(numMessageOutlets);
+  messageFanOutIndex = vector<unsigned int>(numMessageOutlets+1, 0);
 }
 
 MessageObject::~MessageObject() {
@@ -50,6 +51,10 @@ ConnectionType MessageObject::getConnectionType(int outletIndex) {
   return MESSAGE;
 }
 
+ConnectionType MessageObject::getInletConnectionType(int inletIndex) {
+  return MESSAGE;
+}
+
 bool MessageObject::shouldDistributeMessageToInlets() {
   return true;
 }
@@ -93,10 +98,10 @@ void MessageObject::receiveMessage(int inletIndex, PdMessage *message) {
 }
 
 void MessageObject::sendMessage(int outletIndex, PdMessage *message) {
-  list<ObjectLetPair>::iterator it = outgoingMessageConnections[outletIndex].begin();
-  list<ObjectLetPair>::iterator end = outgoingMessageConnections[outletIndex].end();
-  while (it != end) {
-    ObjectLetPair objectLetPair = *it++;
+  // The bounds are read again for every connection, as a receiver may edit the connections of this
+  // object and thus rebuild the fan-out table while the message is being dispatched.
+  for (unsigned int i = 0; messageFanOutIndex[outletIndex] + i < messageFanOutIndex[outletIndex+1]; ++i) {
+    ObjectLetPair objectLetPair = messageFanOut[messageFanOutIndex[outletIndex] + i];
     objectLetPair.first->receiveMessage(objectLetPair.second, message);
   }
 }
@@ -122,6 +127,7 @@ void MessageObject::addConnectionToObjectFromOutlet(MessageObject *messageObject
     list<ObjectLetPair> *connections = &outgoingMessageConnections[outletIndex];
     ObjectLetPair objectLetPair = make_pair(messageObject, inletIndex);
     connections->push_back(objectLetPair);
+    rebuildMessageFanOut();
   }
 }
 
@@ -138,6 +144,17 @@ void MessageObject::removeConnectionToObjectFromOutlet(MessageObject *messageObj
   list<ObjectLetPair> *outgoingConnections = &outgoingMessageConnections[outletIndex];
   ObjectLetPair objectLetPair = make_pair(messageObject, inletIndex);
   outgoingConnections->remove(objectLetPair);
+  rebuildMessageFanOut();
+}
+
+void MessageObject::rebuildMessageFanOut() {
+  messageFanOut.clear();
+  for (unsigned int i = 0; i < outgoingMessageConnections.size(); ++i) {
+    messageFanOutIndex[i] = messageFanOut.size();
+    messageFanOut.insert(messageFanOut.end(),
+        outgoingMessageConnections[i].begin(), outgoingMessageConnections[i].end());
+  }
+  messageFanOutIndex[outgoingMessageConnections.size()] = messageFanOut.size();
 }
 
 list<ObjectLetPair> MessageObject::getIncomingConnections(unsigned int inletIndex) {
@@ -73,6 +73,9 @@ class MessageObject {
     /** Returns the connection type of the given outlet. */
     virtual ConnectionType getConnectionType(int outletIndex);
   
+    /** Returns the connection type accepted by the given inlet. Signal inlets also accept messages. */
+    virtual ConnectionType getInletConnectionType(int inletIndex);
+  
     virtual list<ObjectLetPair> getIncomingConnections(unsigned int inletIndex);
   
     virtual list<ObjectLetPair> getOutgoingConnections(unsigned int outletIndex);
@@ -142,7 +145,7 @@ class MessageObject {
      * Reset the <code>isOrdered</code> flag to <code>false</code>. This is necessary in order to
      * recompute the process order.
      */
-    void resetOrderedFlag();
+    virtual void resetOrderedFlag();
   
     virtual unsigned int getNumInlets();
     virtual unsigned int getNumOutlets();
@@ -171,8 +174,20 @@ class MessageObject {
     vector<list<ObjectLetPair> > incomingMessageConnections;
     vector<list<ObjectLetPair> > outgoingMessageConnections;
   
+    /**
+     * The outgoing message connections of all outlets, flattened into one contiguous array which is
+     * walked by <code>sendMessage()</code>. The connections of outlet i are found in the range
+     * [messageFanOutIndex[i], messageFanOutIndex[i+1]). Rebuilt whenever a connection is edited.
+     */
+    vector<ObjectLetPair> messageFanOut;
+    vector<unsigned int> messageFanOutIndex;
+  
     /** A flag indicating that this object has already been considered when ordering the process tree. */
     bool isOrdered;
+  
+  private:
+    /** Rebuilds the flattened fan-out table from <code>outgoingMessageConnections</code>. */
+    void rebuildMessageFanOut();
 };
 
 #endif // _MESSAGE_OBJECT_H_
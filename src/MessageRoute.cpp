@@ -35,28 +35,21 @@ MessageObject *MessageRoute::newObject(PdMessage *initMessage, PdGraph *graph) {
 
 MessageRoute::MessageRoute(PdMessage *initMessage, PdGraph *graph) : 
     MessageObject(1, initMessage->getNumElements()+1, graph) {
-  routeMessage = initMessage->copyToHeap();
+  dispatchTable = new AtomDispatchTable(initMessage);
+  numRouteChecks = initMessage->getNumElements();
 }
 
 MessageRoute::~MessageRoute() {
-  routeMessage->freeMessage();
+  delete dispatchTable;
 }
 
 void MessageRoute::processMessage(int inletIndex, PdMessage *message) {
-  int numRouteChecks = routeMessage->getNumElements();
-  int outletIndex = numRouteChecks; // by default, send the message out of the right outlet
   // find which indicator that message matches
-  MessageAtom *messageAtom = message->getElement(0);
-  for (int i = 0; i < numRouteChecks; i++) {
-    if (routeMessage->atomIsEqualTo(i, messageAtom)) {
-      outletIndex = i;
-      break;
-    }
-  }
+  int outletIndex = dispatchTable->getIndex(message->getElement(0));
   
-  if (outletIndex == numRouteChecks) {
+  if (outletIndex < 0) {
     // no match found, forward on right oulet
-    sendMessage(outletIndex, message);
+    sendMessage(numRouteChecks, message);
   } else {
     // construct a new message to send from the given outlet
     int numElements = message->getNumElements() - 1;
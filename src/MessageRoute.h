@@ -30,6 +30,7 @@
 #ifndef _MESSAGE_ROUTE_H_
 #define _MESSAGE_ROUTE_H_
 
+#include "AtomDispatchTable.h"
 #include "MessageObject.h"
 
 /** [route] */
@@ -46,7 +47,8 @@ class MessageRoute : public MessageObject {
   private:
     void processMessage(int inletIndex, PdMessage *message);
   
-    PdMessage *routeMessage;
+    AtomDispatchTable *dispatchTable;
+    int numRouteChecks;
 };
 
 inline const char *MessageRoute::getObjectLabel() {
@@ -37,26 +37,24 @@ MessageObject *MessageSelect::newObject(PdMessage *initMessage, PdGraph *graph)
 MessageSelect::MessageSelect(PdMessage *initMessage, PdGraph *graph) : 
     MessageObject((initMessage->getNumElements() < 2) ? 2 : 1, 
                   (initMessage->getNumElements() < 2) ? 2 : initMessage->getNumElements()+1, graph) {
-  selectorMessage = initMessage->copyToHeap();
+  dispatchTable = new AtomDispatchTable(initMessage);
+  numSelectors = initMessage->getNumElements();
 }
 
 MessageSelect::~MessageSelect() {
-  selectorMessage->freeMessage();
+  delete dispatchTable;
 }
 
 void MessageSelect::processMessage(int inletIndex, PdMessage *message) {
   switch (inletIndex) {
     case 0: {
-      MessageAtom *messageElement = message->getElement(0);
-      int numSelectors = selectorMessage->getNumElements();
-      for (int i = 0; i < numSelectors; i++) {
-        if (selectorMessage->atomIsEqualTo(i, messageElement)) {
-          // send bang from matching outlet
-          PdMessage *outgoingMessage = PD_MESSAGE_ON_STACK(1);
-          outgoingMessage->initWithTimestampAndBang(message->getTimestamp());
-          sendMessage(i, outgoingMessage);
-          return;
-        }
+      int outletIndex = dispatchTable->getIndex(message->getElement(0));
+      if (outletIndex >= 0) {
+        // send bang from matching outlet
+        PdMessage *outgoingMessage = PD_MESSAGE_ON_STACK(1);
+        outgoingMessage->initWithTimestampAndBang(message->getTimestamp());
+        sendMessage(outletIndex, outgoingMessage);
+        return;
       }
 
       // message does not match any selector. Send it out to of the last outlet.
@@ -30,6 +30,7 @@
 #ifndef _MESSAGE_SELECT_H_
 #define _MESSAGE_SELECT_H_
 
+#include "AtomDispatchTable.h"
 #include "MessageObject.h"
 
 /** [select], [sel] */
@@ -46,7 +47,8 @@ class MessageSelect : public MessageObject {
   private:
     void processMessage(int inletIndex, PdMessage *message);
    
-    PdMessage *selectorMessage;
+    AtomDispatchTable *dispatchTable;
+    int numSelectors;
 };
 
 inline const char *MessageSelect::getObjectLabel() {
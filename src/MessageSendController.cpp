@@ -27,6 +27,7 @@
  *
  */
 
+#include <algorithm>
 #include "MessageSendController.h"
 #include "PdContext.h"
 
@@ -37,7 +38,9 @@
 // and Lists as the value.
 MessageSendController::MessageSendController(PdContext *aContext) : MessageObject(0, 0, NULL) {
   context = aContext;
-  sendStack = vector<std::pair<string, set<RemoteMessageReceiver *> > >();
+  sendStack = vector<std::pair<string, vector<RemoteMessageReceiver *> > >();
+  dispatchDepth = 0;
+  hasRemovedReceivers = false;
 }
 
 MessageSendController::~MessageSendController() {
@@ -68,8 +71,7 @@ void MessageSendController::receiveMessage(const char *name, PdMessage *message)
   
   // check to see if the receiver name has been registered as an external receiver
   if (externalReceiverSet.find(string(name)) != externalReceiverSet.end()) {
-    std::pair<const char *, PdMessage *> pair = make_pair(name, message);
-    context->callbackFunction(ZG_RECEIVER_MESSAGE, context->callbackUserData, &pair);
+    context->sendExternalMessage(name, message);
   }
 }
 
@@ -77,10 +79,22 @@ void MessageSendController::sendMessage(int outletIndex, PdMessage *message) {
   if (outletIndex == SYSTEM_NAME_INDEX) {
     context->receiveSystemMessage(message);
   } else {
-    set<RemoteMessageReceiver *> receiverSet = sendStack[outletIndex].second;
-    for (set<RemoteMessageReceiver *>::iterator it = receiverSet.begin(); it != receiverSet.end(); ++it) {
-      RemoteMessageReceiver *receiver = *it;
-      receiver->receiveMessage(0, message);
+    // Receivers may be added or removed by the receivers themselves. The send stack is therefore
+    // indexed again for every receiver, as it may be reallocated. Receivers which are added during
+    // dispatch do not receive this message.
+    ++dispatchDepth;
+    unsigned int numReceivers = sendStack[outletIndex].second.size();
+    for (unsigned int i = 0; i < numReceivers; ++i) {
+      RemoteMessageReceiver *receiver = sendStack[outletIndex].second[i];
+      if (receiver != NULL) receiver->receiveMessage(0, message);
+    }
+    if (--dispatchDepth == 0 && hasRemovedReceivers) {
+      for (unsigned int i = 0; i < sendStack.size(); ++i) {
+        vector<RemoteMessageReceiver *> *receivers = &(sendStack[i].second);
+        receivers->erase(remove(receivers->begin(), receivers->end(), (RemoteMessageReceiver *) NULL),
+            receivers->end());
+      }
+      hasRemovedReceivers = false;
     }
   }
 }
@@ -88,23 +102,33 @@ void MessageSendController::sendMessage(int outletIndex, PdMessage *message) {
 void MessageSendController::addReceiver(RemoteMessageReceiver *receiver) {
   int nameIndex = getNameIndex(receiver->getName());
   if (nameIndex == -1) {
-    set<RemoteMessageReceiver *> remoteSet = set<RemoteMessageReceiver *>();
-    remoteSet.insert(receiver);
-    std::pair<string, set<RemoteMessageReceiver *> > nameSetPair =
-        make_pair(string(receiver->getName()), remoteSet);
-    sendStack.push_back(nameSetPair);
+    std::pair<string, vector<RemoteMessageReceiver *> > nameReceiversPair =
+        make_pair(string(receiver->getName()), vector<RemoteMessageReceiver *>());
+    sendStack.push_back(nameReceiversPair);
     nameIndex = sendStack.size()-1;
   }
   
-  set<RemoteMessageReceiver *> *receiverSet = &(sendStack[nameIndex].second);
-  receiverSet->insert(receiver);
+  // receivers are unique
+  vector<RemoteMessageReceiver *> *receivers = &(sendStack[nameIndex].second);
+  if (find(receivers->begin(), receivers->end(), receiver) == receivers->end()) {
+    receivers->push_back(receiver);
+  }
 }
 
 void MessageSendController::removeReceiver(RemoteMessageReceiver *receiver) {
   int nameIndex = getNameIndex(receiver->getName());
   if (nameIndex != -1) {
-    set<RemoteMessageReceiver *> *receiverSet = &(sendStack[nameIndex].second);
-    receiverSet->erase(receiver);
+    vector<RemoteMessageReceiver *> *receivers = &(sendStack[nameIndex].second);
+    vector<RemoteMessageReceiver *>::iterator it = find(receivers->begin(), receivers->end(), receiver);
+    if (it != receivers->end()) {
+      if (dispatchDepth > 0) {
+        // the receiver list may be being iterated. Mark the entry and compact it later.
+        *it = NULL;
+        hasRemovedReceivers = true;
+      } else {
+        receivers->erase(it);
+      }
+    }
     // NOTE(mhroth):
     // once the receiver set has been created, it should not be erased anymore from the sendStack.
     // PdContext depends on the nameIndex to be constant for all receiver names once they are
@@ -32,6 +32,7 @@
 
 #include <set>
 #include <string>
+#include <vector>
 #include "MessageObject.h"
 #include "RemoteMessageReceiver.h"
 
@@ -82,12 +83,26 @@ class MessageSendController : public MessageObject {
   
     void registerExternalReceiver(const char *receiverName);
     void unregisterExternalReceiver(const char *receiverName);
+
+    /** Returns the names of all registered external receivers. */
+    const set<string> &getExternalReceivers() { return externalReceiverSet; }
   
   private:
   
     PdContext *context;
   
-    vector<std::pair<string, set<RemoteMessageReceiver *> > > sendStack;
+    /**
+     * The receivers registered for each name. Receivers are stored contiguously and are iterated in
+     * place by <code>sendMessage()</code>. Receivers removed while a message is being dispatched are
+     * only marked as <code>NULL</code>, and are compacted once the outermost dispatch returns.
+     */
+    vector<std::pair<string, vector<RemoteMessageReceiver *> > > sendStack;
+  
+    /** The depth of nested calls to <code>sendMessage()</code>. */
+    unsigned int dispatchDepth;
+  
+    /** True if receivers have been removed during dispatch and the send stack must be compacted. */
+    bool hasRemovedReceivers;
   
     set<string> externalReceiverSet;
 };
@@ -30,6 +30,7 @@
 #include "MessageSoundfiler.h"
 #include "MessageTable.h"
 #include "PdGraph.h"
+#include "SharedTableStore.h"
 
 #include <sndfile.h>
 
@@ -45,6 +46,39 @@ MessageSoundfiler::~MessageSoundfiler() {
   // nothing to do
 }
 
+void MessageSoundfiler::readChannel(MessageTable *table, bool shouldResizeTable, float *buffer,
+    int numChannels, int channel, int samplesPerChannel, const std::string &sharedKey)
+{
+  // an empty file leaves the table as it is, as tables are never resized to zero
+  if (samplesPerChannel <= 0) return;
+  
+  if (shouldResizeTable)
+  {
+    // the table takes the length of the file, and so can reference the shared channel
+    float *channelBuffer = (float *) malloc(samplesPerChannel * sizeof(float));
+    for (int i = channel, j = 0; j < samplesPerChannel; i+=numChannels, j++)
+    {
+      channelBuffer[j] = buffer[i];
+    }
+    table->setSharedBuffer(SharedTableStore::acquireOwned(sharedKey.c_str(), channelBuffer,
+        samplesPerChannel));
+  }
+  else
+  {
+    int tableLength = 0;
+    float *tableBuffer = table->getWritableBuffer(&tableLength);
+    if (tableLength > samplesPerChannel)
+    {
+      // avoid trying to read more into the table buffer than is available
+      tableLength = samplesPerChannel;
+    }
+    for (int i = channel, j = 0; j < tableLength; i+=numChannels, j++)
+    {
+      tableBuffer[j] = buffer[i];
+    }
+  }
+}
+
 void MessageSoundfiler::processMessage(int inletIndex, PdMessage *message)
 {
   if (message->isSymbol(0, "read"))
@@ -85,6 +119,33 @@ void MessageSoundfiler::processMessage(int inletIndex, PdMessage *message)
       return;
     }
     
+    // resized tables reference the decoded channels in the shared table store, such that a file
+    // is decoded only once for all tables (of all contexts) which read it. The key includes the
+    // stamp of the file, such that a modified file is decoded again
+    std::string sharedKey = std::string(fullPath) + "@" + StaticUtils::fileStamp(fullPath) + "#";
+    if (shouldResizeTable)
+    {
+      MessageTable *secondTable = message->isSymbol(currentElementIndex) ?
+          graph->getTable(message->getSymbol(currentElementIndex)) : NULL;
+      SharedTableBuffer *sharedBuffer = SharedTableStore::acquire((sharedKey + "0").c_str());
+      SharedTableBuffer *secondSharedBuffer = (sharedBuffer != NULL && secondTable != NULL) ?
+          SharedTableStore::acquire((sharedKey + "1").c_str()) : NULL;
+      if (sharedBuffer != NULL && (secondTable == NULL || secondSharedBuffer != NULL))
+      {
+        free(fullPath);
+        int samplesPerChannel = sharedBuffer->bufferLength;
+        table->setSharedBuffer(sharedBuffer);
+        if (secondTable != NULL) secondTable->setSharedBuffer(secondSharedBuffer);
+        PdMessage *outgoingMessage = PD_MESSAGE_ON_STACK(1);
+        outgoingMessage->initWithTimestampAndFloat(message->getTimestamp(), samplesPerChannel);
+        sendMessage(0, outgoingMessage);
+        return;
+      }
+      // a requested channel has not been decoded yet, so the file is read
+      SharedTableStore::release(sharedBuffer);
+      SharedTableStore::release(secondSharedBuffer);
+    }
+    
     SNDFILE *sndFile = sf_open(fullPath, SFM_READ, &sfInfo);
     if (sndFile == NULL)
     {
@@ -92,7 +153,7 @@ void MessageSoundfiler::processMessage(int inletIndex, PdMessage *message)
       free(fullPath);
       return; // there was an error reading the file. Move on with life.
     }
-    delete fullPath;
+    free(fullPath);
     
     // It is assumed that the channels are interleaved.
     int samplesPerChannel = static_cast<int>(sfInfo.frames);
@@ -104,40 +165,20 @@ void MessageSoundfiler::processMessage(int inletIndex, PdMessage *message)
     
     if (sfInfo.channels > 0) // sanity check
     {
-      // get the table's buffer. Resize the buffer if necessary.
-      int tableLength = samplesPerChannel;
-      float *tableBuffer = shouldResizeTable ? table->resizeBuffer(samplesPerChannel) :
-      table->getBuffer(&tableLength);
-      if (tableLength > samplesPerChannel)
-      {
-        // avoid trying to read more into the table buffer than is available
-        tableLength = samplesPerChannel;
-      }
-      
       // extract the first channel
-      for (int i = 0, j = 0; i < bufferLength; i+=sfInfo.channels, j++)
-      {
-        tableBuffer[j] = buffer[i];
-      }
+      readChannel(table, shouldResizeTable, buffer, sfInfo.channels, 0, samplesPerChannel,
+          sharedKey + "0");
       
       // extract the second channel (if it exists and if there is a table to write it to)
       if (sfInfo.channels > 1 &&
           (tabName = message->getSymbol(currentElementIndex++)) != NULL &&
           (table = graph->getTable(tabName)) != NULL)
       {
-        tableLength = samplesPerChannel;
-        tableBuffer = shouldResizeTable ? table->resizeBuffer(samplesPerChannel) :
-        table->getBuffer(&tableLength);
-        if (tableLength > samplesPerChannel)
-        {
-          // avoid trying to read more into the table buffer than is available
-          tableLength = samplesPerChannel;
-        }
-        for (int i = 1, j = 0; i < bufferLength; i+=sfInfo.channels, j++)
-          tableBuffer[j] = buffer[i];
+        readChannel(table, shouldResizeTable, buffer, sfInfo.channels, 1, samplesPerChannel,
+            sharedKey + "1");
       }
     }
-    delete buffer;
+    free(buffer);
     
     // send message with sample length when all tables have been filled
     PdMessage *outgoingMessage = PD_MESSAGE_ON_STACK(1);
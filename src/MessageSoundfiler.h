@@ -32,6 +32,8 @@
 
 #include "MessageObject.h"
 
+class MessageTable;
+
 /** [soundfiler~] */
 class MessageSoundfiler : public MessageObject {
   
@@ -45,6 +47,13 @@ class MessageSoundfiler : public MessageObject {
     
   private:
     void processMessage(int inletIndex, PdMessage *message);
+  
+    /**
+     * Fills the table with one channel of the interleaved buffer. A resized table references the
+     * channel in the shared table store under the given key.
+     */
+    void readChannel(MessageTable *table, bool shouldResizeTable, float *buffer, int numChannels,
+        int channel, int samplesPerChannel, const std::string &sharedKey);
 };
 
 inline const char *MessageSoundfiler::getObjectLabel() {
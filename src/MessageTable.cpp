@@ -30,6 +30,7 @@
 #include "ArrayArithmetic.h"
 #include "MessageTable.h"
 #include "PdGraph.h"
+#include "SharedTableStore.h"
 
 #define DEFAULT_BUFFER_LENGTH 1024
 
@@ -38,6 +39,7 @@ MessageObject *MessageTable::newObject(PdMessage *initMessage, PdGraph *graph) {
 }
 
 MessageTable::MessageTable(PdMessage *initMessage, PdGraph *graph) : RemoteMessageReceiver(0, 0, graph) {
+  sharedBuffer = NULL;
   if (initMessage->isSymbol(0)) {
     name = StaticUtils::copyString(initMessage->getSymbol(0));
     // by default, the buffer length is 1024. The buffer should never be NULL.
@@ -53,7 +55,11 @@ MessageTable::MessageTable(PdMessage *initMessage, PdGraph *graph) : RemoteMessa
 
 MessageTable::~MessageTable() {
   free(name);
-  free(buffer);
+  if (sharedBuffer != NULL) {
+    SharedTableStore::release(sharedBuffer);
+  } else {
+    free(buffer);
+  }
 }
 
 float *MessageTable::getBuffer(int *bufferLength) {
@@ -61,8 +67,42 @@ float *MessageTable::getBuffer(int *bufferLength) {
   return buffer;
 }
 
+float *MessageTable::getWritableBuffer(int *bufferLength) {
+  if (sharedBuffer != NULL) copySharedBuffer(this->bufferLength);
+  *bufferLength = this->bufferLength;
+  return buffer;
+}
+
+void MessageTable::copySharedBuffer(int newBufferLength) {
+  float *privateBuffer = (float *) calloc(newBufferLength, sizeof(float));
+  memcpy(privateBuffer, buffer, ((newBufferLength < bufferLength) ? newBufferLength : bufferLength) * sizeof(float));
+  SharedTableStore::release(sharedBuffer);
+  sharedBuffer = NULL;
+  buffer = privateBuffer;
+  bufferLength = newBufferLength;
+}
+
+void MessageTable::setSharedBuffer(SharedTableBuffer *aSharedBuffer) {
+  if (sharedBuffer != NULL) {
+    SharedTableStore::release(sharedBuffer);
+  } else {
+    free(buffer);
+  }
+  sharedBuffer = aSharedBuffer;
+  buffer = sharedBuffer->buffer;
+  bufferLength = sharedBuffer->bufferLength;
+}
+
+SharedTableBuffer *MessageTable::shareBuffer() {
+  // a private buffer stays private, such that the next write to this table does not copy it
+  if (sharedBuffer == NULL) return SharedTableStore::acquireCopy(buffer, bufferLength);
+  return SharedTableStore::retain(sharedBuffer);
+}
+
 float *MessageTable::resizeBuffer(int newBufferLength) {
-  if (newBufferLength > 0) {
+  if (newBufferLength > 0 && sharedBuffer != NULL) {
+    copySharedBuffer(newBufferLength);
+  } else if (newBufferLength > 0) {
     // the new buffer length must be positive
     buffer = (float *) realloc(buffer, newBufferLength * sizeof(float));
     if (newBufferLength > bufferLength) {
@@ -86,6 +126,8 @@ void MessageTable::processMessage(int inletIndex, PdMessage *message) {
   } else if (message->isSymbol(0, "write")) {
     // write the contents of the table to file
   } else if (message->isSymbol(0, "normalize")) {
+    int length = 0;
+    getWritableBuffer(&length); // the buffer is normalised in place
     // normalise the contents of the table to the given value. Default to 1.
     #if __APPLE__
     float sum = 0.0f;
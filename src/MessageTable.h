@@ -32,7 +32,14 @@
 
 #include "RemoteMessageReceiver.h"
 
-/** [table name] */
+struct SharedTableBuffer;
+
+/**
+ * [table name]
+ *
+ * The buffer of a table is either private, or references an immutable buffer of the
+ * <code>SharedTableStore</code>. A shared buffer is copied the first time that it would be written.
+ */
 class MessageTable : public RemoteMessageReceiver {
   
   public:
@@ -44,22 +51,47 @@ class MessageTable : public RemoteMessageReceiver {
     std::string toString();
     ObjectType getObjectType();
   
-    /** Get a pointer to the table's buffer. */
+    /** Get a pointer to the table's buffer. The buffer must not be written, as it may be shared. */
     float *getBuffer(int *bufferLength);
   
+    /** Get a pointer to the table's buffer for writing. A shared buffer is first copied. */
+    float *getWritableBuffer(int *bufferLength);
+  
     /**
      * Resize the table's buffer to the given buffer length. A pointer to the new buffer is returned.
      * If the size of the requested buffer is the same as the current size, then the current
-     * buffer is returned.
+     * buffer is returned. The returned buffer is always private.
      */
     float *resizeBuffer(int bufferLength);
   
+    /**
+     * Makes the table reference the given shared buffer, replacing its contents and length. The
+     * table takes over the reference.
+     */
+    void setSharedBuffer(SharedTableBuffer *sharedBuffer);
+  
+    /** Returns <code>true</code> if the table's buffer is currently shared. */
+    bool isShared() { return sharedBuffer != NULL; }
+  
+    /**
+     * Returns a new reference to the table's buffer in the <code>SharedTableStore</code>. If the
+     * buffer is private, a new anonymous buffer holding a copy of it is returned instead, and the
+     * table keeps its private buffer.
+     */
+    SharedTableBuffer *shareBuffer();
+  
   private:
     // tables can receive sent messages
     void processMessage(int inletIndex, PdMessage *message);
   
+    /** Replaces a shared buffer with a private copy of the given length. */
+    void copySharedBuffer(int newBufferLength);
+  
     float *buffer;
     int bufferLength;
+  
+    /** The referenced shared buffer, or <code>NULL</code> if the buffer is private. */
+    SharedTableBuffer *sharedBuffer;
 };
 
 inline const char *MessageTable::getObjectLabel() {
@@ -68,8 +68,10 @@ void MessageTableRead::processMessage(int inletIndex, PdMessage *message) {
     }
     case SYMBOL: {
       if (message->isSymbol(0, "set") && message->isSymbol(1)) {
-        free(name);
+        char *oldName = name;
         name = StaticUtils::copyString(message->getSymbol(1));
+        graph->renameTableReceiver(this, oldName);
+        free(oldName);
         table = graph->getTable(name);
       }
       break;
@@ -63,7 +63,7 @@ void MessageTableWrite::processMessage(int inletIndex, PdMessage *message) {
         case FLOAT: {
           if (table != NULL) {
             int bufferLength = 0;
-            float *buffer = table->getBuffer(&bufferLength);
+            float *buffer = table->getWritableBuffer(&bufferLength);
             if (index >= 0 && index < bufferLength) {
               buffer[index] = message->getFloat(0);
             }
@@ -72,8 +72,10 @@ void MessageTableWrite::processMessage(int inletIndex, PdMessage *message) {
         }
         case SYMBOL: {
           if (message->isSymbol(0, "set") && message->isSymbol(1)) {
-            free(name);
+            char *oldName = name;
             name = StaticUtils::copyString(message->getSymbol(1));
+            graph->renameTableReceiver(this, oldName);
+            free(oldName);
             table = graph->getTable(name);
           }
           break;
@@ -0,0 +1,145 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#ifndef _NAME_REGISTRY_H_
+#define _NAME_REGISTRY_H_
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+/**
+ * The FNV-1a hash of a name, by which names are hashed in a <code>NameRegistry</code> and symbols in
+ * an <code>AtomDispatchTable</code>. A <code>NULL</code> name is treated as the empty string.
+ */
+inline unsigned int hashName(const char *name) {
+  unsigned int hash = 2166136261u;
+  if (name != NULL) {
+    for (const unsigned char *c = (const unsigned char *) name; *c != '\0'; ++c) {
+      hash = (hash ^ *c) * 16777619u;
+    }
+  }
+  return hash;
+}
+
+/**
+ * A hashed multimap from names to objects, used by <code>PdContext</code> to find the tables,
+ * delaylines, send~s, catch~s and their receivers of a given name. Each name is hashed once and
+ * interned in the registry, such that registration and lookup take constant time on average
+ * instead of a scan over all registered objects. Interned names are never removed, so that the
+ * values registered under a name are stable for the lifetime of the registry.
+ */
+template <typename T>
+class NameRegistry {
+
+  public:
+    NameRegistry() {
+      buckets = std::vector<std::vector<Entry *> >(16);
+      numEntries = 0;
+    }
+
+    ~NameRegistry() {
+      for (unsigned int i = 0; i < buckets.size(); ++i) {
+        for (unsigned int j = 0; j < buckets[i].size(); ++j) {
+          delete buckets[i][j];
+        }
+      }
+    }
+
+    /** Registers a value under the given name. No duplicate check is made. */
+    void add(const char *name, T *value) {
+      getEntry(name, true)->values.push_back(value);
+    }
+
+    /**
+     * Removes a value from the given name. If the value is not registered under that name (e.g. the
+     * object has been renamed since it was registered) all names are searched.
+     */
+    void remove(const char *name, T *value) {
+      Entry *entry = getEntry(name, false);
+      if (entry != NULL && removeValue(entry, value)) return;
+      for (unsigned int i = 0; i < buckets.size(); ++i) {
+        for (unsigned int j = 0; j < buckets[i].size(); ++j) {
+          if (removeValue(buckets[i][j], value)) return;
+        }
+      }
+    }
+
+    /** Returns the first value registered under the given name, or <code>NULL</code>. */
+    T *get(const char *name) {
+      Entry *entry = getEntry(name, false);
+      return (entry == NULL || entry->values.empty()) ? NULL : entry->values.front();
+    }
+
+    /** Returns all values registered under the given name, or <code>NULL</code> if there are none. */
+    std::vector<T *> *getAll(const char *name) {
+      Entry *entry = getEntry(name, false);
+      return (entry == NULL || entry->values.empty()) ? NULL : &(entry->values);
+    }
+
+    /** Appends all registered values to the given vector, in no particular order. */
+    void getAllValues(std::vector<T *> &values) {
+      for (unsigned int i = 0; i < buckets.size(); ++i) {
+        for (unsigned int j = 0; j < buckets[i].size(); ++j) {
+          values.insert(values.end(), buckets[i][j]->values.begin(), buckets[i][j]->values.end());
+        }
+      }
+    }
+
+  private:
+    typedef struct Entry {
+      unsigned int hash;
+      std::string name;
+      std::vector<T *> values;
+    } Entry;
+
+    Entry *getEntry(const char *name, bool shouldCreate) {
+      const char *key = (name == NULL) ? "" : name;
+      unsigned int hash = hashName(key);
+      std::vector<Entry *> &bucket = buckets[hash & (buckets.size()-1)];
+      for (unsigned int i = 0; i < bucket.size(); ++i) {
+        if (bucket[i]->hash == hash && !strcmp(bucket[i]->name.c_str(), key)) return bucket[i];
+      }
+      if (!shouldCreate) return NULL;
+
+      Entry *entry = new Entry();
+      entry->hash = hash;
+      entry->name = std::string(key);
+      bucket.push_back(entry);
+      if (++numEntries > buckets.size()) grow();
+      return entry;
+    }
+
+    static bool removeValue(Entry *entry, T *value) {
+      for (unsigned int i = 0; i < entry->values.size(); ++i) {
+        if (entry->values[i] == value) {
+          entry->values.erase(entry->values.begin() + i);
+          return true;
+        }
+      }
+      return false;
+    }
+
+    /** Doubles the number of buckets, keeping the load factor at or below one. */
+    void grow() {
+      std::vector<std::vector<Entry *> > newBuckets(buckets.size() * 2);
+      for (unsigned int i = 0; i < buckets.size(); ++i) {
+        for (unsigned int j = 0; j < buckets[i].size(); ++j) {
+          Entry *entry = buckets[i][j];
+          newBuckets[entry->hash & (newBuckets.size()-1)].push_back(entry);
+        }
+      }
+      buckets.swap(newBuckets);
+    }
+
+    /** The number of buckets is always a power of two. */
+    std::vector<std::vector<Entry *> > buckets;
+
+    unsigned int numEntries;
+};
+
+#endif // _NAME_REGISTRY_H_
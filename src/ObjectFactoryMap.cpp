@@ -35,10 +35,12 @@
 #include "MessageArcTangent.h"
 #include "MessageArcTangent2.h"
 #include "MessageBang.h"
+#include "MessageBendin.h"
 #include "MessageCosine.h"
 #include "MessageCputime.h"
 #include "MessageChange.h"
 #include "MessageClip.h"
+#include "MessageCtlin.h"
 #include "MessageCputime.h"
 #include "MessageDeclare.h"
 #include "MessageDelay.h"
@@ -156,6 +158,7 @@
 #include "DspVariableLine.h"
 #include "DspVCF.h"
 #include "DspWrap.h"
+#include "PdClone.h"
 
 ObjectFactoryMap::ObjectFactoryMap() {
   // these objects represent the core set of supported objects
@@ -168,10 +171,12 @@ ObjectFactoryMap::ObjectFactoryMap() {
   objectFactoryMap[string(MessageBang::getObjectLabel())] = &MessageBang::newObject;
   objectFactoryMap[string("bng")] = &MessageBang::newObject;
   objectFactoryMap[string("b")] = &MessageBang::newObject;
+  objectFactoryMap[string(MessageBendin::getObjectLabel())] = &MessageBendin::newObject;
   objectFactoryMap[string(MessageChange::getObjectLabel())] = &MessageChange::newObject;
   objectFactoryMap[string(MessageClip::getObjectLabel())] = &MessageClip::newObject;
   objectFactoryMap[string(MessageCosine::getObjectLabel())] = &MessageCosine::newObject;
   objectFactoryMap[string(MessageCputime::getObjectLabel())] = &MessageCputime::newObject;
+  objectFactoryMap[string(MessageCtlin::getObjectLabel())] = &MessageCtlin::newObject;
   objectFactoryMap[string(MessageDbToPow::getObjectLabel())] = &MessageDbToPow::newObject;
   objectFactoryMap[string(MessageDbToRms::getObjectLabel())] = &MessageDbToRms::newObject;
   objectFactoryMap[string(MessageDeclare::getObjectLabel())] = &MessageDeclare::newObject;
@@ -298,7 +303,11 @@ ObjectFactoryMap::ObjectFactoryMap() {
   objectFactoryMap[string(DspThrow::getObjectLabel())] = &DspThrow::newObject;
   objectFactoryMap[string(DspVariableDelay::getObjectLabel())] = &DspVariableDelay::newObject;
   objectFactoryMap[string(DspVariableLine::getObjectLabel())] = &DspVariableLine::newObject;
+  objectFactoryMap[string(DspVCF::getObjectLabel())] = &DspVCF::newObject;
   objectFactoryMap[string(DspWrap::getObjectLabel())] = &DspWrap::newObject;
+  
+  // graph objects
+  objectFactoryMap[string(PdClone::getObjectLabel())] = &PdClone::newObject;
 }
 
 ObjectFactoryMap::~ObjectFactoryMap() {
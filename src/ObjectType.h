@@ -50,6 +50,8 @@ enum ObjectType {
   DSP_TABLE_READ4,
   DSP_THROW,
   DSP_VARIABLE_DELAY,
+  MESSAGE_BENDIN,
+  MESSAGE_CTLIN,
   MESSAGE_INLET,
   MESSAGE_NOTEIN,
   MESSAGE_OUTLET,
@@ -0,0 +1,147 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#include <string.h>
+#include <utility>
+#include "OutboundMessageQueue.h"
+
+/*
+ * A record consists of its size in bytes (excluding the size itself) followed by a
+ * ZGCallbackFunction byte. Print records then contain the string, including its terminator.
+ * Receiver message records contain the timestamp, the number of elements and the receiver name,
+ * followed by each element as a type byte and either a float or a terminated string.
+ */
+
+OutboundMessageQueue::OutboundMessageQueue(unsigned int numBytes) : ring(numBytes) {
+  numDropped = 0;
+}
+
+OutboundMessageQueue::~OutboundMessageQueue() {
+  // nothing to do
+}
+
+bool OutboundMessageQueue::pushRecord(char *record, unsigned int numBytes) {
+  if (ring.getNumFree() < numBytes) {
+    numDropped++;
+    return false;
+  }
+  // the whole record is published at once, so the consumer never sees a partial one
+  ring.write(record, numBytes);
+  return true;
+}
+
+bool OutboundMessageQueue::pushString(ZGCallbackFunction function, const char *string) {
+  char record[OUTBOUND_MAX_RECORD_SIZE];
+  unsigned int length = strlen(string) + 1;
+  unsigned int size = 1 + length;
+  if (sizeof(unsigned int) + size > sizeof(record)) {
+    numDropped++;
+    return false;
+  }
+  memcpy(record, &size, sizeof(unsigned int));
+  record[sizeof(unsigned int)] = (char) function;
+  memcpy(record + sizeof(unsigned int) + 1, string, length);
+  return pushRecord(record, sizeof(unsigned int) + size);
+}
+
+bool OutboundMessageQueue::pushReceiverMessage(const char *receiverName, PdMessage *message) {
+  char record[OUTBOUND_MAX_RECORD_SIZE];
+  char *end = record + sizeof(record);
+  char *pos = record + sizeof(unsigned int);
+
+  unsigned int numElements = message->getNumElements();
+  double timestamp = message->getTimestamp();
+  unsigned int nameLength = strlen(receiverName) + 1;
+  if (pos + 1 + sizeof(double) + sizeof(unsigned int) + nameLength > end) {
+    numDropped++;
+    return false;
+  }
+  *pos++ = (char) ZG_RECEIVER_MESSAGE;
+  memcpy(pos, &timestamp, sizeof(double)); pos += sizeof(double);
+  memcpy(pos, &numElements, sizeof(unsigned int)); pos += sizeof(unsigned int);
+  memcpy(pos, receiverName, nameLength); pos += nameLength;
+
+  for (unsigned int i = 0; i < numElements; i++) {
+    MessageElementType type = message->getType(i);
+    if (pos + 1 > end) { numDropped++; return false; }
+    *pos++ = (char) type;
+    switch (type) {
+      case FLOAT: {
+        if (pos + sizeof(float) > end) { numDropped++; return false; }
+        float f = message->getFloat(i);
+        memcpy(pos, &f, sizeof(float)); pos += sizeof(float);
+        break;
+      }
+      case SYMBOL: {
+        unsigned int length = strlen(message->getSymbol(i)) + 1;
+        if (pos + length > end) { numDropped++; return false; }
+        memcpy(pos, message->getSymbol(i), length); pos += length;
+        break;
+      }
+      default: break;
+    }
+  }
+
+  unsigned int size = (pos - record) - sizeof(unsigned int);
+  memcpy(record, &size, sizeof(unsigned int));
+  return pushRecord(record, pos - record);
+}
+
+unsigned int OutboundMessageQueue::poll(void *(*callbackFunction)(ZGCallbackFunction, void *, void *),
+    void *userData) {
+  char record[OUTBOUND_MAX_RECORD_SIZE];
+  unsigned int numRecords = 0;
+  unsigned int size = 0;
+  while (ring.read((char *) &size, sizeof(unsigned int)) == sizeof(unsigned int)) {
+    // a record is published as a whole, so once its size is visible so is the rest of it
+    ring.read(record, size);
+    numRecords++;
+    if (callbackFunction == NULL) continue;
+
+    ZGCallbackFunction function = (ZGCallbackFunction) record[0];
+    char *pos = record + 1;
+    switch (function) {
+      case ZG_RECEIVER_MESSAGE: {
+        double timestamp = 0.0;
+        unsigned int numElements = 0;
+        memcpy(&timestamp, pos, sizeof(double)); pos += sizeof(double);
+        memcpy(&numElements, pos, sizeof(unsigned int)); pos += sizeof(unsigned int);
+        const char *receiverName = pos; pos += strlen(pos) + 1;
+
+        PdMessage *message = PD_MESSAGE_ON_STACK(numElements);
+        message->initWithTimestampAndNumElements(timestamp, numElements);
+        for (unsigned int i = 0; i < numElements; i++) {
+          switch ((MessageElementType) *pos++) {
+            case FLOAT: {
+              float f = 0.0f;
+              memcpy(&f, pos, sizeof(float)); pos += sizeof(float);
+              message->setFloat(i, f);
+              break;
+            }
+            case SYMBOL: {
+              message->setSymbol(i, pos); // the symbol points into the record
+              pos += strlen(pos) + 1;
+              break;
+            }
+            default: {
+              message->setBang(i);
+              break;
+            }
+          }
+        }
+        std::pair<const char *, PdMessage *> pair = std::make_pair(receiverName, message);
+        callbackFunction(ZG_RECEIVER_MESSAGE, userData, &pair);
+        break;
+      }
+      default: {
+        callbackFunction(function, userData, pos);
+        break;
+      }
+    }
+  }
+  return numRecords;
+}
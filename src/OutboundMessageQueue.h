@@ -0,0 +1,61 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#ifndef _OUTBOUND_MESSAGE_QUEUE_H_
+#define _OUTBOUND_MESSAGE_QUEUE_H_
+
+#include "PdMessage.h"
+#include "SpscRingBuffer.h"
+#include "ZGCallbackFunction.h"
+
+/** The largest serialised record, in bytes. Larger messages are dropped. */
+#define OUTBOUND_MAX_RECORD_SIZE 2048
+
+/**
+ * Carries messages to external receivers and print output from the audio thread to the host.
+ * Records are serialised into a preallocated lock-free ring by the audio thread and delivered to
+ * the context's callback function by whichever thread calls <code>poll()</code>. If the ring is
+ * full, the record is dropped and counted, such that a slow host never blocks the audio thread.
+ */
+class OutboundMessageQueue {
+
+  public:
+    OutboundMessageQueue(unsigned int numBytes);
+    ~OutboundMessageQueue();
+
+    /**
+     * Queues a message sent to an external receiver. Returns <code>false</code> if it has been
+     * dropped. May only be called from the producer thread.
+     */
+    bool pushReceiverMessage(const char *receiverName, PdMessage *message);
+
+    /**
+     * Queues a string for <code>ZG_PRINT_STD</code> or <code>ZG_PRINT_ERR</code>. Returns
+     * <code>false</code> if it has been dropped. May only be called from the producer thread.
+     */
+    bool pushString(ZGCallbackFunction function, const char *string);
+
+    /**
+     * Delivers all queued records to the callback function, in the form in which it would have
+     * received them directly. Returns the number of records delivered. May only be called from
+     * the consumer thread.
+     */
+    unsigned int poll(void *(*callbackFunction)(ZGCallbackFunction, void *, void *), void *userData);
+
+    /** Returns the number of records which have been dropped because the queue was full. */
+    unsigned int getNumDropped() { return numDropped; }
+
+  private:
+    /** Writes a serialised record into the ring if it fits completely. */
+    bool pushRecord(char *record, unsigned int numBytes);
+
+    SpscRingBuffer<char> ring;
+
+    volatile unsigned int numDropped;
+};
+
+#endif // _OUTBOUND_MESSAGE_QUEUE_H_
@@ -0,0 +1,324 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#include <algorithm>
+#include <sstream>
+#include "BufferPool.h"
+#include "DspInlet.h"
+#include "DspOutlet.h"
+#include "DspProfiler.h"
+#include "MessageInlet.h"
+#include "MessageOutlet.h"
+#include "PdClone.h"
+#include "PdContext.h"
+#include "PdFileParser.h"
+
+
+#pragma mark - CloneInletRouter
+
+/**
+ * Distributes the messages arriving at a message inlet of a [clone] to the instances. Outlet i
+ * is connected to instance i.
+ */
+class CloneInletRouter : public MessageObject {
+
+  public:
+    CloneInletRouter(int numInstances, int startIndex, PdGraph *graph) :
+        MessageObject(1, numInstances, graph) {
+      this->startIndex = startIndex;
+    }
+
+    string toString() { return string("clone inlet"); }
+
+  private:
+    void processMessage(int inletIndex, PdMessage *message) {
+      int numElements = message->getNumElements() - 1;
+      if (message->isSymbol(0, "all")) {
+        PdMessage *outgoingMessage = PD_MESSAGE_ON_STACK(numElements);
+        initWithRemainder(outgoingMessage, message);
+        for (unsigned int i = 0; i < getNumOutlets(); i++) {
+          sendMessage(i, outgoingMessage);
+        }
+      } else if (message->isFloat(0)) {
+        int outletIndex = ((int) message->getFloat(0)) - startIndex;
+        if (outletIndex >= 0 && (unsigned int) outletIndex < getNumOutlets()) {
+          PdMessage *outgoingMessage = PD_MESSAGE_ON_STACK(numElements);
+          initWithRemainder(outgoingMessage, message);
+          sendMessage(outletIndex, outgoingMessage);
+        } else {
+          graph->printErr("clone: instance %i does not exist.", outletIndex + startIndex);
+        }
+      } else {
+        graph->printErr("clone: messages must begin with an instance index or \"all\".");
+      }
+    }
+
+    /** The outgoing message is the incoming one without its first element, or a bang if empty. */
+    static void initWithRemainder(PdMessage *outgoingMessage, PdMessage *message) {
+      int numElements = message->getNumElements() - 1;
+      if (numElements > 0) {
+        outgoingMessage->initWithTimestampAndNumElements(message->getTimestamp(), numElements);
+        memcpy(outgoingMessage->getElement(0), message->getElement(1), numElements*sizeof(MessageAtom));
+      } else {
+        outgoingMessage->initWithTimestampAndBang(message->getTimestamp());
+      }
+    }
+
+    int startIndex;
+};
+
+
+#pragma mark - CloneOutletMerger
+
+/**
+ * Merges the messages sent from one message outlet of all instances of a [clone], prefixing them
+ * with the index of the sending instance. Inlet i is connected to instance i.
+ */
+class CloneOutletMerger : public MessageObject {
+
+  public:
+    CloneOutletMerger(int numInstances, int startIndex, PdGraph *graph) :
+        MessageObject(numInstances, 1, graph) {
+      this->startIndex = startIndex;
+    }
+
+    string toString() { return string("clone outlet"); }
+
+  private:
+    void processMessage(int inletIndex, PdMessage *message) {
+      // a bang is sent on as the instance index alone
+      int numElements = message->isBang(0) ? 0 : message->getNumElements();
+      PdMessage *outgoingMessage = PD_MESSAGE_ON_STACK(numElements+1);
+      outgoingMessage->initWithTimestampAndNumElements(message->getTimestamp(), numElements+1);
+      outgoingMessage->setFloat(0, (float) (inletIndex + startIndex));
+      memcpy(outgoingMessage->getElement(1), message->getElement(0), numElements*sizeof(MessageAtom));
+      sendMessage(0, outgoingMessage);
+    }
+
+    int startIndex;
+};
+
+
+#pragma mark - PdClone
+
+MessageObject *PdClone::newObject(PdMessage *initMessage, PdGraph *graph) {
+  PdClone *clone = new PdClone(initMessage, graph);
+  if (clone->instances.empty()) {
+    // the reason has been reported, and the object is not created
+    delete clone;
+    return NULL;
+  }
+  return clone;
+}
+
+// the container shares the graph id of its parent, such that it is transparent like a subpatch
+PdClone::PdClone(PdMessage *initMessage, PdGraph *graph) :
+    PdGraph(initMessage, graph, graph->getContext(), graph->getGraphId(), "clone") {
+  processFunction = &processClone;
+  isLockstep = false;
+  startIndex = 0;
+  int argIndex = 0;
+  if (initMessage->isSymbol(0, "-s") && initMessage->isFloat(1)) {
+    startIndex = (int) initMessage->getFloat(1);
+    argIndex = 2;
+  }
+  if (!initMessage->isSymbol(argIndex) || !initMessage->isFloat(argIndex+1) ||
+      initMessage->getFloat(argIndex+1) < 1.0f) {
+    graph->printErr("clone: expected the arguments [-s start] name n, with n at least 1.");
+    return;
+  }
+  abstractionName = string(initMessage->getSymbol(argIndex));
+  int numInstances = (int) initMessage->getFloat(argIndex+1);
+
+  // the abstraction is read only once and instantiated from the parsed description
+  PdContext *context = graph->getContext();
+  PdFileParser *parser = context->getAbstractionTemplate(abstractionName.c_str(), graph);
+  if (parser == NULL) {
+    graph->printErr("clone: cannot find abstraction '%s'.", abstractionName.c_str());
+    return;
+  }
+
+  // instance arguments are [index, args...]
+  int numArguments = initMessage->getNumElements() - (argIndex+2);
+  PdMessage *instanceArguments = PD_MESSAGE_ON_STACK(numArguments+1);
+  instanceArguments->initWithTimestampAndNumElements(0.0, numArguments+1);
+  memcpy(instanceArguments->getElement(1), initMessage->getElement(argIndex+2),
+      numArguments*sizeof(MessageAtom));
+  for (int i = 0; i < numInstances; i++) {
+    instanceArguments->setFloat(0, (float) (i + startIndex));
+    PdGraph *instance = parser->executeAbstraction(instanceArguments, this, context);
+    if (instance == NULL) {
+      // the instances already created are nodes of this graph and are deleted with it
+      graph->printErr("clone: abstraction '%s' could not be instantiated.", abstractionName.c_str());
+      instances.clear();
+      return;
+    }
+    instances.push_back(instance);
+  }
+
+  connectInstances();
+}
+
+PdClone::~PdClone() {
+  // instances and lets are nodes of this graph and are deleted with it
+}
+
+string PdClone::toString() {
+  std::ostringstream out;
+  out << getObjectLabel() << " " << abstractionName << " " << instances.size();
+  return out.str();
+}
+
+void PdClone::connectInstances() {
+  if (instances.empty()) return;
+  PdGraph *firstInstance = instances.front();
+  PdMessage *initMessage = PD_MESSAGE_ON_STACK(0);
+  initMessage->initWithTimestampAndNumElements(0.0, 0);
+
+  for (int i = 0; i < (int) firstInstance->getNumInlets(); i++) {
+    if (firstInstance->getInletConnectionType(i) == DSP) {
+      DspInlet *inlet = new DspInlet(this);
+      addObject((float) i, 0.0f, inlet);
+      for (int j = 0; j < (int) instances.size(); j++) {
+        addConnection(inlet, 0, instances[j], i);
+      }
+    } else {
+      MessageInlet *inlet = new MessageInlet(this);
+      addObject((float) i, 0.0f, inlet);
+      CloneInletRouter *router = new CloneInletRouter((int) instances.size(), startIndex, this);
+      addObject((float) i, 0.0f, router);
+      addConnection(inlet, 0, router, 0);
+      for (int j = 0; j < (int) instances.size(); j++) {
+        addConnection(router, j, instances[j], i);
+      }
+    }
+  }
+
+  for (int i = 0; i < (int) firstInstance->getNumOutlets(); i++) {
+    if (firstInstance->getConnectionType(i) == DSP) {
+      // the fan-in of all instances is summed by the implicit [+~]
+      DspOutlet *outlet = new DspOutlet(this);
+      addObject((float) i, 0.0f, outlet);
+      for (int j = 0; j < (int) instances.size(); j++) {
+        addConnection(instances[j], i, outlet, 0);
+      }
+    } else {
+      MessageOutlet *outlet = new MessageOutlet(initMessage, this);
+      addObject((float) i, 0.0f, outlet);
+      CloneOutletMerger *merger = new CloneOutletMerger((int) instances.size(), startIndex, this);
+      addObject((float) i, 0.0f, merger);
+      addConnection(merger, 0, outlet, 0);
+      for (int j = 0; j < (int) instances.size(); j++) {
+        addConnection(instances[j], i, merger, j);
+      }
+    }
+  }
+}
+
+
+#pragma mark - Process Order
+
+list<DspObject *> PdClone::getFirstProcessOrder() {
+  // The buffers released by one instance are not reused by the next one, such that the objects of
+  // all instances may be interleaved. Whatever reads the instance outlets is ordered afterwards.
+  BufferPool *bufferPool = getBufferPool();
+  bufferPool->beginDeferredRelease();
+  list<DspObject *> processOrder;
+  for (unsigned int i = 0; i < instances.size(); i++) {
+    list<DspObject *> instanceProcessOrder = instances[i]->getProcessOrder();
+    processOrder.splice(processOrder.end(), instanceProcessOrder);
+  }
+  bufferPool->endDeferredRelease();
+  return processOrder;
+}
+
+void PdClone::onProcessOrderComputed() {
+  isLockstep = false;
+  cloneNodeList.clear();
+  dspInstances.clear();
+  lockstepNodeList.clear();
+
+  // the dsp instances must be contiguous in the process order, and are replaced by one NULL entry
+  list<DspObject *> processOrder = getDspNodeList();
+  bool isContiguous = true;
+  for (list<DspObject *>::iterator it = processOrder.begin(); it != processOrder.end(); ++it) {
+    DspObject *dspObject = *it;
+    if (std::find(instances.begin(), instances.end(), dspObject) != instances.end()) {
+      if (dspInstances.empty()) {
+        cloneNodeList.push_back(NULL);
+      } else if (cloneNodeList.back() != NULL) {
+        isContiguous = false;
+      }
+      dspInstances.push_back(reinterpret_cast<PdGraph *>(dspObject));
+    } else {
+      cloneNodeList.push_back(dspObject);
+    }
+  }
+  if (!isContiguous || dspInstances.size() < 2) return;
+
+  // the process orders of all dsp instances must be of equal length
+  vector<list<DspObject *> > instanceNodeLists(dspInstances.size());
+  for (unsigned int i = 0; i < dspInstances.size(); i++) {
+    instanceNodeLists[i] = dspInstances[i]->getDspNodeList();
+    if (instanceNodeLists[i].size() != instanceNodeLists[0].size()) return;
+  }
+
+  unsigned int numInstances = dspInstances.size();
+  lockstepNodeList.resize(instanceNodeLists[0].size() * numInstances);
+  for (unsigned int i = 0; i < numInstances; i++) {
+    unsigned int k = 0;
+    for (list<DspObject *>::iterator it = instanceNodeLists[i].begin();
+        it != instanceNodeLists[i].end(); ++it, ++k) {
+      lockstepNodeList[k*numInstances + i] = *it;
+    }
+  }
+  isInstanceActive.assign(numInstances, false);
+  isLockstep = true;
+}
+
+
+#pragma mark - Process
+
+void PdClone::processClone(DspObject *dspObject, int fromIndex, int toIndex) {
+  PdClone *d = reinterpret_cast<PdClone *>(dspObject);
+
+  // objects are profiled one at a time
+  if (!d->isLockstep || d->getContext()->getProfiler()->isEnabled()) {
+    processGraph(dspObject, fromIndex, toIndex);
+    return;
+  }
+
+  if (d->beginBlock(toIndex)) {
+    for (unsigned int i = 0; i < d->cloneNodeList.size(); i++) {
+      DspObject *node = d->cloneNodeList[i];
+      if (node == NULL) {
+        d->processInstances(toIndex);
+      } else {
+        node->processFunction(node, 0, d->blockSizeInt);
+      }
+    }
+    d->endBlock();
+  }
+}
+
+void PdClone::processInstances(int toIndex) {
+  unsigned int numInstances = dspInstances.size();
+  for (unsigned int i = 0; i < numInstances; i++) {
+    isInstanceActive[i] = dspInstances[i]->beginBlock(toIndex);
+  }
+  for (unsigned int k = 0; k < lockstepNodeList.size(); k += numInstances) {
+    for (unsigned int i = 0; i < numInstances; i++) {
+      if (isInstanceActive[i]) {
+        DspObject *node = lockstepNodeList[k+i];
+        node->processFunction(node, 0, blockSizeInt);
+      }
+    }
+  }
+  for (unsigned int i = 0; i < numInstances; i++) {
+    if (isInstanceActive[i]) dspInstances[i]->endBlock();
+  }
+}
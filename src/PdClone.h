@@ -0,0 +1,95 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#ifndef _PD_CLONE_H_
+#define _PD_CLONE_H_
+
+#include "PdGraph.h"
+
+/**
+ * [clone [-s start] name n args...]
+ *
+ * Loads n instances of the abstraction <code>name</code> into one container graph. Instance i is
+ * created with the arguments <code>[i+start, args...]</code>, with <code>start</code> defaulting to
+ * zero. The abstraction file is read only once and is instantiated n times from memory.
+ *
+ * Signal inlets are broadcast to all instances and signal outlets are summed over all instances.
+ * A message to a message inlet must begin with an instance index (which is removed), or with
+ * <code>all</code> in order to be sent to every instance. Messages from a message outlet are
+ * prefixed with the index of the instance which sent them. Each instance is a graph of its own,
+ * and so goes to sleep independently of the others when it is silent.
+ *
+ * The instances are processed in lockstep: the k-th object of every awake instance is processed
+ * before the (k+1)-th object of any, such that the same object code runs over all voices in turn.
+ * The process orders of the instances are kept side by side in one position-major table, and the
+ * instances are ordered from distinct buffers so that they may be interleaved in this way.
+ */
+class PdClone : public PdGraph {
+
+  public:
+    static MessageObject *newObject(PdMessage *initMessage, PdGraph *graph);
+    PdClone(PdMessage *initMessage, PdGraph *graph);
+    ~PdClone();
+
+    static const char *getObjectLabel();
+    string toString();
+
+    /** Returns the number of instances of the abstraction. */
+    int getNumInstances();
+
+  protected:
+    /** All instances are ordered first, such that they never share a buffer. */
+    list<DspObject *> getFirstProcessOrder();
+  
+    /** Builds the lockstep process order from the process orders of the instances. */
+    void onProcessOrderComputed();
+  
+  private:
+    static void processClone(DspObject *dspObject, int fromIndex, int toIndex);
+  
+    /** Processes all awake instances in lockstep. */
+    void processInstances(int toIndex);
+  
+    /** Creates the container inlets and outlets according to those of the first instance. */
+    void connectInstances();
+
+    /** The instances, in order of their index. */
+    vector<PdGraph *> instances;
+
+    string abstractionName;
+
+    /** The index of the first instance. */
+    int startIndex;
+  
+    /**
+     * True if the instances are processed in lockstep. This requires their process orders to be
+     * of equal length and contiguous in the process order of this graph.
+     */
+    bool isLockstep;
+  
+    /** The process order of this graph, with <code>NULL</code> in place of all instances. */
+    vector<DspObject *> cloneNodeList;
+  
+    /** The instances which process audio, in order of their index. */
+    vector<PdGraph *> dspInstances;
+  
+    /** The process orders of all dsp instances. Object k of instance i is at k*n+i. */
+    vector<DspObject *> lockstepNodeList;
+  
+    /** True for each dsp instance which is processed in the current block. */
+    vector<bool> isInstanceActive;
+};
+
+inline const char *PdClone::getObjectLabel() {
+  return "clone";
+}
+
+inline int PdClone::getNumInstances() {
+  return (int) instances.size();
+}
+
+#endif // _PD_CLONE_H_
@@ -29,13 +29,17 @@
 
 #include "AudioBinaryFile.h"
 #include "BufferPool.h"
+#include "DspProfiler.h"
 #include "MessageSendController.h"
 #include "ObjectFactoryMap.h"
 #include "PdAbstractionDataBase.h"
 #include "PdContext.h"
 #include "PdFileParser.h"
+#include "SampleConversion.h"
+#include "SharedTableStore.h"
 
 #include "DelayReceiver.h"
+#include "DspAdc.h"
 #include "DspCatch.h"
 #include "DspDelayWrite.h"
 #include "DspReceive.h"
@@ -63,6 +67,14 @@ PdContext::PdContext(int numInputChannels, int numOutputChannels, int blockSize,
   objectFactoryMap = new ObjectFactoryMap();
   globalGraphId = 0;
   bufferPool = new BufferPool(blockSize);
+  profiler = new DspProfiler();
+  isDitherEnabled = false;
+  isInputBindingEnabled = false;
+  controlGranularity = 1;
+  ditherSeed = 1;
+  isProcessOrderValid = true;
+  hasStaleSilenceMaps = false;
+  lockDepth = 0;
   audioBinaryFile = NULL;
   
   numBytesInInputBuffers = blockSize * numInputChannels * sizeof(float);
@@ -72,7 +84,24 @@ PdContext::PdContext(int numInputChannels, int numOutputChannels, int blockSize,
   globalDspOutputBuffers = (numBytesInOutputBuffers > 0) ? ALLOC_ALIGNED_BUFFER(numBytesInOutputBuffers) : NULL;
   memset(globalDspOutputBuffers, 0, numBytesInOutputBuffers);
   
+  // the channels are initially bound to the global buffers
+  inputChannelBuffers = (float **) calloc(numInputChannels+1, sizeof(float *));
+  hostInputBuffers = (float **) calloc(numInputChannels+1, sizeof(float *));
+  outputChannelBuffers = (float **) calloc(numOutputChannels+1, sizeof(float *));
+  hostOutputBuffers = (float **) calloc(numOutputChannels+1, sizeof(float *));
+  bindChannelBuffers(NULL, NULL);
+  
   sendController = new MessageSendController(this);
+  outboundQueue = NULL;
+  pthread_mutex_init(&outboundConsumerLock, NULL);
+  isProcessingBlock = false;
+  processingThread = pthread_self();
+  midiEventQueue = new SpscRingBuffer<ZGMidiEvent>(1024);
+  midiEvents.resize(midiEventQueue->getCapacity());
+  midiMergeEvents.resize(midiEventQueue->getCapacity());
+  pthread_mutex_init(&midiProducerLock, NULL);
+  numMidiEvents = 0;
+  isMidiNameIndexValid = false;
 
   abstractionDatabase = new PdAbstractionDataBase();
   
@@ -86,11 +115,18 @@ PdContext::PdContext(int numInputChannels, int numOutputChannels, int blockSize,
 PdContext::~PdContext() {
   FREE_ALIGNED_BUFFER(globalDspInputBuffers);
   FREE_ALIGNED_BUFFER(globalDspOutputBuffers);
+  free(inputChannelBuffers);
+  free(hostInputBuffers);
+  free(outputChannelBuffers);
+  free(hostOutputBuffers);
   
   delete messageCallbackQueue;
   delete sendController;
+  delete midiEventQueue;
+  delete outboundQueue;
   delete objectFactoryMap;
   delete bufferPool;
+  delete profiler;
   
   // delete all of the PdGraphs in the graph list
   for (int i = 0; i < graphList.size(); i++) {
@@ -99,14 +135,96 @@ PdContext::~PdContext() {
 
   delete abstractionDatabase;
 
+  clearAbstractionTemplates();
+
   if (audioBinaryFile) {
     delete audioBinaryFile;
   }
 
+  pthread_mutex_destroy(&midiProducerLock);
+  pthread_mutex_destroy(&outboundConsumerLock);
   pthread_mutex_destroy(&contextLock);
 }
 
 
+#pragma mark - Clone
+
+PdContext *PdContext::clone() {
+  PdContext *context = new PdContext(numInputChannels, numOutputChannels, blockSize, sampleRate,
+      callbackFunction, callbackUserData);
+  
+  // only take a snapshot of this context while it is locked, such that its audio thread is not
+  // stalled while the graphs of the new context are instantiated
+  lock();
+  *(context->objectFactoryMap) = *objectFactoryMap;
+  *(context->abstractionDatabase) = *abstractionDatabase;
+  // the parsed descriptions are immutable and are shared with the new context
+  for (map<string,PdFileParser *>::iterator it = databaseTemplateMap.begin();
+      it != databaseTemplateMap.end(); ++it) {
+    context->databaseTemplateMap[it->first] = it->second->retain();
+  }
+  for (map<string,PdFileParser *>::iterator it = fileTemplateMap.begin();
+      it != fileTemplateMap.end(); ++it) {
+    context->fileTemplateMap[it->first] = it->second->retain();
+  }
+  context->filePathMap = filePathMap;
+  const set<string> &externalReceivers = sendController->getExternalReceivers();
+  for (set<string>::const_iterator it = externalReceivers.begin(); it != externalReceivers.end(); ++it) {
+    context->sendController->registerExternalReceiver(it->c_str());
+  }
+  context->isDitherEnabled = isDitherEnabled;
+  context->isInputBindingEnabled = isInputBindingEnabled;
+  context->profiler->setEnabled(profiler->isEnabled());
+  string binaryFilePath = (audioBinaryFile != NULL) ? audioBinaryFilePath : string();
+  
+  vector<PdFileParser *> descriptions;
+  for (int i = 0; i < graphList.size(); i++) {
+    PdFileParser *description = graphList[i]->getDescription();
+    if (description != NULL) descriptions.push_back(description->retain());
+  }
+  int numUnclonedGraphs = graphList.size() - descriptions.size();
+  
+  // the contents of the tables are given to the new context by reference if they are already shared,
+  // and otherwise as a copy. The tables of this context are left as they are
+  vector<MessageTable *> tables;
+  tableRegistry.getAllValues(tables);
+  vector<pair<string,SharedTableBuffer *> > sharedTables;
+  for (unsigned int i = 0; i < tables.size(); i++) {
+    if (tables[i]->getName() != NULL) {
+      sharedTables.push_back(make_pair(string(tables[i]->getName()), tables[i]->shareBuffer()));
+    }
+  }
+  unlock();
+  
+  if (!binaryFilePath.empty()) context->registerAudioBinaryFile(binaryFilePath);
+  if (numUnclonedGraphs > 0) {
+    printErr("A graph which was not created from a file or string cannot be cloned.");
+  }
+  
+  // create the attached graphs again, in order
+  for (unsigned int i = 0; i < descriptions.size(); i++) {
+    PdGraph *graph = descriptions[i]->execute(context);
+    if (graph != NULL) {
+      graph->setDescription(descriptions[i]);
+      context->attachGraph(graph);
+    } else {
+      PdFileParser::release(descriptions[i]);
+    }
+  }
+  for (unsigned int i = 0; i < sharedTables.size(); i++) {
+    MessageTable *table = context->getTable(sharedTables[i].first.c_str());
+    if (table != NULL) {
+      table->setSharedBuffer(sharedTables[i].second);
+    } else {
+      SharedTableStore::release(sharedTables[i].second);
+    }
+  }
+  context->updateProcessOrder(); // the new context is ready to process its first block
+  
+  return context;
+}
+
+
 #pragma mark - External Object Management
 
 void PdContext::registerExternalObject(const char *objectLabel,
@@ -138,11 +256,11 @@ float PdContext::getSampleRate() {
 }
 
 float *PdContext::getGlobalDspBufferAtInlet(int inletIndex) {
-  return globalDspInputBuffers + (inletIndex * blockSize);
+  return inputChannelBuffers[inletIndex];
 }
 
 float *PdContext::getGlobalDspBufferAtOutlet(int outletIndex) {
-  return globalDspOutputBuffers + (outletIndex * blockSize);
+  return outputChannelBuffers[outletIndex];
 }
 
 double PdContext::getBlockStartTimestamp() {
@@ -161,58 +279,273 @@ int PdContext::getNextGraphId() {
 #pragma mark - process
 
 void PdContext::process(float *inputBuffers, float *outputBuffers) {
+  // the channels are consecutive in the given buffers
+  float *inputChannels[numInputChannels+1];
+  for (int i = 0; i < numInputChannels; i++) inputChannels[i] = inputBuffers + (i * blockSize);
+  float *outputChannels[numOutputChannels+1];
+  for (int i = 0; i < numOutputChannels; i++) outputChannels[i] = outputBuffers + (i * blockSize);
+  
+  processChannels(inputChannels, outputChannels);
+}
+
+void PdContext::processChannels(float **inputBuffers, float **outputBuffers) {
   lock(); // lock the context
   
+  bindChannelBuffers(inputBuffers, outputBuffers);
+  
+  // set up the adc~ buffers of channels which are not bound to the given buffers
+  for (int i = 0; i < numInputChannels; i++) {
+    if (inputChannelBuffers[i] != inputBuffers[i]) {
+      memcpy(inputChannelBuffers[i], inputBuffers[i], blockSize * sizeof(float));
+    }
+  }
+  
+  processBlock();
+  
+  // copy the output audio of unbound channels to the given buffers
+  for (int i = 0; i < numOutputChannels; i++) {
+    if (outputChannelBuffers[i] != outputBuffers[i]) {
+      memcpy(outputBuffers[i], outputChannelBuffers[i], blockSize * sizeof(float));
+    }
+  }
+  
+  unlockAfterBlock(); // unlock the context
+}
+
+/** Returns true if the given buffers of one block each overlap. */
+static bool isOverlapping(float *buffer0, float *buffer1, int blockSize) {
+  return (buffer0 < buffer1 + blockSize) && (buffer1 < buffer0 + blockSize);
+}
+
+void PdContext::bindChannelBuffers(float **inputBuffers, float **outputBuffers) {
+  if (inputBuffers == NULL || outputBuffers == NULL) {
+    // bind all channels to the global buffers
+    for (int i = 0; i < numInputChannels; i++) {
+      setInputChannelBuffer(i, globalDspInputBuffers + (i * blockSize));
+      hostInputBuffers[i] = NULL;
+    }
+    for (int i = 0; i < numOutputChannels; i++) {
+      outputChannelBuffers[i] = globalDspOutputBuffers + (i * blockSize);
+      hostOutputBuffers[i] = NULL;
+    }
+    return;
+  }
+  
+  // nothing to do if the host buffers are the same as in the previous block, as is usually the case
+  if (!memcmp(hostInputBuffers, inputBuffers, numInputChannels * sizeof(float *)) &&
+      !memcmp(hostOutputBuffers, outputBuffers, numOutputChannels * sizeof(float *))) {
+    return;
+  }
+  memcpy(hostInputBuffers, inputBuffers, numInputChannels * sizeof(float *));
+  memcpy(hostOutputBuffers, outputBuffers, numOutputChannels * sizeof(float *));
+  
+  // Host buffers are used directly if they are aligned for vector operations. Output buffers are
+  // cleared at the start of each block, so input buffers which overlap them must be copied.
+  for (int i = 0; i < numOutputChannels; i++) {
+    bool isAligned = ((((uintptr_t) outputBuffers[i]) & 0xF) == 0) && ((blockSize & 0x3) == 0);
+    outputChannelBuffers[i] = isAligned ? outputBuffers[i] : globalDspOutputBuffers + (i * blockSize);
+  }
+  // input buffers are otherwise copied, such that hosts which rotate their buffers do not cause the
+  // adc~ readers to be updated in every block
+  for (int i = 0; i < numInputChannels; i++) {
+    bool isBindable = isInputBindingEnabled &&
+        ((((uintptr_t) inputBuffers[i]) & 0xF) == 0) && ((blockSize & 0x3) == 0);
+    for (int j = 0; j < numOutputChannels && isBindable; j++) {
+      isBindable = !isOverlapping(inputBuffers[i], outputChannelBuffers[j], blockSize);
+    }
+    setInputChannelBuffer(i, isBindable ? inputBuffers[i] : globalDspInputBuffers + (i * blockSize));
+  }
+}
+
+void PdContext::setInputChannelBuffer(int channel, float *buffer) {
+  if (inputChannelBuffers[channel] != buffer) {
+    inputChannelBuffers[channel] = buffer;
+    // the readers of the adc~ buffers are updated in place, without recomputing the process order
+    for (list<DspAdc *>::iterator it = dspAdcList.begin(); it != dspAdcList.end(); ++it) {
+      (*it)->updateChannelBuffer(channel);
+    }
+  }
+}
+
+void PdContext::setInputBindingEnabled(bool enabled) {
+  isInputBindingEnabled = enabled;
+  // the host buffers are bound again with the next block
+  bindChannelBuffers(NULL, NULL);
+}
+
+void PdContext::processInterleaved(ZGSampleFormat format, const void *inputBuffers, void *outputBuffers) {
+  lock();
+  
+  // samples are converted into and out of the global buffers
+  bindChannelBuffers(NULL, NULL);
+  
+  switch (format) {
+    case ZG_SAMPLE_FORMAT_INT16: {
+      SampleConversion::shortToFloat((const short *) inputBuffers, globalDspInputBuffers,
+          numInputChannels, blockSize);
+      break;
+    }
+    case ZG_SAMPLE_FORMAT_INT24: {
+      SampleConversion::int24ToFloat((const unsigned char *) inputBuffers, globalDspInputBuffers,
+          numInputChannels, blockSize);
+      break;
+    }
+    case ZG_SAMPLE_FORMAT_INT32: {
+      SampleConversion::int32ToFloat((const int32_t *) inputBuffers, globalDspInputBuffers,
+          numInputChannels, blockSize);
+      break;
+    }
+    case ZG_SAMPLE_FORMAT_FLOAT32: {
+      SampleConversion::deinterleave((const float *) inputBuffers, globalDspInputBuffers,
+          numInputChannels, blockSize);
+      break;
+    }
+    default: break;
+  }
+  
+  processBlock();
+  
+  // the output buffers are cleared before the next block, so the dither may be added in place
+  switch (format) {
+    case ZG_SAMPLE_FORMAT_INT16: {
+      if (isDitherEnabled) {
+        SampleConversion::addTriangularDither(globalDspOutputBuffers, numOutputChannels*blockSize,
+            1.0f/32767.0f, &ditherSeed);
+      }
+      SampleConversion::floatToShort(globalDspOutputBuffers, (short *) outputBuffers,
+          numOutputChannels, blockSize);
+      break;
+    }
+    case ZG_SAMPLE_FORMAT_INT24: {
+      if (isDitherEnabled) {
+        SampleConversion::addTriangularDither(globalDspOutputBuffers, numOutputChannels*blockSize,
+            1.0f/8388607.0f, &ditherSeed);
+      }
+      SampleConversion::floatToInt24(globalDspOutputBuffers, (unsigned char *) outputBuffers,
+          numOutputChannels, blockSize);
+      break;
+    }
+    case ZG_SAMPLE_FORMAT_INT32: {
+      SampleConversion::floatToInt32(globalDspOutputBuffers, (int32_t *) outputBuffers,
+          numOutputChannels, blockSize);
+      break;
+    }
+    case ZG_SAMPLE_FORMAT_FLOAT32: {
+      SampleConversion::interleave(globalDspOutputBuffers, (float *) outputBuffers,
+          numOutputChannels, blockSize);
+      break;
+    }
+    default: break;
+  }
+  
+  unlockAfterBlock();
+}
+
+void PdContext::processBlock() {
   //AudioGaming : Print each process
 //  printStd("------- Process context ---------");
+  processingThread = pthread_self();
+  __sync_synchronize(); // the thread must be known before the flag is seen
+  isProcessingBlock = true;
   
-  // set up adc~ buffers
-  memcpy(globalDspInputBuffers, inputBuffers, numBytesInInputBuffers);
-  
-  // clear the global output audio buffers so that dac~ nodes can write to it
-  memset(globalDspOutputBuffers, 0, numBytesInOutputBuffers);
+  // clear the output audio buffers so that dac~ nodes can write to it
+  for (int i = 0; i < numOutputChannels; i++) {
+    memset(outputChannelBuffers[i], 0, blockSize * sizeof(float));
+  }
 
-  // Send all messages for this block
+  // Send all messages for this block. Midi events are merged in by time, without being copied into
+  // the message queue.
+  collectMidiEvents();
+  unsigned int midiEventIndex = 0;
+  double midiTimestamp = 0.0;
   ObjectMessageLetPair omlPair;
   double nextBlockStartTimestamp = blockStartTimestamp + blockDurationMs;
-  while (!messageCallbackQueue->empty() &&
-      (omlPair = messageCallbackQueue->peek()).second.first->getTimestamp() < nextBlockStartTimestamp) {
-    
-    messageCallbackQueue->pop(); // remove the message from the queue
-
-    MessageObject *object = omlPair.first;
-    PdMessage *message = omlPair.second.first;
-    unsigned int outletIndex = omlPair.second.second;
-    if (message->getTimestamp() < blockStartTimestamp) {
-      // messages injected into the system with a timestamp behind the current block are automatically
-      // rescheduled for the beginning of the current block. This is done in order to normalise
-      // the treament of messages, but also to avoid difficulties in cases when messages are scheduled
-      // in subgraphs with different block sizes.
-      message->setTimestamp(blockStartTimestamp);
+  while (true) {
+    bool hasMessage = !messageCallbackQueue->empty() &&
+        (omlPair = messageCallbackQueue->peek()).second.first->getTimestamp() < nextBlockStartTimestamp;
+    bool hasMidiEvent = (midiEventIndex < numMidiEvents);
+    if (hasMidiEvent) {
+      midiTimestamp = blockStartTimestamp + midiEvents[midiEventIndex].blockIndex * 1000.0 / sampleRate;
     }
     
-    object->sendMessage(outletIndex, message);
-    message->freeMessage(); // free the message now that it has been sent and processed
-  }
-  
-  switch (graphList.size()) {
-    case 0: break;
-    case 1: graphList.front()->processFunction(graphList.front(), 0, 0); break;
-    default: {
-      int numGraphs = graphList.size();
-      PdGraph **graph = &graphList.front();
-      for (int i = 0; i < numGraphs; ++i) {
-        graph[i]->processFunction(graph[i], 0, 0);
+    if (hasMidiEvent && (!hasMessage || midiTimestamp < omlPair.second.first->getTimestamp())) {
+      sendMidiEvent(midiEvents[midiEventIndex++], midiTimestamp);
+    } else if (hasMessage) {
+      messageCallbackQueue->pop(); // remove the message from the queue
+
+      MessageObject *object = omlPair.first;
+      PdMessage *message = omlPair.second.first;
+      unsigned int outletIndex = omlPair.second.second;
+      if (message->getTimestamp() < blockStartTimestamp) {
+        // messages injected into the system with a timestamp behind the current block are automatically
+        // rescheduled for the beginning of the current block. This is done in order to normalise
+        // the treament of messages, but also to avoid difficulties in cases when messages are scheduled
+        // in subgraphs with different block sizes.
+        message->setTimestamp(blockStartTimestamp);
       }
+      
+      object->sendMessage(outletIndex, message);
+      message->freeMessage(); // free the message now that it has been sent and processed
+    } else {
+      break;
     }
   }
   
-  blockStartTimestamp = nextBlockStartTimestamp;
+  // the process order is always valid here, as it is recomputed by the thread which invalidated it
   
-  // copy the output audio to the given buffer
-  memcpy(outputBuffers, globalDspOutputBuffers, numBytesInOutputBuffers);
+  if (profiler->isEnabled()) {
+    // record the process time of each root graph. Subgraphs and objects are recorded by their graphs.
+    for (int i = 0; i < graphList.size(); ++i) {
+      PdGraph *graph = graphList[i];
+      uint64_t start = DspProfiler::getTime();
+      graph->processFunction(graph, 0, 0);
+      profiler->record(graph, DspProfiler::getTime() - start);
+    }
+  } else {
+    switch (graphList.size()) {
+      case 0: break;
+      case 1: graphList.front()->processFunction(graphList.front(), 0, 0); break;
+      default: {
+        int numGraphs = graphList.size();
+        PdGraph **graph = &graphList.front();
+        for (int i = 0; i < numGraphs; ++i) {
+          graph[i]->processFunction(graph[i], 0, 0);
+        }
+      }
+    }
+  }
   
-  unlock(); // unlock the context
+  blockStartTimestamp = nextBlockStartTimestamp;
+  isProcessingBlock = false;
+}
+
+
+void PdContext::unlockAfterBlock() {
+  // an order invalidated while processing the block must still be valid for the next one
+  if (lockDepth == 1 && !isProcessOrderValid) updateProcessOrder();
+  --lockDepth;
+  pthread_mutex_unlock(&contextLock);
+}
+
+void PdContext::updateProcessOrder() {
+  if (!isProcessOrderValid) {
+    // the silence maps are computed with the process order
+    for (int i = 0; i < graphList.size(); ++i) {
+      graphList[i]->computeDeepLocalDspProcessOrder();
+    }
+    isProcessOrderValid = true;
+  } else if (hasStaleSilenceMaps) {
+    for (int i = 0; i < graphList.size(); ++i) {
+      graphList[i]->updateSilenceMaps();
+    }
+  }
+  hasStaleSilenceMaps = false;
+}
+
+void PdContext::setControlGranularity(unsigned int numSamples) {
+  // a granularity larger than the block would move all messages to the start of the block
+  if (numSamples < 1) numSamples = 1;
+  controlGranularity = (numSamples > (unsigned int) blockSize) ? blockSize : (int) numSamples;
 }
 
 
@@ -231,6 +564,7 @@ void PdContext::unattachGraph(PdGraph *graph) {
   graphList.erase(std::remove(graphList.begin(), graphList.end(), graph),
     graphList.end());
   graph->attachToContext(false);
+  profiler->clear(); // the graph may be deleted hereafter, which the profiler must not reference
   unlock();
 }
 
@@ -251,11 +585,122 @@ MessageObject *PdContext::newObject(const char *objectLabel, PdMessage *initMess
   }
 }
 
+PdFileParser *PdContext::getAbstractionTemplate(const char *name, PdGraph *graph) {
+  string label = string(name);
+  map<string,PdFileParser *>::iterator found = databaseTemplateMap.find(label);
+  if (found != databaseTemplateMap.end()) {
+    return found->second;
+  } else if (abstractionDatabase->existsAbstraction(label)) {
+    // a registered abstraction is forgotten when it is registered again or unregistered
+    PdFileParser *parser = new PdFileParser(abstractionDatabase->getAbstraction(label));
+    databaseTemplateMap[label] = parser;
+    return parser;
+  } else {
+    string filename = label + ".pd";
+    string directory = graph->findFilePath(filename.c_str());
+    if (directory.empty()) return NULL;
+    // an abstraction file is read again only once the templates have been reloaded
+    string path = directory + filename;
+    PdFileParser *&parser = fileTemplateMap[path];
+    if (parser == NULL) parser = new PdFileParser(directory, filename);
+    return parser;
+  }
+}
+
+void PdContext::registerAbstraction(const char *name, const char *description) {
+  lock();
+  abstractionDatabase->addAbstraction(name, description);
+  removeDatabaseTemplate(name);
+  unlock();
+}
+
+void PdContext::unregisterAbstraction(const char *name) {
+  lock();
+  abstractionDatabase->removeAbstraction(name);
+  removeDatabaseTemplate(name);
+  unlock();
+}
+
+void PdContext::removeDatabaseTemplate(const char *name) {
+  map<string,PdFileParser *>::iterator found = databaseTemplateMap.find(string(name));
+  if (found != databaseTemplateMap.end()) {
+    PdFileParser::release(found->second);
+    databaseTemplateMap.erase(found);
+  }
+}
+
+void PdContext::reloadAbstractions() {
+  lock();
+  clearAbstractionTemplates();
+  filePathMap.clear();
+  unlock();
+}
+
+void PdContext::clearAbstractionTemplates() {
+  for (map<string,PdFileParser *>::iterator it = databaseTemplateMap.begin();
+      it != databaseTemplateMap.end(); ++it) {
+    PdFileParser::release(it->second);
+  }
+  databaseTemplateMap.clear();
+  for (map<string,PdFileParser *>::iterator it = fileTemplateMap.begin();
+      it != fileTemplateMap.end(); ++it) {
+    PdFileParser::release(it->second);
+  }
+  fileTemplateMap.clear();
+}
+
+
+#pragma mark - File Lookup
+
+string PdContext::findFilePath(const list<string> &searchPath, const char *filename) {
+  // the memo is keyed by the full search path, such that graphs with different declared
+  // directories never share an answer
+  string key = getSearchPathKey(searchPath) + filename;
+  map<string,string>::iterator found = filePathMap.find(key);
+  if (found != filePathMap.end()) return found->second;
+
+  // a missing file is remembered as an empty directory
+  string directory;
+  for (list<string>::const_iterator it = searchPath.begin(); it != searchPath.end(); ++it) {
+    if (StaticUtils::fileExists((*it + string(filename)).c_str())) {
+      directory = *it;
+      break;
+    }
+  }
+  filePathMap[key] = directory;
+  return directory;
+}
+
+void PdContext::clearFileLookups(const list<string> &searchPath) {
+  // the keys of this search path share its prefix, and contain no further separator
+  string prefix = getSearchPathKey(searchPath);
+  map<string,string>::iterator it = filePathMap.lower_bound(prefix);
+  while (it != filePathMap.end() && it->first.compare(0, prefix.size(), prefix) == 0) {
+    if (it->first.find('\n', prefix.size()) == string::npos) {
+      filePathMap.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+string PdContext::getSearchPathKey(const list<string> &searchPath) {
+  string key;
+  for (list<string>::const_iterator it = searchPath.begin(); it != searchPath.end(); ++it) {
+    key += *it;
+    key += '\n';
+  }
+  return key;
+}
+
+
 
 #pragma mark - PrintStd/PrintErr
 
 void PdContext::printErr(char *msg) {
-  if (callbackFunction != NULL) {
+  if (outboundQueue != NULL && isProcessingThread()) {
+    outboundQueue->pushString(ZG_PRINT_ERR, msg);
+  } else if (callbackFunction != NULL) {
     callbackFunction(ZG_PRINT_ERR, callbackUserData, msg);
   }
 }
@@ -271,7 +716,9 @@ void PdContext::printErr(const char *msg, ...) {
 }
 
 void PdContext::printStd(char *msg) {
-  if (callbackFunction != NULL) {
+  if (outboundQueue != NULL && isProcessingThread()) {
+    outboundQueue->pushString(ZG_PRINT_STD, msg);
+  } else if (callbackFunction != NULL) {
     callbackFunction(ZG_PRINT_STD, callbackUserData, msg);
   }
 }
@@ -291,20 +738,18 @@ void PdContext::printStd(const char *msg, ...) {
 
 void PdContext::registerDspReceive(DspReceive *dspReceive) {
   // NOTE(mhroth): no duplicate check is made for dspReceive
-  list<DspReceive *> *receiveList = &(dspReceiveMap[string(dspReceive->getName())]);
-  receiveList->push_back(dspReceive);
+  dspReceiveRegistry.add(dspReceive->getName(), dspReceive);
   
   // connect receive~ to associated send~
   DspSend *dspSend = getDspSend(dspReceive->getName());
   if (dspSend != NULL) {
-    dspReceive->setDspBufferAtInlet(dspSend->getDspBufferAtInlet(0), 0);
+    dspReceive->setDspBufferAtOutlet(dspSend->getDspBufferAtOutlet(0), 0);
   }
 }
 
 void PdContext::unregisterDspReceive(DspReceive *dspReceive) {
-  list<DspReceive *> *receiveList = &(dspReceiveMap[string(dspReceive->getName())]);
-  receiveList->remove(dspReceive);
-  dspReceive->setDspBufferAtInlet(dspReceive->getGraph()->getBufferPool()->getZeroBuffer(), 0);
+  dspReceiveRegistry.remove(dspReceive->getName(), dspReceive);
+  dspReceive->setDspBufferAtOutlet(dspReceive->getGraph()->getBufferPool()->getZeroBuffer(), 0);
 }
 
 void PdContext::registerDspSend(DspSend *dspSend) {
@@ -313,32 +758,33 @@ void PdContext::registerDspSend(DspSend *dspSend) {
     printErr("Duplicate send~ object found with name \"%s\".", dspSend->getName());
     return;
   }
-  dspSendList.push_back(dspSend);
+  dspSendRegistry.add(dspSend->getName(), dspSend);
   
   // connect associated receive~s to send~.
   updateDspReceiveForSendWitBuffer(dspSend->getName(), dspSend->getDspBufferAtOutlet(0));
 }
 
 void PdContext::unregisterDspSend(DspSend *dspSend) {
-  dspSendList.remove(dspSend);
+  dspSendRegistry.remove(dspSend->getName(), dspSend);
   
   // inform all previously connected receive~s that the send~ buffer does not exist anymore.
   updateDspReceiveForSendWitBuffer(dspSend->getName(), dspSend->getGraph()->getBufferPool()->getZeroBuffer());
 }
 
 DspSend *PdContext::getDspSend(const char *name) {
-  for (list<DspSend *>::iterator it = dspSendList.begin(); it != dspSendList.end(); ++it) {
-    if (!strcmp((*it)->getName(), name)) return *it;
-  }
-  return NULL;
+  return dspSendRegistry.get(name);
 }
 
 void PdContext::updateDspReceiveForSendWitBuffer(const char *name, float *buffer) {
-  list<DspReceive *> receiveList = dspReceiveMap[string(name)];
-  for (list<DspReceive *>::iterator it = receiveList.begin(); it != receiveList.end(); ++it) {
-    DspReceive *dspReceive = *it;
-    dspReceive->setDspBufferAtInlet(buffer, 0);
+  vector<DspReceive *> *receiveList = dspReceiveRegistry.getAll(name);
+  if (receiveList == NULL) return;
+  for (unsigned int i = 0; i < receiveList->size(); ++i) {
+    DspReceive *dspReceive = receiveList->at(i);
+    dspReceive->setDspBufferAtOutlet(buffer, 0);
   }
+  
+  // the receivers pass the buffer on to the objects connected to them
+  invalidateProcessOrder();
 }
 
 
@@ -346,6 +792,7 @@ void PdContext::updateDspReceiveForSendWitBuffer(const char *name, float *buffer
 
 void PdContext::registerRemoteMessageReceiver(RemoteMessageReceiver *receiver) {
   sendController->addReceiver(receiver);
+  isMidiNameIndexValid = false; // a midi receiver name may now exist
 }
 
 void PdContext::unregisterRemoteMessageReceiver(RemoteMessageReceiver *receiver) {
@@ -357,16 +804,19 @@ void PdContext::registerDelayline(DspDelayWrite *delayline) {
     printErr("delwrite~ with duplicate name \"%s\" registered.", delayline->getName());
     return;
   }
-  delaylineList.push_back(delayline);
+  delaylineRegistry.add(delayline->getName(), delayline);
   
   // connect this delayline to all same-named delay receivers
-  for (list<DelayReceiver *>::iterator it = delayReceiverList.begin(); it != delayReceiverList.end(); it++) {
-    if (!strcmp((*it)->getName(), delayline->getName())) (*it)->setDelayline(delayline);
+  vector<DelayReceiver *> *delayReceivers = delayReceiverRegistry.getAll(delayline->getName());
+  if (delayReceivers != NULL) {
+    for (unsigned int i = 0; i < delayReceivers->size(); ++i) {
+      delayReceivers->at(i)->setDelayline(delayline);
+    }
   }
 }
 
 void PdContext::registerDelayReceiver(DelayReceiver *delayReceiver) {
-  delayReceiverList.push_back(delayReceiver);
+  delayReceiverRegistry.add(delayReceiver->getName(), delayReceiver);
   
   // connect the delay receiver to the named delayline
   DspDelayWrite *delayline = getDelayline(delayReceiver->getName());
@@ -374,15 +824,12 @@ void PdContext::registerDelayReceiver(DelayReceiver *delayReceiver) {
 }
 
 DspDelayWrite *PdContext::getDelayline(const char *name) {
-  for (list<DspDelayWrite *>::iterator it = delaylineList.begin(); it != delaylineList.end(); ++it) {
-    if (!strcmp((*it)->getName(), name)) return *it;
-  }
-  return NULL;
+  return delaylineRegistry.get(name);
 }
 
 void PdContext::registerDspThrow(DspThrow *dspThrow) {
   // NOTE(mhroth): no duplicate testing for the same object more than once
-  throwList.push_back(dspThrow);
+  throwRegistry.add(dspThrow->getName(), dspThrow);
   
   DspCatch *dspCatch = getDspCatch(dspThrow->getName());
   if (dspCatch != NULL) {
@@ -390,32 +837,53 @@ void PdContext::registerDspThrow(DspThrow *dspThrow) {
   }
 }
 
+void PdContext::unregisterDspThrow(DspThrow *dspThrow) {
+  throwRegistry.remove(dspThrow->getName(), dspThrow);
+  
+  DspCatch *dspCatch = getDspCatch(dspThrow->getName());
+  if (dspCatch != NULL) {
+    dspCatch->removeThrow(dspThrow);
+  }
+}
+
+void PdContext::registerDspAdc(DspAdc *dspAdc) {
+  dspAdcList.push_back(dspAdc);
+}
+
+void PdContext::unregisterDspAdc(DspAdc *dspAdc) {
+  dspAdcList.remove(dspAdc);
+}
+
 void PdContext::registerDspCatch(DspCatch *dspCatch) {
   DspCatch *catchObject = getDspCatch(dspCatch->getName());
   if (catchObject != NULL) {
     printErr("catch~ with duplicate name \"%s\" already exists.", dspCatch->getName());
     return;
   }
-  catchList.push_back(dspCatch);
+  catchRegistry.add(dspCatch->getName(), dspCatch);
   
   // connect catch~ to all associated throw~s
-  for (list<DspThrow *>::iterator it = throwList.begin(); it != throwList.end(); it++) {
-    if (!strcmp((*it)->getName(), dspCatch->getName())) dspCatch->addThrow((*it));
+  vector<DspThrow *> *dspThrows = throwRegistry.getAll(dspCatch->getName());
+  if (dspThrows != NULL) {
+    for (unsigned int i = 0; i < dspThrows->size(); ++i) {
+      dspCatch->addThrow(dspThrows->at(i));
+    }
   }
 }
 
-DspCatch *PdContext::getDspCatch(const char *name) {
-  for (list<DspCatch *>::iterator it = catchList.begin(); it != catchList.end(); it++) {
-    if (!strcmp((*it)->getName(), name)) return (*it);
+void PdContext::unregisterDspCatch(DspCatch *dspCatch) {
+  // only the registered catch~ is removed, not a duplicate of the same name
+  if (getDspCatch(dspCatch->getName()) == dspCatch) {
+    catchRegistry.remove(dspCatch->getName(), dspCatch);
   }
-  return NULL;
+}
+
+DspCatch *PdContext::getDspCatch(const char *name) {
+  return catchRegistry.get(name);
 }
 
 DelayReceiver *PdContext::getDelayReceiver(const char *name) {
-  for (list<DelayReceiver *>::iterator it = delayReceiverList.begin(); it != delayReceiverList.end(); it++) {
-    if (!strcmp((*it)->getName(), name)) return (*it);
-  }
-  return NULL;
+  return delayReceiverRegistry.get(name);
 }
 
 void PdContext::registerTable(MessageTable *table) {  
@@ -423,26 +891,23 @@ void PdContext::registerTable(MessageTable *table) {
     printErr("Table with name \"%s\" already exists.", table->getName());
     return;
   }
-  tableList.push_back(table);
+  tableRegistry.add(table->getName(), table);
   
-  for (list<TableReceiverInterface *>::iterator it = tableReceiverList.begin();
-      it != tableReceiverList.end(); it++) {
-    // in case the table receiver doesn't have the table name yet
-    if ((*it)->getName() == NULL)
-      continue;
-    if (!strcmp((*it)->getName(), table->getName())) (*it)->setTable(table);
+  vector<TableReceiverInterface *> *tableReceivers = tableReceiverRegistry.getAll(table->getName());
+  if (tableReceivers != NULL) {
+    for (unsigned int i = 0; i < tableReceivers->size(); ++i) {
+      TableReceiverInterface *tableReceiver = tableReceivers->at(i);
+      tableReceiver->setTable(table);
+    }
   }
 }
 
 MessageTable *PdContext::getTable(const char *name) {
-  for (list<MessageTable *>::iterator it = tableList.begin(); it != tableList.end(); it++) {
-    if (!strcmp((*it)->getName(), name)) return (*it);
-  }
-  return NULL;
+  return tableRegistry.get(name);
 }
 
 void PdContext::registerTableReceiver(TableReceiverInterface *tableReceiver) {
-  tableReceiverList.push_back(tableReceiver); // add the new receiver
+  tableReceiverRegistry.add(tableReceiver->getName(), tableReceiver); // add the new receiver
   
   // in case the tableread doesnt have the name of the table yet
   if (tableReceiver->getName()) {
@@ -452,10 +917,16 @@ void PdContext::registerTableReceiver(TableReceiverInterface *tableReceiver) {
 }
 
 void PdContext::unregisterTableReceiver(TableReceiverInterface *tableReceiver) {
-  tableReceiverList.remove(tableReceiver); // remove the receiver
+  tableReceiverRegistry.remove(tableReceiver->getName(), tableReceiver); // remove the receiver
   tableReceiver->setTable(NULL);
 }
 
+void PdContext::renameTableReceiver(TableReceiverInterface *tableReceiver, const char *oldName) {
+  // receivers without a name are filed under the empty name
+  tableReceiverRegistry.remove(oldName, tableReceiver);
+  tableReceiverRegistry.add(tableReceiver->getName(), tableReceiver);
+}
+
 void PdContext::setValueForName(const char *name, float constant) {
   valueMap[string(name)] = constant;
 }
@@ -467,15 +938,62 @@ float PdContext::getValueForName(const char *name) {
 void PdContext::registerExternalReceiver(const char *receiverName) {
   lock(); // don't update the external receiver registry while processing it, of course!
   sendController->registerExternalReceiver(receiverName);
+  isMidiNameIndexValid = false; // a midi receiver name may now be forwarded
   unlock();
 }
 
 void PdContext::unregisterExternalReceiver(const char *receiverName) {
   lock();
   sendController->unregisterExternalReceiver(receiverName);
+  isMidiNameIndexValid = false;
   unlock();
 }
 
+void PdContext::sendExternalMessage(const char *receiverName, PdMessage *message) {
+  if (outboundQueue != NULL && isProcessingThread()) {
+    outboundQueue->pushReceiverMessage(receiverName, message);
+  } else if (callbackFunction != NULL) {
+    std::pair<const char *, PdMessage *> pair = make_pair(receiverName, message);
+    callbackFunction(ZG_RECEIVER_MESSAGE, callbackUserData, &pair);
+  }
+}
+
+
+#pragma mark - Outbound Queue
+
+void PdContext::setOutboundQueueSize(unsigned int numBytes) {
+  OutboundMessageQueue *newQueue = (numBytes > 0) ? new OutboundMessageQueue(numBytes) : NULL;
+  
+  // the queue must neither be replaced while a block is processed, nor while it is polled
+  pthread_mutex_lock(&outboundConsumerLock);
+  lock();
+  OutboundMessageQueue *queue = outboundQueue;
+  outboundQueue = newQueue;
+  unlock();
+  
+  if (queue != NULL) {
+    // deliver whatever is left in the old queue before it is discarded
+    queue->poll(callbackFunction, callbackUserData);
+    delete queue;
+  }
+  pthread_mutex_unlock(&outboundConsumerLock);
+}
+
+unsigned int PdContext::pollOutboundQueue() {
+  pthread_mutex_lock(&outboundConsumerLock);
+  unsigned int numPolled = (outboundQueue != NULL) ?
+      outboundQueue->poll(callbackFunction, callbackUserData) : 0;
+  pthread_mutex_unlock(&outboundConsumerLock);
+  return numPolled;
+}
+
+unsigned int PdContext::getNumOutboundDropped() {
+  pthread_mutex_lock(&outboundConsumerLock);
+  unsigned int numDropped = (outboundQueue != NULL) ? outboundQueue->getNumDropped() : 0;
+  pthread_mutex_unlock(&outboundConsumerLock);
+  return numDropped;
+}
+
 
 #pragma mark - Manage Messages
 
@@ -525,6 +1043,112 @@ void PdContext::scheduleExternalMessage(const char *receiverName, double timesta
   unlock();
 }
 
+unsigned int PdContext::scheduleMidiEvents(const ZGMidiEvent *events, unsigned int numEvents) {
+  // the context is not locked. The events are picked up at the start of the next block.
+  pthread_mutex_lock(&midiProducerLock);
+  unsigned int numWritten = midiEventQueue->write(events, numEvents);
+  pthread_mutex_unlock(&midiProducerLock);
+  return numWritten;
+}
+
+/** Returns the end of the run of events in order of block index which starts at the given index. */
+static unsigned int getMidiRunEnd(const vector<ZGMidiEvent> &events, unsigned int start,
+    unsigned int numEvents) {
+  unsigned int end = start + 1;
+  while (end < numEvents && events[end-1].blockIndex <= events[end].blockIndex) ++end;
+  return (start < numEvents) ? end : numEvents;
+}
+
+void PdContext::collectMidiEvents() {
+  numMidiEvents = midiEventQueue->read(&midiEvents.front(), midiEvents.size());
+  
+  float maxBlockIndex = (float) (blockSize-1);
+  for (unsigned int i = 0; i < numMidiEvents; ++i) {
+    // events outside of the block are delivered at its beginning
+    float blockIndex = midiEvents[i].blockIndex;
+    if (!(blockIndex >= 0.0f && blockIndex <= maxBlockIndex)) midiEvents[i].blockIndex = 0.0f;
+  }
+  
+  // The events of each call to scheduleMidiEvents() are usually in order. Adjacent runs of ordered
+  // events are merged (stably) until one remains, such that ordered events take a single pass.
+  while (getMidiRunEnd(midiEvents, 0, numMidiEvents) < numMidiEvents) {
+    unsigned int start = 0;
+    while (start < numMidiEvents) {
+      unsigned int middle = getMidiRunEnd(midiEvents, start, numMidiEvents);
+      unsigned int end = getMidiRunEnd(midiEvents, middle, numMidiEvents);
+      unsigned int i = start, j = middle;
+      for (unsigned int k = start; k < end; ++k) {
+        bool isLeft = (i < middle) && (j >= end || midiEvents[i].blockIndex <= midiEvents[j].blockIndex);
+        midiMergeEvents[k] = isLeft ? midiEvents[i++] : midiEvents[j++];
+      }
+      start = end;
+    }
+    midiEvents.swap(midiMergeEvents);
+  }
+}
+
+/** Writes the receiver name of the given midi name index, e.g. "zg_notein_3" or "zg_ctlin". */
+static void getMidiReceiverName(int index, char *name, size_t size) {
+  switch (index) {
+    case 16: snprintf(name, size, "zg_notein_omni"); break;
+    case 17: snprintf(name, size, "zg_ctlin"); break;
+    case 18: snprintf(name, size, "zg_bendin"); break;
+    default: snprintf(name, size, "zg_notein_%i", index); break;
+  }
+}
+
+void PdContext::sendMidiEvent(const ZGMidiEvent &event, double timestamp) {
+  if (!isMidiNameIndexValid) {
+    const set<string> &externalReceivers = sendController->getExternalReceivers();
+    char name[16];
+    for (int i = 0; i < 19; ++i) {
+      getMidiReceiverName(i, name, sizeof(name));
+      midiNameIndex[i] = sendController->getNameIndex(name);
+      isMidiNameExternal[i] = (externalReceivers.find(string(name)) != externalReceivers.end());
+    }
+    isMidiNameIndexValid = true;
+  }
+  
+  PdMessage *message = PD_MESSAGE_ON_STACK(3);
+  switch (event.type) {
+    case ZG_MIDI_NOTE: {
+      message->initWithTimestampAndNumElements(timestamp, 3);
+      message->setFloat(0, (float) event.value0);
+      message->setFloat(1, (float) event.value1);
+      message->setFloat(2, (float) event.channel);
+      if (event.channel < 16) sendMidiMessage(event.channel, message);
+      // all notes are also sent to the omni listener
+      sendMidiMessage(16, message);
+      break;
+    }
+    case ZG_MIDI_CONTROL_CHANGE: {
+      message->initWithTimestampAndNumElements(timestamp, 3);
+      message->setFloat(0, (float) event.value1);
+      message->setFloat(1, (float) event.value0);
+      message->setFloat(2, (float) event.channel);
+      sendMidiMessage(17, message);
+      break;
+    }
+    case ZG_MIDI_PITCH_BEND: {
+      message->initWithTimestampAndNumElements(timestamp, 2);
+      message->setFloat(0, (float) event.value0);
+      message->setFloat(1, (float) event.channel);
+      sendMidiMessage(18, message);
+      break;
+    }
+    default: break;
+  }
+}
+
+void PdContext::sendMidiMessage(int index, PdMessage *message) {
+  if (midiNameIndex[index] >= 0) sendController->sendMessage(midiNameIndex[index], message);
+  if (isMidiNameExternal[index]) {
+    char name[16];
+    getMidiReceiverName(index, name, sizeof(name));
+    sendExternalMessage(name, message);
+  }
+}
+
 PdMessage *PdContext::scheduleMessage(MessageObject *messageObject, unsigned int outletIndex, PdMessage *message) {
   // basic argument checking. It may happen that the message is NULL in case a cancel message
   // is sent multiple times to a particular object, when no message is pending
@@ -564,6 +1188,7 @@ void PdContext::registerAudioBinaryFile(const std::string &filepath) {
     delete audioBinaryFile;
   }
   audioBinaryFile = new AudioBinaryFile(filepath);
+  audioBinaryFilePath = filepath;
 }
 
 AudioBinaryFile *PdContext::getAudioBinaryFile() const {
@@ -32,14 +32,21 @@
 
 #include <map>
 #include <pthread.h>
+#include "NameRegistry.h"
 #include "OrderedMessageQueue.h"
+#include "OutboundMessageQueue.h"
 #include "PdGraph.h"
+#include "SpscRingBuffer.h"
 #include "ZGCallbackFunction.h"
+#include "ZGMidiEvent.h"
+#include "ZGSampleFormat.h"
 
 class BufferPool;
+class DspAdc;
 class DspCatch;
 class DelayReceiver;
 class DspDelayWrite;
+class DspProfiler;
 class DspReceive;
 class DspSend;
 class DspThrow;
@@ -63,6 +70,18 @@ class PdContext {
     PdContext(int numInputChannels, int numOutputChannels, int blockSize, float sampleRate,
         void *(*function)(ZGCallbackFunction, void *, void *), void *userData);
     ~PdContext();
+
+    /**
+     * Returns a new context with the same configuration as this one: registered objects,
+     * abstractions, external receivers and cached abstraction templates are copied, and every
+     * attached graph that was created from a file or string is created again from its parsed
+     * description. No file is read and no description is parsed. The new context is in the state of
+     * a freshly loaded patch, i.e. messages received by this context are not replayed, except that
+     * its tables share the current contents of this context's tables (see
+     * <code>SharedTableStore</code>). This context is only locked while its state is copied, and
+     * the process order of the new context is computed before it is returned.
+     */
+    PdContext *clone();
   
     int getNumInputChannels();
     int getNumOutputChannels();
@@ -75,11 +94,79 @@ class PdContext {
      */
     void attachGraph(PdGraph *graph);
     void unattachGraph(PdGraph *graph);
+  
+    /**
+     * Marks the dsp process order of all attached graphs as stale, e.g. because a connection has
+     * been added or removed. The context must be locked. The process order is recomputed once
+     * when the lock is released, no matter how many edits have been made.
+     */
+    void invalidateProcessOrder() { isProcessOrderValid = false; }
+  
+    /** Returns <code>false</code> if the process order is recomputed when the context lock is released. */
+    bool hasValidProcessOrder() { return isProcessOrderValid; }
+  
+    /**
+     * Marks the silence map of some graph as stale, e.g. because an object has unfolded on the audio
+     * thread. The maps are recomputed when the lock is next released by a thread other than the one
+     * processing the audio.
+     */
+    void invalidateSilenceMaps() { hasStaleSilenceMaps = true; }
+  
+    /**
+     * Recomputes the process order of all graphs if it has been invalidated, and otherwise any stale
+     * silence maps.
+     */
+    void updateProcessOrder();
     
     void process(float *inputBuffers, float *outputBuffers);
   
-    void lock() { pthread_mutex_lock(&contextLock); }
-    void unlock() { pthread_mutex_unlock(&contextLock); }
+    /**
+     * Process one block of audio given as one buffer per channel. Aligned buffers are read and
+     * written in place by adc~ and dac~, without copies. As long as the same buffers are given for
+     * each block, as is usual for audio hosts, there is no further overhead. Otherwise the new input
+     * buffers are passed on to the readers of adc~.
+     */
+    void processChannels(float **inputBuffers, float **outputBuffers);
+
+    /**
+     * Process one block of channel-interleaved audio in the given sample format. Samples are converted
+     * directly into (and out of) the global adc~ and dac~ buffers.
+     */
+    void processInterleaved(ZGSampleFormat format, const void *inputBuffers, void *outputBuffers);
+
+    /** Triangular dither is added to 16-bit and 24-bit output if enabled. It is off by default. */
+    void setDitherEnabled(bool enabled) { isDitherEnabled = enabled; }
+  
+    /**
+     * If enabled, adc~ reads directly from aligned host input buffers given to
+     * <code>processChannels()</code>, instead of from copies of them. A change of the bound buffers
+     * is passed on to the readers of adc~ and may unfold folded objects, so it is only worthwhile if
+     * the host gives the same input buffers for each block. It is off by default. The context must be locked.
+     */
+    void setInputBindingEnabled(bool enabled);
+  
+    /**
+     * Messages to dsp objects take effect at multiples of this number of samples within a block,
+     * such that several messages within one control period split the block only once. Defaults
+     * to one, i.e. messages are sample-accurate.
+     */
+    void setControlGranularity(unsigned int numSamples);
+    int getControlGranularity() { return controlGranularity; }
+  
+    void lock() {
+      pthread_mutex_lock(&contextLock);
+      ++lockDepth;
+    }
+  
+    /**
+     * An invalidated process order is recomputed before the outermost lock is released, i.e. on
+     * the thread which edited the graph, such that the audio thread only ever sees a valid order.
+     */
+    void unlock() {
+      if (lockDepth == 1 && (!isProcessOrderValid || hasStaleSilenceMaps)) updateProcessOrder();
+      --lockDepth;
+      pthread_mutex_unlock(&contextLock);
+    }
   
     /** Globally register a remote message receiver (e.g. [send] or [notein]). */
     void registerRemoteMessageReceiver(RemoteMessageReceiver *receiver);
@@ -115,13 +202,25 @@ class PdContext {
     void registerDelayReceiver(DelayReceiver *delayReceiver);
     
     void registerDspThrow(DspThrow *dspThrow);
+    void unregisterDspThrow(DspThrow *dspThrow);
     
     void registerDspCatch(DspCatch *dspCatch);
+    void unregisterDspCatch(DspCatch *dspCatch);
+  
+    /** Globally register an [adc~] object, such that it can pass on changed input channel buffers. */
+    void registerDspAdc(DspAdc *dspAdc);
+    void unregisterDspAdc(DspAdc *dspAdc);
     
     void registerTable(MessageTable *table);
     
     void registerTableReceiver(TableReceiverInterface *tableReceiver);
     void unregisterTableReceiver(TableReceiverInterface *tableReceiver);
+  
+    /**
+     * Files a registered table receiver under its current name, after it has been renamed from
+     * <code>oldName</code>, such that it is bound to a table of that name registered later.
+     */
+    void renameTableReceiver(TableReceiverInterface *tableReceiver, const char *oldName);
     
     MessageTable *getTable(const char *name);
     
@@ -157,6 +256,13 @@ class PdContext {
     void scheduleExternalMessage(const char *receiverName, double timestamp,
         const char *initString);
   
+    /**
+     * Queues midi events for the next block without locking the context. May be called from any
+     * thread. Producers are serialised by a lock which the audio thread never takes. Returns the
+     * number of events which have been queued.
+     */
+    unsigned int scheduleMidiEvents(const ZGMidiEvent *events, unsigned int numEvents);
+  
     /**
      * Schedules a <code>PdMessage</code> to be sent by the <code>MessageObject</code> from the
      * <code>outletIndex</code> at the specified <code>time</code>. The message will be copied
@@ -174,10 +280,16 @@ class PdContext {
     /** Receives and processes messages sent to the Pd system by sending to "pd". */
     void receiveSystemMessage(PdMessage *message);
   
-    /** Returns the global dsp buffer at the given inlet. Exclusively used by <code>DspAdc</code>. */
+    /**
+     * Returns the global dsp buffer at the given inlet, which may be a buffer of the host.
+     * Exclusively used by <code>DspAdc</code>.
+     */
     float *getGlobalDspBufferAtInlet(int inletIndex);
     
-    /** Returns the global dsp buffer at the given outlet. Exclusively used by <code>DspDac</code>. */
+    /**
+     * Returns the global dsp buffer at the given outlet, which may be a buffer of the host.
+     * Exclusively used by <code>DspDac</code>.
+     */
     float *getGlobalDspBufferAtOutlet(int outletIndex);
   
     /** Returns the timestamp of the beginning of the current block. */
@@ -207,6 +319,29 @@ class PdContext {
     void registerExternalReceiver(const char *receiverName);
     void unregisterExternalReceiver(const char *receiverName);
   
+    /**
+     * Delivers a message sent to a registered external receiver to the host, either directly via
+     * the callback function or through the outbound queue.
+     */
+    void sendExternalMessage(const char *receiverName, PdMessage *message);
+  
+    /**
+     * Enables the outbound queue with the given capacity in bytes, or disables it if zero. While
+     * enabled, external receiver messages and print output generated during processing are queued
+     * instead of being delivered from the audio thread, and must be collected with
+     * <code>pollOutboundQueue()</code>. Only output of the thread processing a block is queued.
+     */
+    void setOutboundQueueSize(unsigned int numBytes);
+  
+    /**
+     * Delivers all queued outbound records to the callback function on the calling thread. Returns
+     * the number of records delivered.
+     */
+    unsigned int pollOutboundQueue();
+  
+    /** Returns the number of outbound records which have been dropped because the queue was full. */
+    unsigned int getNumOutboundDropped();
+  
     /** User-provided data associated with the callback function. */
     void *callbackUserData;
   
@@ -221,9 +356,42 @@ class PdContext {
     void unregisterExternalObject(const char *objectLabel);
   
     BufferPool *getBufferPool() { return bufferPool; }
+  
+    /** Returns the profiler recording the process time of all dsp objects in this context. */
+    DspProfiler *getProfiler() { return profiler; }
 
     PdAbstractionDataBase *getAbstractionDataBase();
 
+    /**
+     * Returns the parsed description of the named abstraction, as found in the abstraction database
+     * or else on the search path of the given graph. Returns <code>NULL</code> if the abstraction
+     * cannot be found. Descriptions are cached, such that an abstraction is only read and parsed the
+     * first time that it is instantiated, until the abstractions are reloaded.
+     */
+    PdFileParser *getAbstractionTemplate(const char *name, PdGraph *graph);
+  
+    /** Adds an abstraction to the abstraction database, replacing any of the same name. */
+    void registerAbstraction(const char *name, const char *description);
+  
+    /** Removes an abstraction from the abstraction database. */
+    void unregisterAbstraction(const char *name);
+  
+    /**
+     * Forgets all parsed abstractions and file lookups, such that abstraction files are found and
+     * read again the next time that they are instantiated.
+     */
+    void reloadAbstractions();
+  
+    /**
+     * Returns the first directory of the search path which contains the named file, or an empty
+     * string if there is none. Lookups are remembered, whether or not the file is found, until
+     * they are cleared or the abstractions are reloaded.
+     */
+    string findFilePath(const list<string> &searchPath, const char *filename);
+  
+    /** Forgets the file lookups made with the given search path. Called before a search path changes. */
+    void clearFileLookups(const list<string> &searchPath);
+
     //AudioGaming : Audio binary file
     void registerAudioBinaryFile(const std::string &filepath);
 
@@ -235,6 +403,54 @@ class PdContext {
   
     void initObjectInitMap();
 
+    /**
+     * Processes one block of the input in the global adc~ buffers into the global dac~ buffers. The
+     * context must be locked.
+     */
+    void processBlock();
+  
+    /**
+     * Releases the lock taken to process a block. Stale silence maps are left to the next editing
+     * thread, such that the audio thread never computes them.
+     */
+    void unlockAfterBlock();
+  
+    /** Deletes the parsed description of the named abstraction from the abstraction database, if any. */
+    void removeDatabaseTemplate(const char *name);
+  
+    /** Deletes all parsed abstraction descriptions. */
+    void clearAbstractionTemplates();
+  
+    /** Returns the prefix of the file lookup keys made with the given search path. */
+    static string getSearchPathKey(const list<string> &searchPath);
+  
+    /**
+     * Binds the dac~ (and if enabled, the adc~) channels to the given host buffers where possible, or
+     * otherwise to the global buffers. If <code>NULL</code> is given, all channels are bound to the
+     * global buffers.
+     */
+    void bindChannelBuffers(float **inputBuffers, float **outputBuffers);
+  
+    /** Sets the buffer of the given input channel, and passes it on to all [adc~] objects. */
+    void setInputChannelBuffer(int channel, float *buffer);
+  
+    /**
+     * Returns <code>true</code> if called by the thread which is processing a block, i.e. the only
+     * producer of <code>outboundQueue</code>.
+     */
+    bool isProcessingThread() {
+      return isProcessingBlock && pthread_equal(pthread_self(), processingThread);
+    }
+  
+    /** Moves all queued midi events into <code>midiEvents</code>, sorted by block index. */
+    void collectMidiEvents();
+  
+    /** Sends the midi event to the receivers of its type and channel. */
+    void sendMidiEvent(const ZGMidiEvent &event, double timestamp);
+  
+    /** Sends a message to the midi receiver name of the given index, and to the host if registered. */
+    void sendMidiMessage(int index, PdMessage *message);
+
     int numInputChannels;
     int numOutputChannels;
     int blockSize;
@@ -248,6 +464,9 @@ class PdContext {
   
     /** A thread lock used to access critical sections of this context. */
     pthread_mutex_t contextLock;
+  
+    /** The number of times that the (recursive) context lock is held. Only accessed while holding it. */
+    int lockDepth;
     
     int numBytesInInputBuffers;
     int numBytesInOutputBuffers;
@@ -255,6 +474,16 @@ class PdContext {
     float *globalDspInputBuffers;
     float *globalDspOutputBuffers;
   
+    /** The buffer read by adc~ for each input channel. */
+    float **inputChannelBuffers;
+  
+    /** The buffer written by dac~ for each output channel. */
+    float **outputChannelBuffers;
+  
+    /** The host buffers given for the previous block, such that changes are detected. */
+    float **hostInputBuffers;
+    float **hostOutputBuffers;
+  
     /** A message queue keeping track of all scheduled messages. */
     OrderedMessageQueue *messageCallbackQueue;
   
@@ -267,41 +496,113 @@ class PdContext {
     /** The global send controller. */
     MessageSendController *sendController;
   
-    /** A global list of all [send~] objects. */
-    list<DspSend *> dspSendList;
+    /**
+     * Carries host-bound output from the audio thread if enabled, otherwise <code>NULL</code>. It is
+     * replaced under both the context lock (against the producer) and
+     * <code>outboundConsumerLock</code> (against polling).
+     */
+    OutboundMessageQueue *outboundQueue;
+  
+    /** Serialises the consumers of <code>outboundQueue</code>. The audio thread never takes it. */
+    pthread_mutex_t outboundConsumerLock;
+  
+    /** <code>true</code> while a block is processed by <code>processingThread</code>. */
+    volatile bool isProcessingBlock;
+    pthread_t processingThread;
+  
+    /** Midi events queued by <code>scheduleMidiEvents()</code> for the next block. */
+    SpscRingBuffer<ZGMidiEvent> *midiEventQueue;
+  
+    /** Serialises the producers of <code>midiEventQueue</code>. */
+    pthread_mutex_t midiProducerLock;
+  
+    /**
+     * The midi events of the current block, and the space into which they are merged. The capacity
+     * of both is that of the queue.
+     */
+    vector<ZGMidiEvent> midiEvents;
+    vector<ZGMidiEvent> midiMergeEvents;
+    unsigned int numMidiEvents;
+  
+    /**
+     * The send controller name indices of [notein] for each channel, omni [notein], [ctlin] and
+     * [bendin], and whether each name is registered as an external receiver. They are looked up
+     * again once a receiver or an external receiver has been registered.
+     */
+    int midiNameIndex[19];
+    bool isMidiNameExternal[19];
+    bool isMidiNameIndexValid;
+  
+    /** A global registry of all [send~] objects. */
+    NameRegistry<DspSend> dspSendRegistry;
     
-    /** A global list of all [receive~] objects. */
-    map<string, list<DspReceive *> > dspReceiveMap;
+    /** A global registry of all [receive~] objects. */
+    NameRegistry<DspReceive> dspReceiveRegistry;
     
-    /** A global list of all [delwrite~] objects. */
-    list<DspDelayWrite *> delaylineList;
+    /** A global registry of all [delwrite~] objects. */
+    NameRegistry<DspDelayWrite> delaylineRegistry;
     
-    /** A global list of all [delread~] and [vd~] objects. */
-    list<DelayReceiver *> delayReceiverList;
+    /** A global registry of all [delread~] and [vd~] objects. */
+    NameRegistry<DelayReceiver> delayReceiverRegistry;
     
-    /** A global list of all [throw~] objects. */
-    list<DspThrow *> throwList;
+    /** A global registry of all [throw~] objects. */
+    NameRegistry<DspThrow> throwRegistry;
     
-    /** A global list of all [catch~] objects. */
-    list<DspCatch *> catchList;
+    /** A global registry of all [catch~] objects. */
+    NameRegistry<DspCatch> catchRegistry;
+  
+    /** All [adc~] objects. */
+    list<DspAdc *> dspAdcList;
     
-    /** A global list of all [table] objects. */
-    list<MessageTable *> tableList;
+    /** A global registry of all [table] objects. */
+    NameRegistry<MessageTable> tableRegistry;
     
-    /** A global list of all table receivers (e.g., [tabread4~] and [tabplay~]) */
-    list<TableReceiverInterface *> tableReceiverList;
+    /**
+     * A global registry of all table receivers (e.g., [tabread4~] and [tabplay~]), by the name
+     * with which they were registered.
+     */
+    NameRegistry<TableReceiverInterface> tableReceiverRegistry;
 
     /** Registered binary file */
     AudioBinaryFile *audioBinaryFile;
+    std::string audioBinaryFilePath;
 
     ObjectFactoryMap *objectFactoryMap;
   
     BufferPool *bufferPool;
   
+    DspProfiler *profiler;
+
+    bool isDitherEnabled;
+  
+    /** Whether adc~ may read directly from host input buffers. */
+    bool isInputBindingEnabled;
+  
+    /** The number of samples to which message split points within a block are rounded down. */
+    int controlGranularity;
+
+    /** The state of the dither noise generator. */
+    uint32_t ditherSeed;
+  
+    /** False if the process order must be recomputed before the context lock is released. */
+    bool isProcessOrderValid;
+  
+    /** True if the silence map of some graph must be recomputed before the context lock is released. */
+    bool hasStaleSilenceMaps;
+  
     /** A global map storing values for Value objects. */
     map<string,float> valueMap;
 
     PdAbstractionDataBase *abstractionDatabase;
+
+    /** Parsed abstractions from the abstraction database, by name. */
+    map<string,PdFileParser *> databaseTemplateMap;
+
+    /** Parsed abstraction files, by path. */
+    map<string,PdFileParser *> fileTemplateMap;
+  
+    /** The directories in which files have been found by <code>findFilePath()</code>, by search path and file name. */
+    map<string,string> filePathMap;
 };
 
 inline PdAbstractionDataBase *PdContext::getAbstractionDataBase() {
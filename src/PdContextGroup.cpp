@@ -0,0 +1,241 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#if __linux__
+#include <sched.h>
+#endif
+#include "DspProfiler.h"
+#include "PdContext.h"
+#include "PdContextGroup.h"
+
+PdContextGroup::PdContextGroup(unsigned int numWorkers) {
+  long numCpus = sysconf(_SC_NPROCESSORS_ONLN);
+  if (numCpus < 1) numCpus = 1;
+  if (numWorkers == 0) numWorkers = (unsigned int) numCpus;
+
+  pthread_mutex_init(&groupLock, NULL);
+  pthread_mutex_init(&workerLock, NULL);
+  pthread_cond_init(&startCondition, NULL);
+  pthread_cond_init(&doneCondition, NULL);
+  generation = 0;
+  numPendingWorkers = 0;
+  isShuttingDown = false;
+  lastProcessNs = 0;
+
+  // the first worker is the thread calling process()
+  for (unsigned int i = 0; i < numWorkers; ++i) {
+    Worker *worker = new Worker();
+    worker->group = this;
+    worker->index = i;
+    if (i > 0 && pthread_create(&worker->thread, NULL, &workerThread, worker) != 0) {
+      // no more threads can be started. The contexts are processed by the workers which exist,
+      // in the worst case all on the thread calling process().
+      delete worker;
+      break;
+    }
+    workers.push_back(worker);
+    #if __linux__
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(i % numCpus, &cpuSet);
+    if (i > 0) pthread_setaffinity_np(worker->thread, sizeof(cpu_set_t), &cpuSet);
+    #endif
+  }
+}
+
+PdContextGroup::~PdContextGroup() {
+  pthread_mutex_lock(&workerLock);
+  isShuttingDown = true;
+  pthread_cond_broadcast(&startCondition);
+  pthread_mutex_unlock(&workerLock);
+
+  for (unsigned int i = 0; i < workers.size(); ++i) {
+    Worker *worker = workers[i];
+    if (i > 0) pthread_join(worker->thread, NULL);
+    for (unsigned int j = 0; j < worker->members.size(); ++j) {
+      delete worker->members[j];
+    }
+    delete worker;
+  }
+
+  pthread_cond_destroy(&doneCondition);
+  pthread_cond_destroy(&startCondition);
+  pthread_mutex_destroy(&workerLock);
+  pthread_mutex_destroy(&groupLock);
+}
+
+
+#pragma mark - Add/Remove Context
+
+void PdContextGroup::addContext(PdContext *context, float *inputBuffers, float *outputBuffers) {
+  pthread_mutex_lock(&groupLock);
+  for (unsigned int i = 0; i < workers.size(); ++i) {
+    std::vector<GroupMember *> &members = workers[i]->members;
+    for (unsigned int j = 0; j < members.size(); ++j) {
+      if (members[j]->context == context) {
+        members[j]->inputBuffers = inputBuffers;
+        members[j]->outputBuffers = outputBuffers;
+        pthread_mutex_unlock(&groupLock);
+        return;
+      }
+    }
+  }
+
+  GroupMember *member = new GroupMember();
+  member->context = context;
+  member->inputBuffers = inputBuffers;
+  member->outputBuffers = outputBuffers;
+  member->workerIndex = getLeastLoadedWorker();
+  member->numBlocks = 0;
+  member->lastNs = member->sumNs = member->maxNs = 0;
+  workers[member->workerIndex]->members.push_back(member);
+  pthread_mutex_unlock(&groupLock);
+}
+
+void PdContextGroup::removeContext(PdContext *context) {
+  pthread_mutex_lock(&groupLock);
+  for (unsigned int i = 0; i < workers.size(); ++i) {
+    std::vector<GroupMember *> &members = workers[i]->members;
+    for (unsigned int j = 0; j < members.size(); ++j) {
+      if (members[j]->context == context) {
+        delete members[j];
+        members.erase(members.begin() + j);
+        pthread_mutex_unlock(&groupLock);
+        return;
+      }
+    }
+  }
+  pthread_mutex_unlock(&groupLock);
+}
+
+unsigned int PdContextGroup::getLeastLoadedWorker() {
+  // contexts which have not been processed yet are assumed to cost as much as the average context
+  uint64_t sumNs = 0;
+  unsigned int numMeasured = 0;
+  for (unsigned int i = 0; i < workers.size(); ++i) {
+    std::vector<GroupMember *> &members = workers[i]->members;
+    for (unsigned int j = 0; j < members.size(); ++j) {
+      if (members[j]->numBlocks > 0) {
+        sumNs += members[j]->sumNs / members[j]->numBlocks;
+        ++numMeasured;
+      }
+    }
+  }
+  uint64_t defaultNs = (numMeasured > 0) ? (sumNs / numMeasured) : 1;
+
+  unsigned int leastLoadedIndex = 0;
+  uint64_t leastLoad = 0;
+  for (unsigned int i = 0; i < workers.size(); ++i) {
+    uint64_t load = 0;
+    std::vector<GroupMember *> &members = workers[i]->members;
+    for (unsigned int j = 0; j < members.size(); ++j) {
+      load += (members[j]->numBlocks > 0) ? (members[j]->sumNs / members[j]->numBlocks) : defaultNs;
+    }
+    if (i == 0 || load < leastLoad) {
+      leastLoadedIndex = i;
+      leastLoad = load;
+    }
+  }
+  return leastLoadedIndex;
+}
+
+
+#pragma mark - Process
+
+void PdContextGroup::process() {
+  pthread_mutex_lock(&groupLock);
+  uint64_t start = DspProfiler::getTime();
+
+  pthread_mutex_lock(&workerLock);
+  numPendingWorkers = (unsigned int) workers.size() - 1;
+  ++generation;
+  pthread_cond_broadcast(&startCondition);
+  pthread_mutex_unlock(&workerLock);
+
+  processWorker(workers[0]);
+
+  pthread_mutex_lock(&workerLock);
+  while (numPendingWorkers > 0) {
+    pthread_cond_wait(&doneCondition, &workerLock);
+  }
+  pthread_mutex_unlock(&workerLock);
+
+  lastProcessNs = DspProfiler::getTime() - start;
+  pthread_mutex_unlock(&groupLock);
+}
+
+void PdContextGroup::processWorker(Worker *worker) {
+  std::vector<GroupMember *> &members = worker->members;
+  for (unsigned int i = 0; i < members.size(); ++i) {
+    GroupMember *member = members[i];
+    uint64_t start = DspProfiler::getTime();
+    member->context->process(member->inputBuffers, member->outputBuffers);
+    uint64_t elapsedNs = DspProfiler::getTime() - start;
+    member->lastNs = elapsedNs;
+    member->sumNs += elapsedNs;
+    if (elapsedNs > member->maxNs) member->maxNs = elapsedNs;
+    ++(member->numBlocks);
+  }
+}
+
+void *PdContextGroup::workerThread(void *ptr) {
+  Worker *worker = reinterpret_cast<Worker *>(ptr);
+  PdContextGroup *group = worker->group;
+  unsigned int lastGeneration = 0;
+
+  pthread_mutex_lock(&group->workerLock);
+  while (true) {
+    while (group->generation == lastGeneration && !group->isShuttingDown) {
+      pthread_cond_wait(&group->startCondition, &group->workerLock);
+    }
+    if (group->isShuttingDown) break;
+    lastGeneration = group->generation;
+    pthread_mutex_unlock(&group->workerLock);
+
+    processWorker(worker);
+
+    pthread_mutex_lock(&group->workerLock);
+    if (--(group->numPendingWorkers) == 0) {
+      pthread_cond_signal(&group->doneCondition);
+    }
+  }
+  pthread_mutex_unlock(&group->workerLock);
+  return NULL;
+}
+
+
+#pragma mark - Timing
+
+ZGContextTiming *PdContextGroup::getTiming(unsigned int *n, double *totalMicros) {
+  pthread_mutex_lock(&groupLock);
+  unsigned int numContexts = 0;
+  for (unsigned int i = 0; i < workers.size(); ++i) {
+    numContexts += (unsigned int) workers[i]->members.size();
+  }
+
+  ZGContextTiming *timing = (ZGContextTiming *) calloc(numContexts > 0 ? numContexts : 1, sizeof(ZGContextTiming));
+  unsigned int k = 0;
+  for (unsigned int i = 0; i < workers.size(); ++i) {
+    std::vector<GroupMember *> &members = workers[i]->members;
+    for (unsigned int j = 0; j < members.size(); ++j, ++k) {
+      GroupMember *member = members[j];
+      timing[k].context = member->context;
+      timing[k].workerIndex = member->workerIndex;
+      timing[k].numBlocks = member->numBlocks;
+      timing[k].lastMicros = member->lastNs / 1000.0;
+      timing[k].meanMicros = (member->numBlocks > 0) ? (member->sumNs / 1000.0) / member->numBlocks : 0.0;
+      timing[k].maxMicros = member->maxNs / 1000.0;
+    }
+  }
+
+  *n = numContexts;
+  if (totalMicros != NULL) *totalMicros = lastProcessNs / 1000.0;
+  pthread_mutex_unlock(&groupLock);
+  return timing;
+}
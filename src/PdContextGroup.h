@@ -0,0 +1,107 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#ifndef _PD_CONTEXT_GROUP_H_
+#define _PD_CONTEXT_GROUP_H_
+
+#include <pthread.h>
+#include <stdint.h>
+#include <vector>
+#include "ZenGarden.h"
+
+class PdContext;
+
+/**
+ * A <code>PdContextGroup</code> processes many independent contexts for one block in a single call,
+ * distributed over an internal pool of worker threads. The calling thread acts as the first worker.
+ * Each context is pinned to one worker for as long as it is a member of the group, such that its
+ * state stays in the caches of the same core. New contexts are assigned to the least loaded worker,
+ * according to the measured process time of its contexts. On Linux, each worker thread is bound to
+ * one CPU.
+ */
+class PdContextGroup {
+
+  public:
+    /** Create a group with the given number of workers. If zero, one worker per online CPU is used. */
+    PdContextGroup(unsigned int numWorkers);
+    ~PdContextGroup();
+
+    /**
+     * Adds a context to the group, to be processed with the given (uninterleaved) audio buffers.
+     * If the context is already a member of the group, only its buffers are updated.
+     */
+    void addContext(PdContext *context, float *inputBuffers, float *outputBuffers);
+
+    /** Removes a context from the group. A context must be removed before it is deleted. */
+    void removeContext(PdContext *context);
+
+    /** Processes one block of all contexts in the group. Returns once all contexts are processed. */
+    void process();
+
+    /**
+     * Returns the number of workers, including the thread calling <code>process()</code>. It is
+     * smaller than requested if not all worker threads could be started.
+     */
+    unsigned int getNumWorkers() { return (unsigned int) workers.size(); }
+
+    /**
+     * Returns the timing of every context in the group, with length n. The wall time of the last
+     * call to <code>process()</code> is returned in <code>totalMicros</code>. The array must be freed
+     * by the caller.
+     */
+    ZGContextTiming *getTiming(unsigned int *n, double *totalMicros);
+
+  private:
+    typedef struct GroupMember {
+      PdContext *context;
+      float *inputBuffers;
+      float *outputBuffers;
+      unsigned int workerIndex;
+      unsigned int numBlocks;
+      uint64_t lastNs;
+      uint64_t sumNs;
+      uint64_t maxNs;
+    } GroupMember;
+
+    typedef struct Worker {
+      PdContextGroup *group;
+      unsigned int index;
+      pthread_t thread;
+      std::vector<GroupMember *> members;
+    } Worker;
+
+    static void *workerThread(void *worker);
+
+    /** Processes all contexts assigned to the given worker. */
+    static void processWorker(Worker *worker);
+
+    /** Returns the index of the worker with the smallest expected process time per block. */
+    unsigned int getLeastLoadedWorker();
+
+    std::vector<Worker *> workers;
+
+    /** Guards the membership of the group. It is held for the duration of <code>process()</code>. */
+    pthread_mutex_t groupLock;
+
+    /** Guards the fields below, used to start the workers and to wait for them to finish. */
+    pthread_mutex_t workerLock;
+    pthread_cond_t startCondition;
+    pthread_cond_t doneCondition;
+
+    /** Incremented for each block. Workers wait for it to change. */
+    unsigned int generation;
+
+    /** The number of worker threads which have not yet finished the current block. */
+    unsigned int numPendingWorkers;
+
+    bool isShuttingDown;
+
+    /** The wall time of the last call to <code>process()</code>. */
+    uint64_t lastProcessNs;
+};
+
+#endif // _PD_CONTEXT_GROUP_H_
@@ -40,6 +40,7 @@
 PdFileParser::PdFileParser(string directory, string filename) {
   rootPath = string(directory);
   fileName = string(filename);
+  referenceCount = 1;
   
   FILE *fp = fopen((directory+filename).c_str(), "rb"); // open the file in binary mode
   pos = 0; // initialise position in stringDesc
@@ -62,12 +63,14 @@ PdFileParser::PdFileParser(string directory, string filename) {
     
     nextLine(); // read the first line
     isDone = false;
+    splitMessages();
   }
 }
 
 PdFileParser::PdFileParser(string aString) {
   // if we're just loading a string, the default root path is "/"
   rootPath = string("/");
+  referenceCount = 1;
   
   if (aString.empty()) {
     isDone = true;
@@ -76,6 +79,7 @@ PdFileParser::PdFileParser(string aString) {
     pos = 0;
     nextLine(); // read the first line
     isDone = false;
+    splitMessages();
   }
 }
 
@@ -83,6 +87,22 @@ PdFileParser::~PdFileParser() {
   // nothing to do
 }
 
+PdFileParser *PdFileParser::retain() {
+  __sync_add_and_fetch(&referenceCount, 1);
+  return this;
+}
+
+void PdFileParser::release(PdFileParser *parser) {
+  if (parser != NULL && __sync_sub_and_fetch(&(parser->referenceCount), 1) == 0) delete parser;
+}
+
+void PdFileParser::splitMessages() {
+  string message;
+  while (!(message = nextMessage()).empty()) {
+    messages.push_back(message);
+  }
+}
+
 string PdFileParser::nextMessage() {
   if (!isDone) {
     message = line;
@@ -125,16 +145,22 @@ PdGraph *PdFileParser::execute(PdContext *context) {
   return execute(NULL, NULL, context, true);
 }
 
+PdGraph *PdFileParser::executeAbstraction(PdMessage *initMsg, PdGraph *graph, PdContext *context) {
+  PdGraph *abstraction = execute(initMsg, graph, context, false);
+  return (abstraction != graph) ? abstraction : NULL;
+}
+
 PdGraph *PdFileParser::execute(PdMessage *initMsg, PdGraph *graph, PdContext *context, bool isSubPatch) {
 #define OBJECT_LABEL_RESOLUTION_BUFFER_LENGTH 32
 #define RESOLUTION_BUFFER_LENGTH 512
 #define INIT_MESSAGE_MAX_ELEMENTS 32
   PdMessage *initMessage = PD_MESSAGE_ON_STACK(INIT_MESSAGE_MAX_ELEMENTS);
   
-  string message;
   MessageTable *lastArrayCreated = NULL;  // used to know on which table the #A line values have to be set
   int lastArrayCreatedIndex = 0;
-  while (!(message = nextMessage()).empty()) {
+  for (unsigned int m = 0; m < messages.size(); m++) {
+    const string &message = messages[m];
+    
     // create a non-const copy of message such that strtok can modify it
     char line[message.size()+1];
     strncpy(line, message.c_str(), sizeof(line));
@@ -203,30 +229,21 @@ PdGraph *PdFileParser::execute(PdMessage *initMsg, PdGraph *graph, PdContext *co
         // create the object
         MessageObject *messageObject = context->newObject(resBufferLabel, initMessage, graph);
         if (messageObject == NULL) { // object could not be created based on any known object factory functions
-          if (context->getAbstractionDataBase()->existsAbstraction(objectLabel)) {
-            PdFileParser *parser = new PdFileParser(context->getAbstractionDataBase()->getAbstraction(objectLabel));
-            messageObject = parser->execute(initMessage, graph, context, false);
-            delete parser;
-          } else {
-            string filename = string(objectLabel) + ".pd";
-            string directory = graph->findFilePath(filename.c_str());
-            if (directory.empty()) {
-              // if the system cannot find the file itself, make a final effort to find the file via
-              // the user supplied callback
-              if (context->callbackFunction != NULL) {
-                char *dir = (char *) context->callbackFunction(ZG_CANNOT_FIND_OBJECT,
-                  context->callbackUserData, objectLabel);
-                if (dir != NULL) {
-                // TODO(mhroth): create new object based on returned path
-                  free(dir); // free the returned objectpath
-                } else {
-                  context->printErr("Unknown object or abstraction '%s'.", objectLabel);
-                }
-              }
+          // the parsed abstraction is cached by the context, and is not read again
+          PdFileParser *parser = context->getAbstractionTemplate(objectLabel, graph);
+          if (parser != NULL) {
+            messageObject = parser->executeAbstraction(initMessage, graph, context);
+          } else if (context->callbackFunction != NULL) {
+            // if the system cannot find the file itself, make a final effort to find the file via
+            // the user supplied callback
+            char *dir = (char *) context->callbackFunction(ZG_CANNOT_FIND_OBJECT,
+              context->callbackUserData, objectLabel);
+            if (dir != NULL) {
+            // TODO(mhroth): create new object based on returned path
+              free(dir); // free the returned objectpath
+            } else {
+              context->printErr("Unknown object or abstraction '%s'.", objectLabel);
             }
-            PdFileParser *parser = new PdFileParser(directory, filename);
-            messageObject = parser->execute(initMessage, graph, context, false);
-            delete parser;
           }
         } else {
           // add the object to the local graph and make any necessary registrations
@@ -305,7 +322,7 @@ PdGraph *PdFileParser::execute(PdMessage *initMsg, PdGraph *graph, PdContext *co
         context->printErr("#A line but no array were created");
       } else {
         int bufferLength = 0;
-        float *buffer = lastArrayCreated->getBuffer(&bufferLength);
+        float *buffer = lastArrayCreated->getWritableBuffer(&bufferLength);
         char *token = NULL;
         
         int index = atoi(strtok(NULL, " ;"));
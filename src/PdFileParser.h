@@ -31,6 +31,7 @@
 #define _PD_FILE_PARSER_H_
 
 #include <string>
+#include <vector>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -46,6 +47,11 @@ using namespace std;
  * no more are available. Messages are returned as strings (<code>char*</code>), which represent
  * the entire logical message (though the original message may have been broken up over several
  * lines in the file.
+ *
+ * The description is split into messages once, on construction. A parser may then be executed any
+ * number of times, which is how <code>PdContext</code> caches abstraction templates. Executing does
+ * not modify the parser, so that one parser may be shared by any number of contexts. It is
+ * reference counted, and deleted with <code>release()</code>.
  */
 class PdFileParser {
 
@@ -56,9 +62,24 @@ class PdFileParser {
   
     PdGraph *execute(PdContext *context);
 
+    /**
+     * Instantiates the parsed description as an abstraction with the given arguments, inside of the
+     * given graph. Returns <code>NULL</code> if nothing could be instantiated.
+     */
+    PdGraph *executeAbstraction(PdMessage *initMsg, PdGraph *graph, PdContext *context);
+
+    /** Adds a reference to this parser, which is returned. */
+    PdFileParser *retain();
+  
+    /** Releases a reference to the given parser, which is deleted with its last reference. */
+    static void release(PdFileParser *parser);
+
   private:
     PdGraph *execute(PdMessage *initMsg, PdGraph *graph, PdContext *context, bool isSubPatch);
 
+    /** Splits the whole description into the <code>messages</code> list. */
+    void splitMessages();
+
     /**
      * Returns the next logical message in the file, or <code>NULL</code> if the end of the file
      * has been reached.
@@ -79,6 +100,12 @@ class PdFileParser {
     string rootPath;
     string fileName; // the name of the file that is being parsed
     bool isDone;
+
+    /** All logical messages of the description, in order. */
+    vector<string> messages;
+  
+    /** The number of references to this parser. Changed atomically. */
+    int referenceCount;
 };
 
 #endif // _PD_FILE_PARSER_H_
@@ -27,10 +27,13 @@
  *
  */
 
+#include "ArrayArithmetic.h"
+#include "BufferPool.h"
 #include "DeclareList.h"
 #include "DspImplicitAdd.h"
 #include "DspInlet.h"
 #include "DspOutlet.h"
+#include "DspProfiler.h"
 #include "DspTablePlay.h"
 #include "DspTableRead.h"
 #include "DspTableRead4.h"
@@ -39,6 +42,7 @@
 #include "MessageTableRead.h"
 #include "MessageTableWrite.h"
 #include "PdContext.h"
+#include "PdFileParser.h"
 #include "PdGraph.h"
 #include "StaticUtils.h"
 
@@ -56,9 +60,17 @@ PdGraph::PdGraph(PdMessage *initMessage, PdGraph *parentGraph, PdContext *contex
   nodeList = list<MessageObject *>();
   dspNodeList = list<DspObject *>();
   declareList = new DeclareList();
+  description = NULL;
   // all graphs start out unattached to any context, though they exist in a context
   isAttachedToContext = false;
   switched = true; // graphs are switched on by default
+  isAsleep = false;
+  numSilentBlocks = 0;
+  isOutputSilent = false;
+  hasSideEffectsInProcessOrder = false;
+  silenceState = NULL;
+  objectInletSilence = NULL;
+  isSilenceMapValid = false;
   processFunction = &processGraph;
       
   // initialise the graph arguments
@@ -75,6 +87,9 @@ PdGraph::PdGraph(PdMessage *initMessage, PdGraph *parentGraph, PdContext *contex
 PdGraph::~PdGraph() {
   graphArguments->freeMessage();
   delete declareList;
+  delete [] silenceState;
+  delete [] objectInletSilence;
+  PdFileParser::release(description);
 
   // remove all implicit +~~ objects
   for (list<DspObject *>::iterator it = dspNodeList.begin(); it != dspNodeList.end(); ++it) {
@@ -137,6 +152,8 @@ void PdGraph::addObject(float canvasX, float canvasY, MessageObject *messageObje
     }
   }
   
+  if (isAttachedToContext && messageObject->doesProcessAudio()) context->invalidateProcessOrder();
+  
   unlockContextIfAttached();
 }
 
@@ -177,11 +194,16 @@ void PdGraph::removeObject(MessageObject *object) {
       // remove the object from the dspNodeList if the object processes audio
       if (object->doesProcessAudio()) {
         dspNodeList.remove((DspObject *) object);
+        invalidateSilenceMap();
       }
       
       // remove the object from any special lists if it is in any of them (e.g., receive, throw~, etc.)
       unregisterObject(object);
       
+      // the profiler may not reference deleted objects
+      context->getProfiler()->clear();
+      if (isAttachedToContext && object->doesProcessAudio()) context->invalidateProcessOrder();
+      
       // delete the object
       delete object;
       
@@ -228,7 +250,9 @@ void PdGraph::addLetObjectToLetList(MessageObject *inletObject, float newPositio
 void PdGraph::registerObject(MessageObject *messageObject) {
   switch (messageObject->getObjectType()) {
     case MESSAGE_RECEIVE:
-    case MESSAGE_NOTEIN: {
+    case MESSAGE_NOTEIN:
+    case MESSAGE_CTLIN:
+    case MESSAGE_BENDIN: {
       context->registerRemoteMessageReceiver(reinterpret_cast<RemoteMessageReceiver *>(messageObject));
       break;
     }
@@ -250,6 +274,10 @@ void PdGraph::registerObject(MessageObject *messageObject) {
       context->registerDspCatch((DspCatch *) messageObject);
       break;
     }
+    case DSP_ADC: {
+      context->registerDspAdc((DspAdc *) messageObject);
+      break;
+    }
     case DSP_DELAY_READ:
     case DSP_VARIABLE_DELAY: {
       context->registerDelayReceiver((DelayReceiver *) messageObject);
@@ -293,7 +321,9 @@ void PdGraph::unregisterObject(MessageObject *messageObject) {
   // TODO(mhroth)
   switch (messageObject->getObjectType()) {
     case MESSAGE_RECEIVE:
-    case MESSAGE_NOTEIN: {
+    case MESSAGE_NOTEIN:
+    case MESSAGE_CTLIN:
+    case MESSAGE_BENDIN: {
       context->unregisterRemoteMessageReceiver((RemoteMessageReceiver *) messageObject);
       break;
     }
@@ -313,6 +343,18 @@ void PdGraph::unregisterObject(MessageObject *messageObject) {
       context->unregisterDspReceive((DspReceive *) messageObject);
       break;
     }
+    case DSP_THROW: {
+      context->unregisterDspThrow((DspThrow *) messageObject);
+      break;
+    }
+    case DSP_CATCH: {
+      context->unregisterDspCatch((DspCatch *) messageObject);
+      break;
+    }
+    case DSP_ADC: {
+      context->unregisterDspAdc((DspAdc *) messageObject);
+      break;
+    }
     case DSP_TABLE_PLAY: {
       context->unregisterTableReceiver((DspTablePlay *) messageObject);
       break;
@@ -367,27 +409,29 @@ char *PdGraph::resolveFullPath(const char *filename) {
 }
 
 string PdGraph::findFilePath(const char *filename) {
+  list<string> searchPath;
+  getSearchPath(&searchPath);
+  return context->findFilePath(searchPath, filename);
+}
+
+void PdGraph::getSearchPath(list<string> *searchPath) {
   for (list<string>::iterator it = declareList->getIterator(); it != declareList->getEnd(); ++it) {
-    string directory = *it;
-    string fullPath = directory + string(filename);
-    if (StaticUtils::fileExists(fullPath.c_str())) {
-      return directory;
-    }
+    searchPath->push_back(*it);
   }
-  return isRootGraph() ? "" : parentGraph->findFilePath(filename);
+  if (!isRootGraph()) parentGraph->getSearchPath(searchPath);
 }
 
 void PdGraph::addDeclarePath(const char *path) {
-  if (isRootGraph()) {
-    declareList->addPath(path);
+  if (!isRootGraph() && graphId == parentGraph->getGraphId()) {
+    // this graph is a subgraph (not an abstraction) of the parent graph
+    // so the parent should handle the declared path
+    parentGraph->addDeclarePath(path);
   } else {
-    if (graphId == parentGraph->getGraphId()) {
-      // this graph is a subgraph (not an abstraction) of the parent graph
-      // so the parent should handle the declared path
-      parentGraph->addDeclarePath(path);
-    } else {
-      declareList->addPath(path);
-    }
+    // lookups made with the old search path of this graph are forgotten. Those of its children are
+    // keyed by their own search paths, which change with it
+    list<string> searchPath;
+    getSearchPath(&searchPath);
+    if (declareList->addPath(path)) context->clearFileLookups(searchPath);
   }
 }
 
@@ -417,7 +461,7 @@ void PdGraph::receiveMessage(int inletIndex, PdMessage *message) {
 void PdGraph::processGraph(DspObject *dspObject, int fromIndex, int toIndex) {
   PdGraph *d = reinterpret_cast<PdGraph *>(dspObject);
   
-  if (d->switched) {
+  if (d->beginBlock(toIndex)) {
     // when inlets are processed, they will resolve their buffers and everything will proceed as normal
     
     // process all dsp objects
@@ -425,11 +469,170 @@ void PdGraph::processGraph(DspObject *dspObject, int fromIndex, int toIndex) {
     
     // TODO(mhroth): iterate depending on local blocksize relative to parent
     // execute all nodes which process audio
-    for (list<DspObject *>::iterator it = d->dspNodeList.begin(); it != d->dspNodeList.end(); ++it) {
-      DspObject *dspObject = *it;
-      dspObject->processFunction(dspObject, 0, d->blockSizeInt);
+    DspProfiler *profiler = d->context->getProfiler();
+    if (profiler->isEnabled()) {
+      for (list<DspObject *>::iterator it = d->dspNodeList.begin(); it != d->dspNodeList.end(); ++it) {
+        DspObject *dspObject = *it;
+        uint64_t start = DspProfiler::getTime();
+        dspObject->processFunction(dspObject, 0, d->blockSizeInt);
+        profiler->record(dspObject, DspProfiler::getTime() - start);
+      }
+    } else {
+      for (list<DspObject *>::iterator it = d->dspNodeList.begin(); it != d->dspNodeList.end(); ++it) {
+        DspObject *dspObject = *it;
+        dspObject->processFunction(dspObject, 0, d->blockSizeInt);
+      }
+    }
+    d->endBlock();
+  }
+}
+
+bool PdGraph::beginBlock(int toIndex) {
+  if (!switched) return false;
+  if (isAsleep) {
+    if (isInputSilent()) {
+      // the outlet buffers may have been reused by other objects since the graph fell asleep
+      float *zeroBuffer = getBufferPool()->getZeroBuffer();
+      for (unsigned int i = 0; i < outletList.size(); ++i) {
+        float *buffer = getDspBufferAtOutlet(i);
+        if (buffer != NULL && buffer != zeroBuffer) ArrayArithmetic::fill(buffer, 0.0f, 0, toIndex);
+      }
+      isOutputSilent = true;
+      return false;
+    }
+    wake();
+  }
+  return true;
+}
+
+void PdGraph::endBlock() {
+  // The graph must be found silent in two consecutive blocks before falling asleep. The first
+  // block flushes any remaining state (e.g. in [send~] or [throw~]) to silence.
+  isOutputSilent = isInputSilent() && isSilentWithSilentInput();
+  if (isOutputSilent) {
+    if (++numSilentBlocks >= 2) {
+      isAsleep = true;
+      onSleep();
+    }
+  } else {
+    numSilentBlocks = 0;
+  }
+}
+
+void PdGraph::wake() {
+  for (PdGraph *g = this; g != NULL; g = g->parentGraph) {
+    g->isAsleep = false;
+    g->numSilentBlocks = 0;
+  }
+}
+
+bool PdGraph::isInputSilent() {
+  float *zeroBuffer = getBufferPool()->getZeroBuffer();
+  for (unsigned int i = 0; i < inletList.size(); ++i) {
+    float *buffer = getDspBufferAtInlet(i);
+    if (buffer != NULL && buffer != zeroBuffer && !ArrayArithmetic::isZero(buffer, 0, blockSizeInt)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void PdGraph::onSleep() {
+  for (unsigned int i = 0; i < silenceNodes.size(); ++i) {
+    silenceNodes[i]->onSleep();
+  }
+}
+
+void PdGraph::computeSilenceMap() {
+  // Buffers are reused by the BufferPool, so the silence of a buffer is always that of its most
+  // recent writer in the process order.
+  map<float *, unsigned int> bufferSlots;
+  bufferSlots[getBufferPool()->getZeroBuffer()] = 0;
+  for (unsigned int i = 0; i < inletList.size(); ++i) {
+    float *buffer = getDspBufferAtInlet(i);
+    if (buffer != NULL) bufferSlots[buffer] = 2 + i;
+  }
+  
+  silenceNodes.assign(dspNodeList.begin(), dspNodeList.end());
+  silenceSourceOffsets.clear();
+  silenceSources.clear();
+  outletSilenceSources.clear();
+  hasSideEffectsInProcessOrder = false;
+  unsigned int maxInlets = 0;
+  for (unsigned int k = 0; k < silenceNodes.size(); ++k) {
+    DspObject *dspObject = silenceNodes[k];
+    bool isGraph = (dspObject->getObjectType() == OBJECT_PD);
+    hasSideEffectsInProcessOrder |= dspObject->hasSideEffects();
+    
+    silenceSourceOffsets.push_back(silenceSources.size());
+    unsigned int numInlets = isGraph ? dspObject->getNumInlets() : dspObject->getNumDspInlets();
+    if (numInlets > maxInlets) maxInlets = numInlets;
+    for (unsigned int i = 0; i < numInlets; ++i) {
+      float *buffer = dspObject->getDspBufferAtInlet(i);
+      map<float *, unsigned int>::iterator it = bufferSlots.find(buffer);
+      silenceSources.push_back((buffer == NULL) ? 0 : (it == bufferSlots.end()) ? 1 : it->second);
+    }
+    
+    // the buffers of folded objects are constant or passed through, and keep the silence of their writers
+    if (dspObject->isFoldedAway()) continue;
+    
+    unsigned int numOutlets = isGraph ? dspObject->getNumOutlets() : dspObject->getNumDspOutlets();
+    for (unsigned int i = 0; i < numOutlets; ++i) {
+      float *buffer = dspObject->getDspBufferAtOutlet(i);
+      if (buffer != NULL) bufferSlots[buffer] = 2 + inletList.size() + k;
+    }
+  }
+  silenceSourceOffsets.push_back(silenceSources.size());
+  
+  for (unsigned int i = 0; i < outletList.size(); ++i) {
+    float *buffer = getDspBufferAtOutlet(i);
+    map<float *, unsigned int>::iterator it = bufferSlots.find(buffer);
+    outletSilenceSources.push_back((buffer == NULL) ? 0 : (it == bufferSlots.end()) ? 1 : it->second);
+  }
+  
+  delete [] silenceState;
+  delete [] objectInletSilence;
+  silenceState = new bool[2 + inletList.size() + silenceNodes.size()];
+  objectInletSilence = new bool[maxInlets + 1];
+  isSilenceMapValid = true;
+}
+
+void PdGraph::invalidateSilenceMap() {
+  isSilenceMapValid = false;
+  context->invalidateSilenceMaps();
+}
+
+void PdGraph::updateSilenceMaps() {
+  if (!isSilenceMapValid) computeSilenceMap();
+  for (list<MessageObject *>::iterator it = nodeList.begin(); it != nodeList.end(); ++it) {
+    if ((*it)->getObjectType() == OBJECT_PD) ((PdGraph *) *it)->updateSilenceMaps();
+  }
+}
+
+bool PdGraph::isSilentWithSilentInput() {
+  // the graph stays awake until the map has been recomputed off the audio thread
+  if (!isSilenceMapValid) return false;
+  
+  silenceState[0] = true;
+  silenceState[1] = false;
+  unsigned int numInlets = inletList.size();
+  for (unsigned int i = 0; i < numInlets; ++i) silenceState[2+i] = true;
+  
+  bool *objectSilenceState = silenceState + 2 + numInlets;
+  for (unsigned int k = 0; k < silenceNodes.size(); ++k) {
+    DspObject *dspObject = silenceNodes[k];
+    for (unsigned int i = silenceSourceOffsets[k], j = 0; i < silenceSourceOffsets[k+1]; ++i, ++j) {
+      objectInletSilence[j] = silenceState[silenceSources[i]];
     }
+    bool isSilent = !dspObject->hasPendingMessages() && dspObject->isSilentWithInput(objectInletSilence);
+    if (!isSilent && dspObject->hasSideEffects()) return false;
+    objectSilenceState[k] = isSilent;
   }
+  
+  for (unsigned int i = 0; i < outletSilenceSources.size(); ++i) {
+    if (!silenceState[outletSilenceSources[i]]) return false;
+  }
+  return true;
 }
 
 
@@ -454,6 +657,11 @@ void PdGraph::addConnection(MessageObject *fromObject, int outletIndex, MessageO
   // the appropriate changes. Usually a complete reevaluation shouldn't be necessary, and otherwise
   // the use of a linked list to store the node list should make the reordering fast.
   //  computeDeepLocalDspProcessOrder(); 
+  // Instead the process order is recomputed once when the context lock is released, no matter how
+  // many connections have changed.
+  if (isAttachedToContext && fromObject->getConnectionType(outletIndex) == DSP) {
+    context->invalidateProcessOrder();
+  }
   
   unlockContextIfAttached();
 }
@@ -478,6 +686,9 @@ void PdGraph::removeConnection(MessageObject *fromObject, int outletIndex, Messa
   lockContextIfAttached();
   toObject->removeConnectionFromObjectToInlet(fromObject, outletIndex, inletIndex);
   fromObject->removeConnectionToObjectFromOutlet(toObject, inletIndex, outletIndex);
+  if (isAttachedToContext && fromObject->getConnectionType(outletIndex) == DSP) {
+    context->invalidateProcessOrder();
+  }
   unlockContextIfAttached();
 }
 
@@ -596,6 +807,13 @@ void PdGraph::setDspBufferAtOutlet(float *buffer, unsigned int outletIndex) {
   // nothing to do because DspOutlet objects do not allow setting outlet buffers
 }
 
+void PdGraph::addBufferReader(unsigned int outletIndex, DspObject *reader, unsigned int inletIndex) {
+  MessageObject *outletObject = outletList[outletIndex];
+  if (outletObject->getObjectType() == DSP_OUTLET) {
+    reinterpret_cast<DspOutlet *>(outletObject)->addBufferReader(0, reader, inletIndex);
+  }
+}
+
 float *PdGraph::getDspBufferAtInlet(int inletIndex) {
   MessageObject *inletObject = inletList[inletIndex];
   if (inletObject->getObjectType() == DSP_INLET) {
@@ -687,8 +905,13 @@ void PdGraph::computeDeepLocalDspProcessOrder() {
       delete dspObject;
     }
   }
+  context->getProfiler()->clear(); // deleted +~~ objects may have been profiled
   
   dspNodeList.clear();
+  wake(); // the new process order may not be silent
+
+  list<DspObject *> firstProcessOrder = getFirstProcessOrder();
+  dspNodeList.splice(dspNodeList.end(), firstProcessOrder);
 
   // for all leaf nodes, order the tree
   for (list<MessageObject *>::iterator it = leafNodeList.begin(); it != leafNodeList.end(); ++it) {
@@ -696,6 +919,8 @@ void PdGraph::computeDeepLocalDspProcessOrder() {
     list<DspObject *> processSubList = object->getProcessOrder();
     dspNodeList.splice(dspNodeList.end(), processSubList);
   }
+  computeSilenceMap();
+  onProcessOrderComputed();
   
   /* print out process order of local dsp objects (for debugging) */
   /*
@@ -766,6 +991,11 @@ PdMessage *PdGraph::getArguments() {
   return graphArguments;
 }
 
+void PdGraph::setDescription(PdFileParser *parser) {
+  PdFileParser::release(description);
+  description = parser;
+}
+
 int PdGraph::getNumInputChannels() {
   return context->getNumInputChannels();
 }
@@ -786,12 +1016,21 @@ MessageTable *PdGraph::getTable(char *name) {
   return context->getTable(name);
 }
 
+void PdGraph::renameTableReceiver(TableReceiverInterface *tableReceiver, const char *oldName) {
+  // table receivers are only registered while the graph is attached
+  if (isAttachedToContext) context->renameTableReceiver(tableReceiver, oldName);
+}
+
 ConnectionType PdGraph::getConnectionType(int outletIndex) {
   // return the connection type depending on the type of outlet object
   MessageObject *messageObject = (MessageObject *) outletList.at(outletIndex);
   return messageObject->getConnectionType(0);
 }
 
+ConnectionType PdGraph::getInletConnectionType(int inletIndex) {
+  return (inletList.at(inletIndex)->getObjectType() == DSP_INLET) ? DSP : MESSAGE;
+}
+
 bool PdGraph::doesProcessAudio() {
   // This graph processes audio if it contains any nodes which process audio.
   // This works because graph objects are only created after they have been filled with objects.
@@ -814,6 +1053,7 @@ PdGraph *PdGraph::getParentGraph() {
 
 void PdGraph::setSwitch(bool switched) {
   this->switched = switched;
+  wake();
 }
 
 bool PdGraph::isSwitchedOn() {
@@ -844,6 +1084,18 @@ list<MessageObject *> PdGraph::getNodeList() {
   return nodeList;
 }
 
+list<DspObject *> PdGraph::getDspNodeList() {
+  return dspNodeList;
+}
+
+list<DspObject *> PdGraph::getFirstProcessOrder() {
+  return list<DspObject *>();
+}
+
+void PdGraph::onProcessOrderComputed() {
+  // nothing to do
+}
+
 BufferPool *PdGraph::getBufferPool() {
   return context->getBufferPool();
 }
@@ -30,6 +30,7 @@
 #ifndef _PD_GRAPH_H_
 #define _PD_GRAPH_H_
 
+#include <map>
 #include "DspObject.h"
 #include "OrderedMessageQueue.h"
 
@@ -43,10 +44,12 @@ class DspSend;
 class DspThrow;
 class LetInterface;
 class MessageObject;
+class PdFileParser;
 class MessageReceive;
 class MessageSend;
 class MessageTable;
 class PdContext;
+class TableReceiverInterface;
 
 class PdGraph : public DspObject {
   
@@ -102,6 +105,9 @@ class PdGraph : public DspObject {
     string toString() { return name.empty() ? string(getObjectLabel()) : name; }
   
     ConnectionType getConnectionType(int outletIndex);
+
+    /** Returns the connection type accepted by the given inlet, depending on its inlet object. */
+    ConnectionType getInletConnectionType(int inletIndex);
   
     bool doesProcessAudio();
     
@@ -110,6 +116,41 @@ class PdGraph : public DspObject {
   
     /** Returns <code>true</code> if the audio processing of this graph is turned on. <code>false</code> otherwise. */
     bool isSwitchedOn();
+  
+    /**
+     * Wakes this graph and all of its parents from sleep, such that they are processed in the next
+     * block. Called whenever a message arrives at one of the graph's objects.
+     */
+    void wake();
+  
+    /**
+     * Called at the start of each block in which this graph is processed. Returns <code>false</code>
+     * if the graph is switched off or stays asleep, in which case its objects are not processed.
+     */
+    bool beginBlock(int toIndex);
+  
+    /** Called at the end of each block in which the objects of this graph were processed. */
+    void endBlock();
+  
+    /** Returns <code>true</code> if this graph is asleep and its objects are not being processed. */
+    bool isSleeping() { return isAsleep; }
+  
+    /** Returns the silence of the outlets found at the end of the most recent block. */
+    bool isSilentWithInput(const bool *isInletSilent) const { return !switched || isOutputSilent; }
+    bool hasSideEffects() { return hasSideEffectsInProcessOrder; }
+    void onSleep();
+  
+    /**
+     * The silence map is no longer valid, e.g. because an object has unfolded. The graph does not
+     * fall asleep until the context has recomputed the map, which is never done on the audio thread.
+     */
+    void invalidateSilenceMap();
+  
+    /** Recomputes the invalid silence maps of this graph and all of its subgraphs. */
+    void updateSilenceMaps();
+  
+    /** Readers of an outlet of this graph read the buffer of the corresponding outlet~. */
+    void addBufferReader(unsigned int outletIndex, DspObject *reader, unsigned int inletIndex);
     
     /** Set the current block size of this subgraph. */
     void setBlockSize(int blockSize);
@@ -131,6 +172,13 @@ class PdGraph : public DspObject {
     
     /** Get the argument list in the form of a <code>PdMessage</code> from the graph. */
     PdMessage *getArguments();
+
+    /**
+     * Sets the parsed description from which this root graph was created, such that it can be
+     * created again when its context is cloned. The graph takes ownership of the parser.
+     */
+    void setDescription(PdFileParser *parser);
+    PdFileParser *getDescription() { return description; }
     
     /** Returns the global sample rate. */
     float getSampleRate();
@@ -171,6 +219,9 @@ class PdGraph : public DspObject {
     /** Gets the named (global) table object. */
     MessageTable *getTable(char *name);
   
+    /** Files a table receiver under its new name, after it has been renamed from <code>oldName</code>. */
+    void renameTableReceiver(TableReceiverInterface *tableReceiver, const char *oldName);
+  
     /** Add an object to the graph, taking care of any special object registration. */
     void addObject(float canvasX, float canvasY, MessageObject *node);
   
@@ -191,6 +242,9 @@ class PdGraph : public DspObject {
      */
     string findFilePath(const char *filename);
   
+    /** Appends the declared directories of this graph and of its ancestors to the given search path. */
+    void getSearchPath(list<string> *searchPath);
+  
     /**
      * Resolves the full path of the given file. If the file is already fully specified then a copy
      * of the string is returned. Otherwise all declared paths are searched and the full path is
@@ -219,6 +273,9 @@ class PdGraph : public DspObject {
     /** Returns this PdGraph's node list. */
     list<MessageObject *> getNodeList();
   
+    /** Returns this PdGraph's process order. */
+    list<DspObject *> getDspNodeList();
+  
     list<ObjectLetPair> getIncomingConnections(unsigned int inletIndex);
     list<ObjectLetPair> getOutgoingConnections(unsigned int outletIndex);
   
@@ -233,9 +290,19 @@ class PdGraph : public DspObject {
     /** Set the graph name. */
     void setName(string newName) { name = newName; }
   
-  private:
+  protected:
     static void processGraph(DspObject *dspObject, int fromIndex, int toIndex);
   
+    /**
+     * Returns the process order of the objects which are ordered before all leaf nodes when the
+     * process order of this graph is computed. Empty by default.
+     */
+    virtual list<DspObject *> getFirstProcessOrder();
+  
+    /** Called once the process order of this graph has been computed. */
+    virtual void onProcessOrderComputed();
+  
+  private:
     /** Create a new object based on its initialisation string. */
     MessageObject *newObject(char *objectType, char *objectLabel, PdMessage *initMessage, PdGraph *graph);
   
@@ -248,6 +315,21 @@ class PdGraph : public DspObject {
   
     void addLetObjectToLetList(MessageObject *inletObject, float newPosition, vector<MessageObject *> *letList);
   
+    /** Returns <code>true</code> if the signal at all dsp inlets is silent in the current block. */
+    bool isInputSilent();
+  
+    /**
+     * Maps the dsp inlets of each object in the process order to the slot of the silence state of
+     * the object which last wrote the inlet's buffer. Called once the process order is computed.
+     */
+    void computeSilenceMap();
+  
+    /**
+     * Returns <code>true</code> if all side effects and outlets of this graph are silent in the next
+     * block, given silent input. Propagates silence through the process order using the silence map.
+     */
+    bool isSilentWithSilentInput();
+  
     /** The <code>PdContext</code> to which this graph belongs. */
     PdContext *context;
   
@@ -265,6 +347,38 @@ class PdGraph : public DspObject {
 
     /** True if the graph is switch on and should process audio. False otherwise. */
     bool switched;
+  
+    /**
+     * True if the graph is asleep. A graph falls asleep once its input and all of its objects have
+     * been found silent in two consecutive blocks. While asleep, its dsp objects are skipped and its
+     * outlets are silent. It is woken by any incoming message or non-silent input.
+     */
+    bool isAsleep;
+  
+    /** The number of consecutive blocks in which this graph has been found to be silent. */
+    int numSilentBlocks;
+  
+    /** True if the input and outlets of this graph were found silent at the end of the last block. */
+    bool isOutputSilent;
+  
+    /** True if any object in the process order has side effects. */
+    bool hasSideEffectsInProcessOrder;
+  
+    /**
+     * The silence map. Slot 0 of the silence state is always silent and slot 1 is never silent. They
+     * are followed by one slot for each graph inlet and then one for each object in the process order.
+     * The dsp inlets of object <i>k</i> read the slots <code>silenceSources[silenceSourceOffsets[k]]</code>
+     * to <code>silenceSources[silenceSourceOffsets[k+1]-1]</code>.
+     */
+    vector<DspObject *> silenceNodes;
+    vector<unsigned int> silenceSourceOffsets;
+    vector<unsigned int> silenceSources;
+    vector<unsigned int> outletSilenceSources;
+    bool *silenceState;
+    bool *objectInletSilence;
+  
+    /** False if the buffers or objects in the process order have changed since the silence map was computed. */
+    bool isSilenceMapValid;
     
     /** The parent graph. NULL if this graph is the root. */
     PdGraph *parentGraph;
@@ -286,6 +400,9 @@ class PdGraph : public DspObject {
   
     /** A global list of all declared directories (-path and -stdpath) */
     DeclareList *declareList;
+
+    /** The description of a root graph created from a file or string, otherwise <code>NULL</code>. */
+    PdFileParser *description;
   
     /** PdGraphs may have an associated name, such as their abstraction name. */
     string name;
@@ -0,0 +1,139 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#include <list>
+#include <set>
+#include "MessageObject.h"
+#include "PdContext.h"
+#include "PdGraph.h"
+#include "PdGraphTransaction.h"
+
+PdGraphTransaction::PdGraphTransaction(PdGraph *graph) {
+  this->graph = graph;
+  isCommitted = false;
+}
+
+PdGraphTransaction::~PdGraphTransaction() {
+  if (!isCommitted) {
+    for (unsigned int i = 0; i < edits.size(); i++) {
+      if (edits[i].type == ADD_OBJECT) delete edits[i].fromObject;
+    }
+  }
+}
+
+void PdGraphTransaction::addObject(MessageObject *object, float canvasX, float canvasY) {
+  GraphEdit edit = {ADD_OBJECT, object, 0, NULL, 0, canvasX, canvasY};
+  edits.push_back(edit);
+}
+
+void PdGraphTransaction::removeObject(MessageObject *object) {
+  GraphEdit edit = {REMOVE_OBJECT, object, 0, NULL, 0, 0.0f, 0.0f};
+  edits.push_back(edit);
+}
+
+void PdGraphTransaction::addConnection(MessageObject *fromObject, int outletIndex,
+    MessageObject *toObject, int inletIndex) {
+  GraphEdit edit = {ADD_CONNECTION, fromObject, outletIndex, toObject, inletIndex, 0.0f, 0.0f};
+  edits.push_back(edit);
+}
+
+void PdGraphTransaction::removeConnection(MessageObject *fromObject, int outletIndex,
+    MessageObject *toObject, int inletIndex) {
+  GraphEdit edit = {REMOVE_CONNECTION, fromObject, outletIndex, toObject, inletIndex, 0.0f, 0.0f};
+  edits.push_back(edit);
+}
+
+bool PdGraphTransaction::validate() {
+  // the objects of the graph as they will be after each edit
+  list<MessageObject *> nodeList = graph->getNodeList();
+  set<MessageObject *> objects(nodeList.begin(), nodeList.end());
+  
+  for (unsigned int i = 0; i < edits.size(); i++) {
+    GraphEdit &edit = edits[i];
+    switch (edit.type) {
+      case ADD_OBJECT: {
+        if (edit.fromObject == NULL || edit.fromObject->getGraph() != graph ||
+            !objects.insert(edit.fromObject).second) {
+          graph->printErr("Transaction edit %u adds an invalid object. No edits applied.", i);
+          return false;
+        }
+        break;
+      }
+      case REMOVE_OBJECT: {
+        if (objects.erase(edit.fromObject) == 0) {
+          graph->printErr("Transaction edit %u removes an object which is not in the graph. "
+              "No edits applied.", i);
+          return false;
+        }
+        break;
+      }
+      case ADD_CONNECTION:
+      case REMOVE_CONNECTION: {
+        if (objects.find(edit.fromObject) == objects.end() ||
+            objects.find(edit.toObject) == objects.end()) {
+          graph->printErr("Transaction edit %u connects an object which is not in the graph. "
+              "No edits applied.", i);
+          return false;
+        }
+        if (edit.outletIndex < 0 ||
+            (unsigned int) edit.outletIndex >= edit.fromObject->getNumOutlets() ||
+            edit.inletIndex < 0 ||
+            (unsigned int) edit.inletIndex >= edit.toObject->getNumInlets()) {
+          graph->printErr("Transaction edit %u has a mismatched connection from %s:%i to %s:%i. "
+              "No edits applied.", i, edit.fromObject->toString().c_str(), edit.outletIndex,
+              edit.toObject->toString().c_str(), edit.inletIndex);
+          return false;
+        }
+        // a signal outlet may only be connected to a signal inlet, as in Pd
+        if (edit.type == ADD_CONNECTION &&
+            edit.fromObject->getConnectionType(edit.outletIndex) == DSP &&
+            edit.toObject->getInletConnectionType(edit.inletIndex) != DSP) {
+          graph->printErr("Transaction edit %u connects the signal outlet %s:%i to the message inlet "
+              "%s:%i. No edits applied.", i, edit.fromObject->toString().c_str(), edit.outletIndex,
+              edit.toObject->toString().c_str(), edit.inletIndex);
+          return false;
+        }
+        break;
+      }
+      default: break;
+    }
+  }
+  return true;
+}
+
+bool PdGraphTransaction::commit() {
+  if (isCommitted) return false;
+  
+  // validate under the same lock as the edits, such that no other thread can change the graph
+  // in between. The lock is recursive, so the graph does not acquire it again for each edit.
+  PdContext *context = graph->getContext();
+  context->lock();
+  if (!validate()) {
+    context->unlock();
+    return false;
+  }
+  isCommitted = true;
+  for (unsigned int i = 0; i < edits.size(); i++) {
+    GraphEdit &edit = edits[i];
+    switch (edit.type) {
+      case ADD_OBJECT: graph->addObject(edit.canvasX, edit.canvasY, edit.fromObject); break;
+      case REMOVE_OBJECT: graph->removeObject(edit.fromObject); break;
+      case ADD_CONNECTION: {
+        graph->addConnection(edit.fromObject, edit.outletIndex, edit.toObject, edit.inletIndex);
+        break;
+      }
+      case REMOVE_CONNECTION: {
+        graph->removeConnection(edit.fromObject, edit.outletIndex, edit.toObject, edit.inletIndex);
+        break;
+      }
+      default: break;
+    }
+  }
+  // the process order is recomputed once, as the lock is released
+  context->unlock();
+  return true;
+}
@@ -0,0 +1,81 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#ifndef _PD_GRAPH_TRANSACTION_H_
+#define _PD_GRAPH_TRANSACTION_H_
+
+#include <vector>
+
+using namespace std;
+
+class MessageObject;
+class PdGraph;
+
+/**
+ * Collects edits of a graph, i.e. added and removed objects and connections, and applies them
+ * together. Only the new objects are constructed outside of the context lock. <code>commit()</code>
+ * validates and applies the edits in order within a single lock acquisition, after which the
+ * process order is recomputed once. If any edit is invalid, none are applied.
+ */
+class PdGraphTransaction {
+
+  public:
+    PdGraphTransaction(PdGraph *graph);
+
+    /** Objects added to a transaction which has not been committed are deleted. */
+    ~PdGraphTransaction();
+
+    /**
+     * Adds a new object to the graph. The object must have been created for the graph but not
+     * added to it. It may be used in subsequent edits of this transaction.
+     */
+    void addObject(MessageObject *object, float canvasX, float canvasY);
+
+    void removeObject(MessageObject *object);
+
+    void addConnection(MessageObject *fromObject, int outletIndex, MessageObject *toObject,
+        int inletIndex);
+
+    void removeConnection(MessageObject *fromObject, int outletIndex, MessageObject *toObject,
+        int inletIndex);
+
+    /**
+     * Validates and applies all edits. Returns <code>true</code> if they have been applied, or
+     * <code>false</code> if an edit is invalid, in which case the graph is unchanged. A transaction
+     * can only be committed once.
+     */
+    bool commit();
+
+    PdGraph *getGraph() { return graph; }
+
+  private:
+    typedef enum GraphEditType {
+      ADD_OBJECT,
+      REMOVE_OBJECT,
+      ADD_CONNECTION,
+      REMOVE_CONNECTION
+    } GraphEditType;
+
+    typedef struct GraphEdit {
+      GraphEditType type;
+      MessageObject *fromObject; // the object of an object edit
+      int outletIndex;
+      MessageObject *toObject;
+      int inletIndex;
+      float canvasX;
+      float canvasY;
+    } GraphEdit;
+
+    /** Returns <code>true</code> if all edits can be applied in order. The context must be locked. */
+    bool validate();
+
+    PdGraph *graph;
+    vector<GraphEdit> edits;
+    bool isCommitted;
+};
+
+#endif // _PD_GRAPH_TRANSACTION_H_
@@ -0,0 +1,252 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#ifndef _SAMPLE_CONVERSION_H_
+#define _SAMPLE_CONVERSION_H_
+
+#include <math.h>
+#include <stdint.h>
+#if __SSE2__
+#include <emmintrin.h>
+#elif __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
+/**
+ * Static inline functions which convert between the channel-interleaved sample formats of audio hosts
+ * and the channel-uninterleaved float buffers of a context, in which channel k of a block starts at
+ * index k*blockSize. Float samples are clipped to [-1,+1] and truncated when converted to integers, as
+ * vDSP_vfix16 does. Mono and stereo, which make up almost all host buffers, are vectorised. Other
+ * channel counts, and the frames remaining after the vectorised loop, are converted one at a time.
+ * Host buffers need not be aligned.
+ */
+class SampleConversion {
+
+  public:
+    /** Uninterleaves signed 16-bit samples to floats in [-1,+1). */
+    static inline void shortToFloat(const short *input, float *output, int numChannels, int blockSize) {
+      const float scale = 1.0f / 32768.0f;
+      int i = 0;
+      #if __SSE2__
+      const __m128 scaleVec = _mm_set1_ps(scale);
+      if (numChannels == 2) {
+        for (; i + 4 <= blockSize; i += 4) {
+          __m128i x = _mm_loadu_si128((const __m128i *) (input+2*i)); // L0 R0 L1 R1 L2 R2 L3 R3
+          __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+          __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+          _mm_storeu_ps(output+i, _mm_mul_ps(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2,0,2,0)), scaleVec));
+          _mm_storeu_ps(output+blockSize+i, _mm_mul_ps(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3,1,3,1)), scaleVec));
+        }
+      } else if (numChannels == 1) {
+        for (; i + 8 <= blockSize; i += 8) {
+          __m128i x = _mm_loadu_si128((const __m128i *) (input+i));
+          _mm_storeu_ps(output+i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16)), scaleVec));
+          _mm_storeu_ps(output+i+4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16)), scaleVec));
+        }
+      }
+      #elif __ARM_NEON__
+      if (numChannels == 2) {
+        for (; i + 4 <= blockSize; i += 4) {
+          int16x4x2_t x = vld2_s16(input+2*i);
+          vst1q_f32(output+i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(x.val[0])), scale));
+          vst1q_f32(output+blockSize+i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(x.val[1])), scale));
+        }
+      } else if (numChannels == 1) {
+        for (; i + 4 <= blockSize; i += 4) {
+          vst1q_f32(output+i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vld1_s16(input+i))), scale));
+        }
+      }
+      #endif
+      for (int k = 0; k < numChannels; ++k) {
+        for (int j = i; j < blockSize; ++j) {
+          output[k*blockSize+j] = ((float) input[j*numChannels+k]) * scale;
+        }
+      }
+    }
+
+    /** Interleaves floats to signed 16-bit samples. */
+    static inline void floatToShort(const float *input, short *output, int numChannels, int blockSize) {
+      int i = 0;
+      #if __SSE2__
+      const __m128 minVec = _mm_set1_ps(-1.0f);
+      const __m128 maxVec = _mm_set1_ps(1.0f);
+      const __m128 scaleVec = _mm_set1_ps(32767.0f);
+      if (numChannels == 2) {
+        for (; i + 4 <= blockSize; i += 4) {
+          __m128 l = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(input+i), minVec), maxVec), scaleVec);
+          __m128 r = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(input+blockSize+i), minVec), maxVec), scaleVec);
+          __m128i li = _mm_cvttps_epi32(l);
+          __m128i ri = _mm_cvttps_epi32(r);
+          _mm_storeu_si128((__m128i *) (output+2*i),
+              _mm_packs_epi32(_mm_unpacklo_epi32(li, ri), _mm_unpackhi_epi32(li, ri)));
+        }
+      } else if (numChannels == 1) {
+        for (; i + 8 <= blockSize; i += 8) {
+          __m128 a = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(input+i), minVec), maxVec), scaleVec);
+          __m128 b = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(input+i+4), minVec), maxVec), scaleVec);
+          _mm_storeu_si128((__m128i *) (output+i), _mm_packs_epi32(_mm_cvttps_epi32(a), _mm_cvttps_epi32(b)));
+        }
+      }
+      #elif __ARM_NEON__
+      const float32x4_t minVec = vdupq_n_f32(-1.0f);
+      const float32x4_t maxVec = vdupq_n_f32(1.0f);
+      if (numChannels == 2) {
+        for (; i + 4 <= blockSize; i += 4) {
+          float32x4_t l = vminq_f32(vmaxq_f32(vld1q_f32(input+i), minVec), maxVec);
+          float32x4_t r = vminq_f32(vmaxq_f32(vld1q_f32(input+blockSize+i), minVec), maxVec);
+          int16x4x2_t x;
+          x.val[0] = vqmovn_s32(vcvtq_s32_f32(vmulq_n_f32(l, 32767.0f)));
+          x.val[1] = vqmovn_s32(vcvtq_s32_f32(vmulq_n_f32(r, 32767.0f)));
+          vst2_s16(output+2*i, x);
+        }
+      } else if (numChannels == 1) {
+        for (; i + 4 <= blockSize; i += 4) {
+          float32x4_t x = vminq_f32(vmaxq_f32(vld1q_f32(input+i), minVec), maxVec);
+          vst1_s16(output+i, vqmovn_s32(vcvtq_s32_f32(vmulq_n_f32(x, 32767.0f))));
+        }
+      }
+      #endif
+      for (int k = 0; k < numChannels; ++k) {
+        for (int j = i; j < blockSize; ++j) {
+          output[j*numChannels+k] = (short) (clip(input[k*blockSize+j]) * 32767.0f);
+        }
+      }
+    }
+
+    /** Uninterleaves packed (three byte, little-endian) signed 24-bit samples to floats in [-1,+1). */
+    static inline void int24ToFloat(const unsigned char *input, float *output, int numChannels, int blockSize) {
+      const float scale = 1.0f / 8388608.0f;
+      for (int k = 0; k < numChannels; ++k) {
+        const unsigned char *in = input + 3*k;
+        for (int j = 0; j < blockSize; ++j, in += 3*numChannels) {
+          // place the sample in the upper three bytes and shift it back down to extend the sign
+          int32_t x = (int32_t) (((uint32_t) in[0] << 8) | ((uint32_t) in[1] << 16) | ((uint32_t) in[2] << 24));
+          output[k*blockSize+j] = ((float) (x >> 8)) * scale;
+        }
+      }
+    }
+
+    /** Interleaves floats to packed (three byte, little-endian) signed 24-bit samples. */
+    static inline void floatToInt24(const float *input, unsigned char *output, int numChannels, int blockSize) {
+      for (int k = 0; k < numChannels; ++k) {
+        unsigned char *out = output + 3*k;
+        for (int j = 0; j < blockSize; ++j, out += 3*numChannels) {
+          int32_t x = (int32_t) (clip(input[k*blockSize+j]) * 8388607.0f);
+          out[0] = (unsigned char) x;
+          out[1] = (unsigned char) (x >> 8);
+          out[2] = (unsigned char) (x >> 16);
+        }
+      }
+    }
+
+    /** Uninterleaves signed 32-bit samples to floats in [-1,+1]. */
+    static inline void int32ToFloat(const int32_t *input, float *output, int numChannels, int blockSize) {
+      const float scale = 1.0f / 2147483648.0f;
+      for (int k = 0; k < numChannels; ++k) {
+        for (int j = 0; j < blockSize; ++j) {
+          output[k*blockSize+j] = ((float) input[j*numChannels+k]) * scale;
+        }
+      }
+    }
+
+    /** Interleaves floats to signed 32-bit samples. */
+    static inline void floatToInt32(const float *input, int32_t *output, int numChannels, int blockSize) {
+      for (int k = 0; k < numChannels; ++k) {
+        for (int j = 0; j < blockSize; ++j) {
+          // 2^31-1 is not representable as a float, so the product is formed in double precision
+          output[j*numChannels+k] = (int32_t) (((double) clip(input[k*blockSize+j])) * 2147483647.0);
+        }
+      }
+    }
+
+    /** Uninterleaves float samples. No clipping is applied. */
+    static inline void deinterleave(const float *input, float *output, int numChannels, int blockSize) {
+      int i = 0;
+      #if __SSE2__
+      if (numChannels == 2) {
+        for (; i + 4 <= blockSize; i += 4) {
+          __m128 a = _mm_loadu_ps(input+2*i);
+          __m128 b = _mm_loadu_ps(input+2*i+4);
+          _mm_storeu_ps(output+i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0)));
+          _mm_storeu_ps(output+blockSize+i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3,1,3,1)));
+        }
+      }
+      #elif __ARM_NEON__
+      if (numChannels == 2) {
+        for (; i + 4 <= blockSize; i += 4) {
+          float32x4x2_t x = vld2q_f32(input+2*i);
+          vst1q_f32(output+i, x.val[0]);
+          vst1q_f32(output+blockSize+i, x.val[1]);
+        }
+      }
+      #endif
+      for (int k = 0; k < numChannels; ++k) {
+        for (int j = i; j < blockSize; ++j) {
+          output[k*blockSize+j] = input[j*numChannels+k];
+        }
+      }
+    }
+
+    /** Interleaves float samples. No clipping is applied. */
+    static inline void interleave(const float *input, float *output, int numChannels, int blockSize) {
+      int i = 0;
+      #if __SSE2__
+      if (numChannels == 2) {
+        for (; i + 4 <= blockSize; i += 4) {
+          __m128 l = _mm_loadu_ps(input+i);
+          __m128 r = _mm_loadu_ps(input+blockSize+i);
+          _mm_storeu_ps(output+2*i, _mm_unpacklo_ps(l, r));
+          _mm_storeu_ps(output+2*i+4, _mm_unpackhi_ps(l, r));
+        }
+      }
+      #elif __ARM_NEON__
+      if (numChannels == 2) {
+        for (; i + 4 <= blockSize; i += 4) {
+          float32x4x2_t x;
+          x.val[0] = vld1q_f32(input+i);
+          x.val[1] = vld1q_f32(input+blockSize+i);
+          vst2q_f32(output+2*i, x);
+        }
+      }
+      #endif
+      for (int k = 0; k < numChannels; ++k) {
+        for (int j = i; j < blockSize; ++j) {
+          output[j*numChannels+k] = input[k*blockSize+j];
+        }
+      }
+    }
+
+    /**
+     * Adds triangular (TPDF) dither of +/- <code>amplitude</code> to the buffer, in place. The amplitude
+     * should be one least significant bit of the target format, e.g. 1/32767 for 16-bit samples. Half
+     * of it is also added away from zero, such that the truncating conversions above round to nearest.
+     * The noise is generated with a linear congruential generator whose state is kept in <code>seed</code>.
+     */
+    static inline void addTriangularDither(float *buffer, int length, float amplitude, uint32_t *seed) {
+      const float scale = amplitude / 16777216.0f;
+      const float halfAmplitude = 0.5f * amplitude;
+      uint32_t s = *seed;
+      for (int i = 0; i < length; ++i) {
+        s = s * 1664525u + 1013904223u;
+        int32_t r0 = (int32_t) (s >> 8);
+        s = s * 1664525u + 1013904223u;
+        int32_t r1 = (int32_t) (s >> 8);
+        float f = buffer[i] + ((float) (r0 - r1)) * scale;
+        buffer[i] = f + copysignf(halfAmplitude, f);
+      }
+      *seed = s;
+    }
+
+  private:
+    SampleConversion();
+
+    static inline float clip(float f) {
+      return (f < -1.0f) ? -1.0f : (f > 1.0f) ? 1.0f : f;
+    }
+};
+
+#endif // _SAMPLE_CONVERSION_H_
@@ -0,0 +1,132 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include "SharedTableStore.h"
+
+static pthread_mutex_t storeLock = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<SharedTableBuffer *> store;
+
+SharedTableBuffer *SharedTableStore::find(const char *key) {
+  if (key[0] == '\0') return NULL; // anonymous buffers cannot be found
+  for (unsigned int i = 0; i < store.size(); i++) {
+    if (!strcmp(store[i]->key.c_str(), key)) return store[i];
+  }
+  return NULL;
+}
+
+SharedTableBuffer *SharedTableStore::acquire(const char *key) {
+  pthread_mutex_lock(&storeLock);
+  SharedTableBuffer *sharedBuffer = find(key);
+  if (sharedBuffer != NULL) sharedBuffer->referenceCount++;
+  pthread_mutex_unlock(&storeLock);
+  return sharedBuffer;
+}
+
+SharedTableBuffer *SharedTableStore::acquire(const char *key, float *buffer, int bufferLength) {
+  SharedTableBuffer *sharedBuffer = acquire(key);
+  if (sharedBuffer != NULL) return sharedBuffer;
+  
+  float *bufferCopy = (float *) malloc(bufferLength * sizeof(float));
+  memcpy(bufferCopy, buffer, bufferLength * sizeof(float));
+  return acquireOwned(key, bufferCopy, bufferLength);
+}
+
+SharedTableBuffer *SharedTableStore::acquireOwned(const char *key, float *buffer, int bufferLength) {
+  pthread_mutex_lock(&storeLock);
+  SharedTableBuffer *sharedBuffer = find(key);
+  if (sharedBuffer == NULL) {
+    sharedBuffer = new SharedTableBuffer();
+    sharedBuffer->key = std::string(key);
+    sharedBuffer->buffer = buffer;
+    sharedBuffer->bufferLength = bufferLength;
+    sharedBuffer->referenceCount = 0;
+    sharedBuffer->mappedAddress = NULL;
+    sharedBuffer->mappedLength = 0;
+    store.push_back(sharedBuffer);
+  } else {
+    // the buffer has been added by another thread in the meantime
+    free(buffer);
+  }
+  sharedBuffer->referenceCount++;
+  pthread_mutex_unlock(&storeLock);
+  return sharedBuffer;
+}
+
+SharedTableBuffer *SharedTableStore::acquireMappedFile(const char *path) {
+  SharedTableBuffer *sharedBuffer = acquire(path);
+  if (sharedBuffer != NULL) return sharedBuffer;
+  
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return NULL;
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 || fileStat.st_size < (off_t) sizeof(float)) {
+    close(fd);
+    return NULL;
+  }
+  size_t mappedLength = (size_t) fileStat.st_size;
+  void *mappedAddress = mmap(NULL, mappedLength, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); // the mapping remains valid
+  if (mappedAddress == MAP_FAILED) return NULL;
+  
+  pthread_mutex_lock(&storeLock);
+  sharedBuffer = find(path);
+  if (sharedBuffer == NULL) {
+    sharedBuffer = new SharedTableBuffer();
+    sharedBuffer->key = std::string(path);
+    sharedBuffer->buffer = (float *) mappedAddress;
+    sharedBuffer->bufferLength = (int) (mappedLength / sizeof(float));
+    sharedBuffer->referenceCount = 0;
+    sharedBuffer->mappedAddress = mappedAddress;
+    sharedBuffer->mappedLength = mappedLength;
+    store.push_back(sharedBuffer);
+  } else {
+    // the file has been mapped by another thread in the meantime
+    munmap(mappedAddress, mappedLength);
+  }
+  sharedBuffer->referenceCount++;
+  pthread_mutex_unlock(&storeLock);
+  return sharedBuffer;
+}
+
+SharedTableBuffer *SharedTableStore::acquireCopy(float *buffer, int bufferLength) {
+  return acquire("", buffer, bufferLength);
+}
+
+SharedTableBuffer *SharedTableStore::retain(SharedTableBuffer *sharedBuffer) {
+  pthread_mutex_lock(&storeLock);
+  sharedBuffer->referenceCount++;
+  pthread_mutex_unlock(&storeLock);
+  return sharedBuffer;
+}
+
+void SharedTableStore::release(SharedTableBuffer *sharedBuffer) {
+  if (sharedBuffer == NULL) return;
+  pthread_mutex_lock(&storeLock);
+  if (--sharedBuffer->referenceCount == 0) {
+    for (unsigned int i = 0; i < store.size(); i++) {
+      if (store[i] == sharedBuffer) {
+        store.erase(store.begin() + i);
+        break;
+      }
+    }
+    if (sharedBuffer->mappedAddress != NULL) {
+      munmap(sharedBuffer->mappedAddress, sharedBuffer->mappedLength);
+    } else {
+      free(sharedBuffer->buffer);
+    }
+    delete sharedBuffer;
+  }
+  pthread_mutex_unlock(&storeLock);
+}
@@ -0,0 +1,77 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#ifndef _SHARED_TABLE_STORE_H_
+#define _SHARED_TABLE_STORE_H_
+
+#include <stddef.h>
+#include <string>
+
+/** An immutable, reference counted sample buffer which may be referenced by tables of any context. */
+typedef struct SharedTableBuffer {
+  std::string key;
+  float *buffer;
+  int bufferLength;
+  int referenceCount;
+  
+  /** The mapped region if the buffer is mapped from a file, otherwise <code>NULL</code>. */
+  void *mappedAddress;
+  size_t mappedLength;
+} SharedTableBuffer;
+
+/**
+ * A process-wide store of immutable sample buffers, by key. Tables of any number of contexts may
+ * reference the same buffer instead of holding a private copy. A table makes a private copy of a
+ * shared buffer when it is first written to (see <code>MessageTable</code>). A buffer is freed (or
+ * unmapped) when its last reference is released. All functions are thread-safe.
+ */
+class SharedTableStore {
+
+  public:
+    /**
+     * Returns a new reference to the buffer with the given key, or <code>NULL</code> if no such
+     * buffer exists.
+     */
+    static SharedTableBuffer *acquire(const char *key);
+  
+    /**
+     * Returns a new reference to the buffer with the given key. If no such buffer exists, it is
+     * created as a copy of the given samples.
+     */
+    static SharedTableBuffer *acquire(const char *key, float *buffer, int bufferLength);
+  
+    /**
+     * As <code>acquire(key, buffer, bufferLength)</code>, but the store takes ownership of the given
+     * <code>malloc()</code>ed buffer instead of copying it. The buffer is freed if a buffer with the
+     * given key already exists.
+     */
+    static SharedTableBuffer *acquireOwned(const char *key, float *buffer, int bufferLength);
+  
+    /**
+     * Returns a new reference to the contents of the given file, which are raw native-endian 32-bit
+     * floats. The file is mapped into memory and is not read. The key of the buffer is the path.
+     * Returns <code>NULL</code> if the file cannot be mapped.
+     */
+    static SharedTableBuffer *acquireMappedFile(const char *path);
+  
+    /**
+     * Returns a new anonymous buffer holding a copy of the given samples. Its key is empty, and it
+     * can only be referenced through the returned pointer (see <code>retain()</code>).
+     */
+    static SharedTableBuffer *acquireCopy(float *buffer, int bufferLength);
+  
+    /** Adds a reference to the given buffer, which is returned. */
+    static SharedTableBuffer *retain(SharedTableBuffer *sharedBuffer);
+  
+    /** Releases a reference to the given buffer. */
+    static void release(SharedTableBuffer *sharedBuffer);
+  
+  private:
+    static SharedTableBuffer *find(const char *key);
+};
+
+#endif // _SHARED_TABLE_STORE_H_
@@ -0,0 +1,96 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#ifndef _SPSC_RING_BUFFER_H_
+#define _SPSC_RING_BUFFER_H_
+
+#include <stdlib.h>
+
+/**
+ * A lock-free ring buffer for exactly one producer thread and one consumer thread. Items are
+ * copied in and out by value. A batch of items is published with a single memory barrier and index
+ * update, such that the consumer sees either none or all of them. The capacity is rounded up to a
+ * power of two.
+ */
+template <typename T>
+class SpscRingBuffer {
+
+  public:
+    SpscRingBuffer(unsigned int minCapacity) {
+      capacity = 1;
+      while (capacity < minCapacity) capacity <<= 1;
+      buffer = (T *) malloc(capacity * sizeof(T));
+      writeCount = 0;
+      readCount = 0;
+    }
+
+    ~SpscRingBuffer() {
+      free(buffer);
+    }
+
+    unsigned int getCapacity() { return capacity; }
+
+    /**
+     * Appends as many of the given items as there is space for. Returns the number of items which
+     * have been written. May only be called from the producer thread.
+     */
+    unsigned int write(const T *items, unsigned int numItems) {
+      // the counters wrap around, which is fine as the capacity is a power of two
+      unsigned int start = writeCount;
+      __sync_synchronize(); // the read count must not be loaded before the previous writes
+      unsigned int numFree = capacity - (start - readCount);
+      if (numItems > numFree) numItems = numFree;
+      for (unsigned int i = 0; i < numItems; i++) {
+        buffer[(start + i) & (capacity - 1)] = items[i];
+      }
+      __sync_synchronize(); // the items must be written before they are published
+      writeCount = start + numItems;
+      return numItems;
+    }
+
+    /**
+     * Removes up to <code>maxItems</code> items from the buffer into <code>items</code>. Returns the
+     * number of items which have been read. May only be called from the consumer thread.
+     */
+    unsigned int read(T *items, unsigned int maxItems) {
+      unsigned int start = readCount;
+      unsigned int numItems = writeCount - start;
+      __sync_synchronize(); // the items must not be loaded before the write count
+      if (numItems > maxItems) numItems = maxItems;
+      for (unsigned int i = 0; i < numItems; i++) {
+        items[i] = buffer[(start + i) & (capacity - 1)];
+      }
+      __sync_synchronize(); // the items must be loaded before their space is released
+      readCount = start + numItems;
+      return numItems;
+    }
+
+    /** Returns the number of items which can currently be written. May only be called from the producer. */
+    unsigned int getNumFree() {
+      unsigned int numFree = capacity - (writeCount - readCount);
+      __sync_synchronize(); // space is only reused after the read count has been loaded
+      return numFree;
+    }
+
+    /** Returns <code>true</code> if there are no items to read. May be called from either thread. */
+    bool isEmpty() { return writeCount == readCount; }
+
+  private:
+    SpscRingBuffer(const SpscRingBuffer &);
+    SpscRingBuffer &operator=(const SpscRingBuffer &);
+
+    T *buffer;
+    unsigned int capacity;
+
+    /** The total number of items written. Only changed by the producer. */
+    volatile unsigned int writeCount;
+
+    /** The total number of items read. Only changed by the consumer. */
+    volatile unsigned int readCount;
+};
+
+#endif // _SPSC_RING_BUFFER_H_
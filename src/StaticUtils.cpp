@@ -31,6 +31,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include "regex.h"
 #include "StaticUtils.h"
 
@@ -121,3 +122,11 @@ bool StaticUtils::fileExists(const char *path) {
   }
   return false;
 }
+
+string StaticUtils::fileStamp(const char *path) {
+  struct stat fileStat;
+  if (stat(path, &fileStat) != 0) return string();
+  char stamp[64];
+  snprintf(stamp, sizeof(stamp), "%ld:%ld", (long) fileStat.st_mtime, (long) fileStat.st_size);
+  return string(stamp);
+}
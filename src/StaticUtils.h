@@ -52,6 +52,12 @@ class StaticUtils {
   
     static bool fileExists(const char *path);
   
+    /**
+     * Returns a string which changes whenever the file at the given path is modified (made of its
+     * modification time and size), or an empty string if the file does not exist.
+     */
+    static string fileStamp(const char *path);
+  
   private:
     StaticUtils(); // a private constructor. No instances of this object should be made.
     ~StaticUtils();
@@ -0,0 +1,27 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#ifndef _ZG_MIDI_EVENT_H_
+#define _ZG_MIDI_EVENT_H_
+
+/** Enumerates the kinds of midi events accepted by <code>zg_context_send_midi_events()</code>. */
+typedef enum ZGMidiEventType {
+  ZG_MIDI_NOTE, // value0 is the note number, value1 the velocity (zero for note off)
+  ZG_MIDI_CONTROL_CHANGE, // value0 is the controller number, value1 the value
+  ZG_MIDI_PITCH_BEND // value0 is the bend in [0, 16383], centred at 8192. value1 is unused
+} ZGMidiEventType;
+
+/** A midi event to be delivered at a sample-accurate position in the next processed block. */
+typedef struct ZGMidiEvent {
+  float blockIndex; // the position in the block, in samples. It may be fractional
+  unsigned char type; // a ZGMidiEventType
+  unsigned char channel; // zero-indexed, [0, 15]
+  unsigned short value0;
+  unsigned short value1;
+} ZGMidiEvent;
+
+#endif // _ZG_MIDI_EVENT_H_
@@ -0,0 +1,19 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#ifndef _ZG_SAMPLE_FORMAT_H_
+#define _ZG_SAMPLE_FORMAT_H_
+
+/** Enumerates the channel-interleaved sample formats accepted by <code>zg_context_process_interleaved()</code>. */
+typedef enum ZGSampleFormat {
+  ZG_SAMPLE_FORMAT_INT16, // signed short
+  ZG_SAMPLE_FORMAT_INT24, // signed, packed into three bytes, little-endian
+  ZG_SAMPLE_FORMAT_INT32, // signed int
+  ZG_SAMPLE_FORMAT_FLOAT32 // float, not clipped
+} ZGSampleFormat;
+
+#endif // _ZG_SAMPLE_FORMAT_H_
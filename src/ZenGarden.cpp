@@ -27,15 +27,16 @@
  *
  */
 
-#if __APPLE__
-#include <Accelerate/Accelerate.h>
-#endif
 #include <string.h>
+#include "DspProfiler.h"
 #include "MessageTable.h"
 #include "PdAbstractionDataBase.h"
 #include "PdContext.h"
+#include "PdContextGroup.h"
 #include "PdFileParser.h"
 #include "PdGraph.h"
+#include "PdGraphTransaction.h"
+#include "SharedTableStore.h"
 #include "ZenGarden.h"
 
 /*
@@ -44,7 +45,8 @@ void zg_remove_graph(PdContext *context, PdGraph *graph) {
 }
 */
 
-ZGObject *zg_graph_add_new_object(PdGraph *graph, const char *objectString, float canvasX, float canvasY) {
+/** Creates a new object for the given graph from its string description, without adding it. */
+static MessageObject *newObjectFromString(PdGraph *graph, const char *objectString) {
   char *objectStringCopy = StaticUtils::copyString(objectString);
   char *objectLabel = strtok(objectStringCopy, " ;");
   char *initString = strtok(NULL, ";");
@@ -53,7 +55,11 @@ ZGObject *zg_graph_add_new_object(PdGraph *graph, const char *objectString, floa
   initMessage->initWithSARb(32, initString, graph->getArguments(), resolutionBuffer, 256);
   MessageObject *messageObject = graph->getContext()->newObject(objectLabel, initMessage, graph);
   free(objectStringCopy);
-  
+  return messageObject;
+}
+
+ZGObject *zg_graph_add_new_object(PdGraph *graph, const char *objectString, float canvasX, float canvasY) {
+  MessageObject *messageObject = newObjectFromString(graph, objectString);
   if (messageObject != NULL) {
     graph->addObject(canvasX, canvasY, messageObject);
   }
@@ -152,6 +158,10 @@ ZGContext *zg_context_new(int numInputChannels, int numOutputChannels, int block
       callbackFunction, userData);
 }
 
+ZGContext *zg_context_clone(ZGContext *context) {
+  return context->clone();
+}
+
 void zg_context_delete(ZGContext *context) {
   delete context;
 }
@@ -168,14 +178,18 @@ ZGGraph *zg_context_new_graph_from_file(PdContext *context, const char *director
   PdFileParser *parser = new PdFileParser(string(directory), string(filename));
   PdGraph *graph = parser->execute(context);
   graph->addDeclarePath(directory); // ensure that the root director is added to the declared path set
-  delete parser;
+  graph->setDescription(parser); // keep the description in case that the context is cloned
   return graph;
 }
 
 ZGGraph *zg_context_new_graph_from_string(PdContext *context, const char *netlist) {
   PdFileParser *parser = new PdFileParser(string(netlist));
   PdGraph *graph = parser->execute(context);
-  delete parser;
+  if (graph != NULL) {
+    graph->setDescription(parser); // keep the description in case that the context is cloned
+  } else {
+    PdFileParser::release(parser);
+  }
   return graph;
 }
 
@@ -183,111 +197,80 @@ void zg_context_process(PdContext *context, float *inputBuffers, float *outputBu
   context->process(inputBuffers, outputBuffers);
 }
 
+void zg_context_process_channels(PdContext *context, float **inputBuffers, float **outputBuffers) {
+  context->processChannels(inputBuffers, outputBuffers);
+}
+
+void zg_context_set_input_binding_enabled(ZGContext *context, int enabled) {
+  context->lock();
+  context->setInputBindingEnabled(enabled != 0);
+  context->unlock();
+}
+
 void zg_context_process_s(ZGContext *context, short *inputBuffers, short *outputBuffers) {
-  const int numInputChannels = context->getNumInputChannels();
-  const int numOutputChannels = context->getNumOutputChannels();
-  const int blockSize = context->getBlockSize();
-  const int inputBufferLength = numInputChannels*blockSize;
-  const int outputBufferLength = numOutputChannels*blockSize;
-  float finputBuffers[inputBufferLength];
-  float foutputBuffers[outputBufferLength];
-  
-  #if __APPLE__
-  // convert short to float, and uninterleave the samples into the float buffer
-  // allow fallthrough in all cases
-  switch (numInputChannels) {
-    default: { // input channels > 2
-      for (int i = 2; i < numInputChannels; ++i) {
-        vDSP_vflt16(inputBuffers+i, numInputChannels, finputBuffers+i*blockSize, 1, blockSize);
-      } // allow fallthrough
-    }
-    case 2: vDSP_vflt16(inputBuffers+1, numInputChannels, finputBuffers+blockSize, 1, blockSize);
-    case 1: vDSP_vflt16(inputBuffers, numInputChannels, finputBuffers, 1, blockSize);
-    case 0: break;
-  }
-  
-  // convert samples to range of [-1,+1]
-  float a = 0.000030517578125f; // == 2^-15
-  vDSP_vsmul(finputBuffers, 1, &a, finputBuffers, 1, inputBufferLength);
-  
-  // process the samples
-  context->process(finputBuffers, foutputBuffers);
-  
-  // clip the output to [-1,+1]
-  float min = -1.0f;
-  float max = 1.0f;
-  vDSP_vclip(foutputBuffers, 1, &min, &max, foutputBuffers, 1, outputBufferLength);
-  
-  // scale the floating-point samples to short range
-  a = 32767.0f;
-  vDSP_vsmul(foutputBuffers, 1, &a, foutputBuffers, 1, outputBufferLength);
-  
-  // convert float to short and interleave into short buffer
-  // allow fallthrough in all cases
-  switch (numOutputChannels) {
-    default: { // output channels > 2
-      for (int i = 2; i < numOutputChannels; ++i) {
-        vDSP_vfix16(foutputBuffers+i*blockSize, numOutputChannels, outputBuffers+i, 1, blockSize);
-      } // allow fallthrough
-    }
-    case 2: vDSP_vfix16(foutputBuffers+blockSize, 1, outputBuffers+1, numOutputChannels, blockSize);
-    case 1: vDSP_vfix16(foutputBuffers, 1, outputBuffers, numOutputChannels, blockSize);
-    case 0: break;
-  }
-  #else
-  // uninterleave and short->float the samples in inputBuffers to finputBuffers
-  switch (numInputChannels) {
-    default: {
-      for (int k = 2; k < numInputChannels; k++) {
-        for (int i = k, j = k*blockSize; i < inputBufferLength; i+=numInputChannels, j++) {
-          finputBuffers[j] = ((float) inputBuffers[i]) / 32768.0f;
-        }
-      } // allow fallthrough
-    }
-    case 2: {
-      for (int i = 1, j = blockSize; i < inputBufferLength; i+=numInputChannels, j++) {
-        finputBuffers[j] = ((float) inputBuffers[i]) / 32768.0f;
-      }  // allow fallthrough
-    }
-    case 1: {
-      for (int i = 0, j = 0; i < inputBufferLength; i+=numInputChannels, j++) {
-        finputBuffers[j] = ((float) inputBuffers[i]) / 32768.0f;
-      } // allow fallthrough
-    }
-    case 0: break;
-  }
-  
-  // process the context
-  context->process(finputBuffers, foutputBuffers);
-  
-  // clip the output to [-1,1]
-  for (int i = 0; i < outputBufferLength; i++) {
-    float f = foutputBuffers[i];
-    foutputBuffers[i] = (f < -1.0) ? -1.0f : (f > 1.0f) ? 1.0f : f;
-  }
-  
-  // interleave and float->short the samples in finputBuffers to cinputBuffers
-  switch (numOutputChannels) {
-    default: {
-      for (int k = 2; k < numOutputChannels; k++) {
-        for (int i = k, j = k*blockSize; i < outputBufferLength; i+=numOutputChannels, j++) {
-          outputBuffers[i] = (short) (foutputBuffers[j] * 32767.0f);
-        }
-      } // allow fallthrough
-    }
-    case 2: {
-      for (int i = 1, j = blockSize; i < outputBufferLength; i+=numOutputChannels, j++) {
-        outputBuffers[i] = (short) (foutputBuffers[j] * 32767.0f);
-      } // allow fallthrough
-    }
-    case 1: {
-      for (int i = 0, j = 0; i < outputBufferLength; i+=numOutputChannels, j++) {
-        outputBuffers[i] = (short) (foutputBuffers[j] * 32767.0f);
-      } // allow fallthrough
-    }
-    case 0: break;
-  }
-  #endif
+  context->processInterleaved(ZG_SAMPLE_FORMAT_INT16, inputBuffers, outputBuffers);
+}
+
+void zg_context_process_interleaved(ZGContext *context, ZGSampleFormat format,
+    const void *inputBuffers, void *outputBuffers) {
+  context->processInterleaved(format, inputBuffers, outputBuffers);
+}
+
+void zg_context_set_dither_enabled(ZGContext *context, int enabled) {
+  context->lock();
+  context->setDitherEnabled(enabled != 0);
+  context->unlock();
+}
+
+void zg_context_set_control_granularity(ZGContext *context, unsigned int numSamples) {
+  context->lock();
+  context->setControlGranularity(numSamples);
+  context->unlock();
+}
+
+void zg_context_set_profiling_enabled(ZGContext *context, int enabled) {
+  context->lock();
+  context->getProfiler()->setEnabled(enabled != 0);
+  context->unlock();
+}
+
+ZGProfileEntry *zg_context_get_profile(ZGContext *context, unsigned int *n) {
+  context->lock(); // samples must not be recorded while they are aggregated
+  ZGProfileEntry *profile = context->getProfiler()->getProfile(n);
+  context->unlock();
+  return profile;
+}
+
+
+#pragma mark - Context Group
+
+ZGContextGroup *zg_context_group_new(unsigned int numWorkers) {
+  return new PdContextGroup(numWorkers);
+}
+
+void zg_context_group_delete(ZGContextGroup *group) {
+  delete group;
+}
+
+unsigned int zg_context_group_get_num_workers(ZGContextGroup *group) {
+  return group->getNumWorkers();
+}
+
+void zg_context_group_add_context(ZGContextGroup *group, ZGContext *context,
+    float *inputBuffers, float *outputBuffers) {
+  group->addContext(context, inputBuffers, outputBuffers);
+}
+
+void zg_context_group_remove_context(ZGContextGroup *group, ZGContext *context) {
+  group->removeContext(context);
+}
+
+void zg_context_group_process(ZGContextGroup *group) {
+  group->process();
+}
+
+ZGContextTiming *zg_context_group_get_timing(ZGContextGroup *group, unsigned int *n, double *totalMicros) {
+  return group->getTiming(n, totalMicros);
 }
 
 void *zg_context_get_userinfo(PdContext *context) {
@@ -312,8 +295,12 @@ void zg_context_unregister_external_object(ZGContext *context, const char *objec
 
 #pragma mark - Objects from Context
 
-ZGObject *zg_context_get_table_for_name(ZGObject *table, const char *name) {
-  return NULL; // TODO(mhroth): implement this
+ZGObject *zg_context_get_table_for_name(ZGContext *context, const char *name) {
+  // the table registry changes whenever a graph is attached or removed, possibly on another thread
+  context->lock();
+  MessageTable *table = context->getTable(name);
+  context->unlock();
+  return table;
 }
 
 
@@ -328,6 +315,21 @@ void zg_context_unregister_receiver(ZGContext *context, const char *receiverName
 }
 
 
+#pragma mark - Context Outbound Queue
+
+void zg_context_set_outbound_queue_size(ZGContext *context, unsigned int numBytes) {
+  context->setOutboundQueueSize(numBytes);
+}
+
+unsigned int zg_context_poll_outbound(ZGContext *context) {
+  return context->pollOutboundQueue();
+}
+
+unsigned int zg_context_get_outbound_num_dropped(ZGContext *context) {
+  return context->getNumOutboundDropped();
+}
+
+
 #pragma mark - Context Send Message
 
 /** Send a message to the named receiver. */
@@ -354,22 +356,25 @@ void zg_context_send_message_at_blockindex(PdContext *context, const char *recei
   va_start(ap, messageFormat);
   double timestamp = context->getBlockStartTimestamp();
   if (blockIndex >= 0.0 && blockIndex <= (double) (context->getBlockSize()-1)) {
-    timestamp += blockIndex / context->getSampleRate();
+    timestamp += 1000.0 * blockIndex / context->getSampleRate(); // timestamps are in milliseconds
   }
   context->scheduleExternalMessageV(receiverName, timestamp, messageFormat, ap);
   va_end(ap);
 }
 
 void zg_context_send_midinote(PdContext *context, int channel, int noteNumber, int velocity, double blockIndex) {
-  char receiverName[snprintf(NULL, 0, "zg_notein_%i", channel)+1];
-  snprintf(receiverName, sizeof(receiverName), "zg_notein_%i", channel);
-  
-  zg_context_send_message_at_blockindex(context, receiverName, blockIndex, "fff",
-      (float) noteNumber, (float) velocity, (float) channel);
-  
-  // all message are also sent to the omni listener
-  zg_context_send_message_at_blockindex(context, "zg_notein_omni", blockIndex, "fff",
-      (float) noteNumber, (float) velocity, (float) channel);
+  ZGMidiEvent event;
+  event.blockIndex = (float) blockIndex;
+  event.type = ZG_MIDI_NOTE;
+  event.channel = (unsigned char) ((channel < 0) ? 0 : (channel > 15) ? 15 : channel);
+  event.value0 = (unsigned short) ((noteNumber < 0) ? 0 : (noteNumber > 127) ? 127 : noteNumber);
+  event.value1 = (unsigned short) ((velocity < 0) ? 0 : (velocity > 127) ? 127 : velocity);
+  context->scheduleMidiEvents(&event, 1);
+}
+
+unsigned int zg_context_send_midi_events(PdContext *context, const ZGMidiEvent *events,
+    unsigned int numEvents) {
+  return context->scheduleMidiEvents(events, numEvents);
 }
 
 
@@ -408,13 +413,57 @@ ZGObject **zg_graph_get_objects(ZGGraph *graph, unsigned int *n) {
 }
 
 
+#pragma mark - Graph Transactions
+
+ZGGraphTransaction *zg_graph_transaction_begin(ZGGraph *graph) {
+  return new PdGraphTransaction(graph);
+}
+
+ZGObject *zg_graph_transaction_add_new_object(ZGGraphTransaction *transaction,
+    const char *objectString, float canvasX, float canvasY) {
+  MessageObject *messageObject = newObjectFromString(transaction->getGraph(), objectString);
+  if (messageObject != NULL) {
+    transaction->addObject(messageObject, canvasX, canvasY);
+  }
+  return messageObject;
+}
+
+void zg_graph_transaction_remove_object(ZGGraphTransaction *transaction, ZGObject *object) {
+  transaction->removeObject(object);
+}
+
+void zg_graph_transaction_add_connection(ZGGraphTransaction *transaction,
+    ZGObject *fromObject, int outletIndex, ZGObject *toObject, int inletIndex) {
+  transaction->addConnection(fromObject, outletIndex, toObject, inletIndex);
+}
+
+void zg_graph_transaction_remove_connection(ZGGraphTransaction *transaction,
+    ZGObject *fromObject, int outletIndex, ZGObject *toObject, int inletIndex) {
+  transaction->removeConnection(fromObject, outletIndex, toObject, inletIndex);
+}
+
+int zg_graph_transaction_commit(ZGGraphTransaction *transaction) {
+  bool isCommitted = transaction->commit();
+  delete transaction;
+  return isCommitted ? 1 : 0;
+}
+
+void zg_graph_transaction_abort(ZGGraphTransaction *transaction) {
+  delete transaction;
+}
+
+
 #pragma mark - Table
 
 float *zg_table_get_buffer(MessageObject *table, unsigned int *n) {
   if (table != NULL && table->getObjectType() == MESSAGE_TABLE) {
     MessageTable *messageTable = reinterpret_cast<MessageTable *>(table);
     int x = 0;
-    float *buffer = messageTable->getBuffer(&x);
+    // the caller may write to the buffer. A shared buffer is replaced by a private copy, which the
+    // audio thread must not observe while it is reading the shared one
+    messageTable->getGraph()->lockContextIfAttached();
+    float *buffer = messageTable->getWritableBuffer(&x);
+    messageTable->getGraph()->unlockContextIfAttached();
     *n = x;
     return buffer;
   }
@@ -432,6 +481,35 @@ void zg_table_set_buffer(MessageObject *table, float *buffer, unsigned int n) {
   }
 }
 
+int zg_table_share_buffer(MessageObject *table, const char *key, float *buffer, unsigned int n) {
+  if (table != NULL && table->getObjectType() == MESSAGE_TABLE && key != NULL) {
+    MessageTable *messageTable = reinterpret_cast<MessageTable *>(table);
+    SharedTableBuffer *sharedBuffer = (buffer != NULL) ?
+        SharedTableStore::acquire(key, buffer, n) : SharedTableStore::acquire(key);
+    if (sharedBuffer != NULL) {
+      messageTable->getGraph()->lockContextIfAttached();
+      messageTable->setSharedBuffer(sharedBuffer);
+      messageTable->getGraph()->unlockContextIfAttached();
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int zg_table_map_file(MessageObject *table, const char *path) {
+  if (table != NULL && table->getObjectType() == MESSAGE_TABLE && path != NULL) {
+    MessageTable *messageTable = reinterpret_cast<MessageTable *>(table);
+    SharedTableBuffer *sharedBuffer = SharedTableStore::acquireMappedFile(path);
+    if (sharedBuffer != NULL) {
+      messageTable->getGraph()->lockContextIfAttached();
+      messageTable->setSharedBuffer(sharedBuffer);
+      messageTable->getGraph()->unlockContextIfAttached();
+      return 1;
+    }
+  }
+  return 0;
+}
+
 
 #pragma mark - Message
 
@@ -498,9 +576,13 @@ char *zg_message_to_string(ZGMessage *message) {
 }
 
 void zg_context_register_memorymapped_abstraction(ZGContext *context, const char *objectLabel, const char *abstraction) {
-  context->getAbstractionDataBase()->addAbstraction(objectLabel, abstraction);
+  context->registerAbstraction(objectLabel, abstraction);
 }
 
 void zg_context_unregister_memorymapped_abstraction(ZGContext *context, const char *objectLabel) {
-  context->getAbstractionDataBase()->removeAbstraction(objectLabel);
+  context->unregisterAbstraction(objectLabel);
+}
+
+void zg_context_reload_abstractions(ZGContext *context) {
+  context->reloadAbstractions();
 }
@@ -31,6 +31,8 @@
 #define _ZENGARDEN_H_
 
 #include "ZGCallbackFunction.h"
+#include "ZGMidiEvent.h"
+#include "ZGSampleFormat.h"
 
 /**
  * This header file defines the C interface between ZenGarden and the outside world. Include this header
@@ -38,17 +40,23 @@
  */
 #ifdef __cplusplus
 class PdContext;
+class PdContextGroup;
 class PdGraph;
+class PdGraphTransaction;
 class MessageObject;
 class PdMessage;
 typedef PdContext ZGContext;
+typedef PdContextGroup ZGContextGroup;
 typedef PdGraph ZGGraph;
+typedef PdGraphTransaction ZGGraphTransaction;
 typedef MessageObject ZGObject;
 typedef PdMessage ZGMessage;
 extern "C" {
 #else
 typedef void ZGGraph;
+typedef void ZGGraphTransaction;
 typedef void ZGContext;
+typedef void ZGContextGroup;
 typedef void ZGObject;
 typedef void ZGMessage;
 #endif
@@ -79,7 +87,35 @@ typedef enum ZGConnectionType {
   ZG_CONNECTION_MESSAGE,
   ZG_CONNECTION_DSP
 } ZGConnectionType;
-  
+
+/**
+ * Aggregated timing statistics of one profiled object (or subgraph), as returned by
+ * <code>zg_context_get_profile()</code>. Times are in microseconds per call of the object's
+ * process function. The time of a subgraph includes the time of all of its objects.
+ */
+typedef struct ZGProfileEntry {
+  ZGObject *object;
+  char label[64]; // the object's string description, e.g. "osc~ 440", truncated if necessary
+  unsigned int numSamples;
+  double minMicros;
+  double meanMicros;
+  double maxMicros;
+  double p99Micros;
+} ZGProfileEntry;
+
+/**
+ * Timing statistics of one context in a context group, as returned by
+ * <code>zg_context_group_get_timing()</code>. Times are in microseconds per processed block.
+ */
+typedef struct ZGContextTiming {
+  ZGContext *context;
+  unsigned int workerIndex; // the worker to which the context is pinned
+  unsigned int numBlocks;
+  double lastMicros;
+  double meanMicros;
+  double maxMicros;
+} ZGContextTiming;
+
   
 #pragma mark - Context
   
@@ -87,6 +123,14 @@ typedef enum ZGConnectionType {
   ZGContext *zg_context_new(int numInputChannels, int numOutputChannels, int blockSize, float sampleRate,
       void *(*callbackFunction)(ZGCallbackFunction function, void *userData, void *ptr), void *userData);
 
+  /**
+   * Create a new context with the same configuration and graphs as the given one, without reading
+   * or parsing any patch again. Only graphs created from a file or string are cloned. The new
+   * context starts in the state of a freshly loaded patch, with its tables sharing the current
+   * contents of the given context's tables until either is written.
+   */
+  ZGContext *zg_context_clone(ZGContext *context);
+
   /** Create a new empty graph in the given context. Ideal for building graphs on the fly. */
   ZGGraph *zg_context_new_empty_graph(ZGContext *context);
   
@@ -134,10 +178,17 @@ typedef enum ZGConnectionType {
   /** Unregister an abstraction. */
   void zg_context_unregister_memorymapped_abstraction(ZGContext *context, const char *objectLabel);
 
+  /**
+   * Forgets all abstractions which have been found and parsed, such that abstraction files are
+   * looked up and read again the next time that they are instantiated. Call this after abstraction
+   * files have been added, changed or removed.
+   */
+  void zg_context_reload_abstractions(ZGContext *context);
+
 #pragma mark - Objects from Context
   
   /** Returns the global table object with the given name. NULL if the table does not exist. */
-  ZGObject *zg_context_get_table_for_name(ZGObject *table, const char *name);
+  ZGObject *zg_context_get_table_for_name(ZGContext *context, const char *name);
 
 
 #pragma mark - Graph
@@ -180,15 +231,147 @@ typedef enum ZGConnectionType {
   
   unsigned int zg_object_get_num_outlets(ZGObject *object);
   
+
+#pragma mark - Graph Transactions
+
+  /**
+   * Begins a transaction on the given graph. Edits added to the transaction are applied together
+   * by <code>zg_graph_transaction_commit()</code>, with a single lock of the context and a single
+   * recomputation of the process order, such that many edits cause one short interruption.
+   */
+  ZGGraphTransaction *zg_graph_transaction_begin(ZGGraph *graph);
+
+  /**
+   * Creates a new object for the graph of the transaction, as <code>zg_graph_add_new_object()</code>,
+   * but only adds it to the graph when the transaction is committed. The object may be used in
+   * subsequent edits of the transaction. Returns <code>NULL</code> if the object cannot be created.
+   */
+  ZGObject *zg_graph_transaction_add_new_object(ZGGraphTransaction *transaction,
+      const char *objectString, float canvasX, float canvasY);
+
+  /** Removes and deletes the given object, and all of its connections, on commit. */
+  void zg_graph_transaction_remove_object(ZGGraphTransaction *transaction, ZGObject *object);
+
+  void zg_graph_transaction_add_connection(ZGGraphTransaction *transaction,
+      ZGObject *fromObject, int outletIndex, ZGObject *toObject, int inletIndex);
+
+  void zg_graph_transaction_remove_connection(ZGGraphTransaction *transaction,
+      ZGObject *fromObject, int outletIndex, ZGObject *toObject, int inletIndex);
+
+  /**
+   * Validates and applies all edits of the transaction, and deletes it. Returns 1 if the edits have
+   * been applied. If any edit is invalid, then none are applied and 0 is returned.
+   */
+  int zg_graph_transaction_commit(ZGGraphTransaction *transaction);
+
+  /** Deletes the transaction without applying any edits. New objects of the transaction are deleted. */
+  void zg_graph_transaction_abort(ZGGraphTransaction *transaction);
+  
   
 #pragma mark - Context Process
 
   /** Process the given context. Audio buffers are channel-uninterleaved with float (32-bit) samples. */
   void zg_context_process(ZGContext *context, float *inputBuffers, float *outputBuffers);
   
+  /**
+   * Process the given context. Audio buffers are given as one float buffer per channel. Output
+   * buffers which are 16-byte aligned are written directly by the context, without copies. Input
+   * buffers are copied, unless input binding is enabled (see
+   * <code>zg_context_set_input_binding_enabled()</code>).
+   */
+  void zg_context_process_channels(ZGContext *context, float **inputBuffers, float **outputBuffers);
+  
+  /**
+   * Let adc~ read directly from the 16-byte aligned input buffers given to
+   * <code>zg_context_process_channels()</code> (non-zero), instead of from copies (zero). Any change
+   * of these buffers is then passed on to all objects reading them, and may unfold folded constant
+   * objects, so it should only be enabled by hosts which give the same input buffers for each block.
+   * It is off by default.
+   */
+  void zg_context_set_input_binding_enabled(ZGContext *context, int enabled);
+  
   /** Process the given context. Audio buffers are channel-interleaved with signed short (16-bit) samples. */
   void zg_context_process_s(ZGContext *context, short *inputBuffers, short *outputBuffers);
-  
+
+  /**
+   * Process the given context. Audio buffers are channel-interleaved, with samples of the given format.
+   * Input samples are converted directly into the context's input buffers, and output samples are
+   * converted directly from its output buffers. Integer output is clipped to [-1,+1].
+   */
+  void zg_context_process_interleaved(ZGContext *context, ZGSampleFormat format,
+      const void *inputBuffers, void *outputBuffers);
+
+  /**
+   * Turn triangular dither of the 16-bit and 24-bit output of <code>zg_context_process_s()</code> and
+   * <code>zg_context_process_interleaved()</code> on (non-zero) or off (zero). It is off by default.
+   */
+  void zg_context_set_dither_enabled(ZGContext *context, int enabled);
+
+  /**
+   * Set the granularity in samples at which messages take effect in signal objects. Messages
+   * arriving within the same period of <code>numSamples</code> are applied together at its start,
+   * such that dense automation does not split the processing of a block into many small parts.
+   * The default of one is sample-accurate. The granularity is limited to the block size.
+   */
+  void zg_context_set_control_granularity(ZGContext *context, unsigned int numSamples);
+
+
+#pragma mark - Context Profiling
+
+  /**
+   * Turn the profiling of dsp objects on (non-zero) or off (zero). While profiling is on, the
+   * duration of every call to the process function of every dsp object and subgraph is recorded
+   * into a ring holding the most recent samples. Previously recorded samples are discarded.
+   */
+  void zg_context_set_profiling_enabled(ZGContext *context, int enabled);
+
+  /**
+   * Returns per-object statistics aggregated over the currently recorded samples. The result in n
+   * is the length of the array. The returned array is owned and must be freed by the caller.
+   */
+  ZGProfileEntry *zg_context_get_profile(ZGContext *context, unsigned int *n);
+
+
+#pragma mark - Context Group
+
+  /**
+   * Create a new group in which many contexts can be processed together. Contexts are distributed
+   * over the given number of workers, each pinned to one CPU where supported. The thread calling
+   * <code>zg_context_group_process()</code> is the first worker. If numWorkers is zero, then one
+   * worker per online CPU is used.
+   */
+  ZGContextGroup *zg_context_group_new(unsigned int numWorkers);
+
+  /** Delete the given group. The member contexts are not deleted. */
+  void zg_context_group_delete(ZGContextGroup *group);
+
+  /**
+   * Returns the number of workers of the group. It is smaller than requested if not all worker
+   * threads could be started, in which case their contexts are processed by the remaining workers.
+   */
+  unsigned int zg_context_group_get_num_workers(ZGContextGroup *group);
+
+  /**
+   * Add a context to the group, to be processed with the given channel-uninterleaved float buffers.
+   * The context stays with the least loaded worker at the time that it was added. If the context is
+   * already in the group, then only its buffers are replaced.
+   */
+  void zg_context_group_add_context(ZGContextGroup *group, ZGContext *context,
+      float *inputBuffers, float *outputBuffers);
+
+  /** Remove a context from the group. A context must be removed from its group before it is deleted. */
+  void zg_context_group_remove_context(ZGContextGroup *group, ZGContext *context);
+
+  /** Process one block of all contexts in the group. Returns once all contexts have been processed. */
+  void zg_context_group_process(ZGContextGroup *group);
+
+  /**
+   * Returns the timing of every context in the group. The result in n is the length of the array.
+   * The wall time of the last call to <code>zg_context_group_process()</code> is returned in
+   * totalMicros, if it is not NULL. The returned array is owned and must be freed by the caller.
+   */
+  ZGContextTiming *zg_context_group_get_timing(ZGContextGroup *group, unsigned int *n, double *totalMicros);
+
   
 #pragma mark - Context Send Message
   
@@ -231,10 +414,24 @@ typedef enum ZGConnectionType {
    * Send a midi note message on the given channel to occur at the given block index. The
    * <code>blockIndex</code> parameter behaves in the same way as in <code>zg_send_message_at_blockindex()</code>.
    * All messages are sent to <code>notein</code> objects, i.e. omni. Channels are zero-index and only
-   * 16 are supported. A note off message is generally interpreted as having velocity zero.
+   * 16 are supported. A note off message is generally interpreted as having velocity zero. The
+   * channel is clamped to [0, 15], and the note number and velocity to [0, 127]. This function may
+   * be called from any thread, as <code>zg_context_send_midi_events()</code>.
    */
   void zg_context_send_midinote(ZGContext *context, int channel, int noteNumber, int velocity, double blockIndex);
   
+  /**
+   * Queue the given midi events for the next processed block. Notes are delivered to [notein],
+   * control changes to [ctlin] and pitch bends to [bendin], interleaved in time with all other
+   * messages of the block. Events need not be sorted, but are delivered most efficiently in order.
+   * The events are handed to the context without taking the context lock or allocating memory, such
+   * that this function may be called from a midi thread while the context is processed. Any number
+   * of threads may call it. Returns the number of events which have been queued. It is less than
+   * <code>numEvents</code> only if the queue is full.
+   */
+  unsigned int zg_context_send_midi_events(ZGContext *context, const ZGMidiEvent *events,
+      unsigned int numEvents);
+  
 
 #pragma mark - Context Un/Register External Receivers
   
@@ -242,6 +439,28 @@ typedef enum ZGConnectionType {
   
   void zg_context_unregister_receiver(ZGContext *context, const char *receiverName);
 
+
+#pragma mark - Context Outbound Queue
+
+  /**
+   * Enables an outbound queue of the given size in bytes, or disables it with zero. While enabled,
+   * messages to registered receivers (ZG_RECEIVER_MESSAGE) and print output (ZG_PRINT_STD,
+   * ZG_PRINT_ERR) generated while processing are not delivered to the callback function from the
+   * audio thread. They are queued without locking or allocating, and delivered to the callback
+   * function by <code>zg_context_poll_outbound()</code>. Output of other threads is still delivered
+   * directly. May be called while another thread polls the queue.
+   */
+  void zg_context_set_outbound_queue_size(ZGContext *context, unsigned int numBytes);
+
+  /**
+   * Delivers all queued outbound messages to the callback function, on the calling thread. May be
+   * called from any thread other than the audio thread. Returns the number of messages delivered.
+   */
+  unsigned int zg_context_poll_outbound(ZGContext *context);
+
+  /** Returns the number of outbound messages which have been dropped because the queue was full. */
+  unsigned int zg_context_get_outbound_num_dropped(ZGContext *context);
+
   
 #pragma mark - Object
   
@@ -303,7 +522,8 @@ typedef enum ZGConnectionType {
   /**
    * Returns a direct pointer to the table's buffer with a given length. Note that if elements
    * of the buffer are modified while the context is being processed, a race condition may occur
-   * between the timing of the write and the read by zg_context_process().
+   * between the timing of the write and the read by zg_context_process(). If the table references
+   * a shared buffer, it first receives a private copy.
    */
   float *zg_table_get_buffer(ZGObject *table, unsigned int *n);
   
@@ -313,6 +533,21 @@ typedef enum ZGConnectionType {
    */
   void zg_table_set_buffer(ZGObject *table, float *buffer, unsigned int n);
   
+  /**
+   * The table references the process-wide shared buffer with the given key instead of a private
+   * buffer, such that tables of any number of contexts can share the same samples. If no buffer
+   * exists under the key, it is created as a copy of the given buffer (if not NULL). The table
+   * receives a private copy when it is first written to. Returns 1 on success, 0 otherwise.
+   */
+  int zg_table_share_buffer(ZGObject *table, const char *key, float *buffer, unsigned int n);
+  
+  /**
+   * The table references the contents of the given file of raw native-endian 32-bit floats. The
+   * file is mapped into memory and shared as with zg_table_share_buffer(), with the path as key.
+   * Returns 1 on success, 0 otherwise.
+   */
+  int zg_table_map_file(ZGObject *table, const char *path);
+  
 
 #pragma mark - Message
   
@@ -0,0 +1,41 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+package me.rjdj.zengarden;
+
+/**
+ * A midi event to be delivered at a sample-accurate position in the next processed block, see
+ * {@link ZGContext#sendMidiEvents(MidiEvent...)}.
+ */
+public class MidiEvent {
+  
+  /** value0 is the note number, value1 the velocity (zero for note off). */
+  public static final int NOTE = 0;
+  
+  /** value0 is the controller number, value1 the value. */
+  public static final int CONTROL_CHANGE = 1;
+  
+  /** value0 is the bend in [0, 16383], centred at 8192. value1 is unused. */
+  public static final int PITCH_BEND = 2;
+  
+  /** The position in the block, in samples. It may be fractional. */
+  public final float blockIndex;
+  public final int type;
+  
+  /** The zero-indexed channel, in [0, 15]. */
+  public final int channel;
+  public final int value0;
+  public final int value1;
+  
+  public MidiEvent(float blockIndex, int type, int channel, int value0, int value1) {
+    this.blockIndex = blockIndex;
+    this.type = type;
+    this.channel = channel;
+    this.value0 = value0;
+    this.value1 = value1;
+  }
+}
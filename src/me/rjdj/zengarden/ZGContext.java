@@ -188,6 +188,82 @@ public class ZGContext {
   }
   native private void sendMessage(String receiverName, Message message, long nativePtr);
   
+  /**
+   * Queue midi events for the next processed block. Notes are delivered to <code>notein</code>,
+   * control changes to <code>ctlin</code> and pitch bends to <code>bendin</code>. Events outside
+   * of the block are delivered at its start. This method may be called from any thread.
+   * @return  The number of events which have been queued. It is smaller than the number of given
+   * events only if the queue is full.
+   */
+  public int sendMidiEvents(MidiEvent... events) {
+    float[] blockIndices = new float[events.length];
+    int[] values = new int[4 * events.length];
+    for (int i = 0; i < events.length; i++) {
+      blockIndices[i] = events[i].blockIndex;
+      values[4*i] = events[i].type;
+      values[4*i+1] = events[i].channel;
+      values[4*i+2] = events[i].value0;
+      values[4*i+3] = events[i].value1;
+    }
+    return sendMidiEvents(blockIndices, values, contextPtr);
+  }
+  native private int sendMidiEvents(float[] blockIndices, int[] values, long nativePtr);
+  
+  /**
+   * Send a midi note at the given position in the next block. The channel is clamped to [0, 15],
+   * and the note number and velocity to [0, 127].
+   */
+  public void sendMidiNote(int channel, int noteNumber, int velocity, double blockIndex) {
+    sendMidiNote(channel, noteNumber, velocity, blockIndex, contextPtr);
+  }
+  native private void sendMidiNote(int channel, int noteNumber, int velocity, double blockIndex, long nativePtr);
+  
+  /**
+   * Set the granularity in samples at which messages take effect in signal objects. Messages
+   * arriving within the same period of <code>numSamples</code> are applied together at its start.
+   * The default of one is sample-accurate. The granularity is limited to the block size.
+   */
+  public void setControlGranularity(int numSamples) {
+    if (numSamples < 1) {
+      throw new IllegalArgumentException("The control granularity must be positive: " +
+          Integer.toString(numSamples));
+    }
+    setControlGranularity(numSamples, contextPtr);
+  }
+  native private void setControlGranularity(int numSamples, long nativePtr);
+  
+  /**
+   * Enable an outbound queue of the given size in bytes, or disable it with zero. While enabled,
+   * print output and messages to registered receivers which are generated by <code>process()</code>
+   * are not delivered to the listeners from the audio thread. They are queued, and delivered on the
+   * thread which calls <code>pollOutbound()</code>. Output of other threads is still delivered directly.
+   */
+  public void setOutboundQueueSize(int numBytes) {
+    if (numBytes < 0) {
+      throw new IllegalArgumentException("The queue size may not be negative: " + Integer.toString(numBytes));
+    }
+    setOutboundQueueSize(numBytes, contextPtr);
+  }
+  native private void setOutboundQueueSize(int numBytes, long nativePtr);
+  
+  /**
+   * Deliver all queued outbound messages to the listeners, on the calling thread. This method may
+   * be called while another thread processes the context.
+   * @return  The number of messages which have been delivered.
+   */
+  public int pollOutbound() {
+    return pollOutbound(contextPtr);
+  }
+  native private int pollOutbound(long nativePtr);
+  
+  /**
+   * Returns the number of outbound messages which have been dropped because the queue was full.
+   */
+  public int getOutboundNumDropped() {
+    return getOutboundNumDropped(contextPtr);
+  }
+  native private int getOutboundNumDropped(long nativePtr);
+  
   @Override
   public boolean equals(Object o) {
     if (ZGContext.class.isInstance(o)) {
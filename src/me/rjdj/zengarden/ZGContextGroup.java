@@ -0,0 +1,96 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+package me.rjdj.zengarden;
+
+import java.nio.FloatBuffer;
+import java.util.HashMap;
+import java.util.Map;
+
+/**
+ * Processes many {@link ZGContext}s together, distributed over a number of worker threads. The
+ * thread calling <code>process()</code> is the first worker.
+ */
+public class ZGContextGroup {
+  
+  private final long groupPtr;
+  
+  /** The buffers of each member context, which must live as long as it is in the group. */
+  private final Map<ZGContext, FloatBuffer[]> bufferMap;
+  
+  /**
+   * Once the <code>ZGContextGroup</code> object is garbage collected, the native object is also
+   * destroyed. The member contexts are not.
+   * @param numWorkers  The number of workers. If zero, one worker per online CPU is used.
+   */
+  public ZGContextGroup(int numWorkers) {
+    if (numWorkers < 0) {
+      throw new IllegalArgumentException("The number of workers may not be negative: " +
+          Integer.toString(numWorkers));
+    }
+    bufferMap = new HashMap<ZGContext, FloatBuffer[]>();
+    groupPtr = newGroup(numWorkers);
+  }
+  native private long newGroup(int numWorkers);
+  
+  @Override
+  protected void finalize() throws Throwable {
+    try {
+      deleteGroup(groupPtr);
+    } finally {
+      super.finalize();
+    }
+  }
+  native private void deleteGroup(long nativePtr);
+  
+  /**
+   * Returns the number of workers. It is smaller than requested if not all worker threads could
+   * be started.
+   */
+  public int getNumWorkers() {
+    return getNumWorkers(groupPtr);
+  }
+  native private int getNumWorkers(long nativePtr);
+  
+  /**
+   * Add a context to the group, to be processed with the given direct buffers of
+   * <code>number of channels * block size</code> channel-uninterleaved samples.
+   */
+  public void addContext(ZGContext context, FloatBuffer inputBuffer, FloatBuffer outputBuffer) {
+    if (context == null) {
+      throw new NullPointerException("context may not be null.");
+    }
+    if (!inputBuffer.isDirect() || !outputBuffer.isDirect()) {
+      throw new IllegalArgumentException("The buffers must be direct.");
+    }
+    if (inputBuffer.capacity() < context.numInputChannels * context.blockSize ||
+        outputBuffer.capacity() < context.numOutputChannels * context.blockSize) {
+      throw new IllegalArgumentException("The buffers must hold one block of all channels.");
+    }
+    bufferMap.put(context, new FloatBuffer[] {inputBuffer, outputBuffer});
+    addContext(context.contextPtr, inputBuffer, outputBuffer, groupPtr);
+  }
+  native private void addContext(long contextPtr, FloatBuffer inputBuffer, FloatBuffer outputBuffer,
+      long nativePtr);
+  
+  /** Remove a context from the group. A context must be removed before it is garbage collected. */
+  public void removeContext(ZGContext context) {
+    if (context == null) {
+      throw new NullPointerException("context may not be null.");
+    }
+    removeContext(context.contextPtr, groupPtr);
+    bufferMap.remove(context);
+  }
+  native private void removeContext(long contextPtr, long nativePtr);
+  
+  /** Process one block of all contexts in the group. Returns once all contexts have been processed. */
+  public void process() {
+    process(groupPtr);
+  }
+  native private void process(long nativePtr);
+
+}
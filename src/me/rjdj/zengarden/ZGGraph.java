@@ -140,6 +140,14 @@ public class ZGGraph {
   }
   native private void removeConnection(long fromPtr, int outletIndex, long toPtr, int inletIndex, long nativePtr);
   
+  /**
+   * Begin a transaction, which applies all of its edits of this graph together when committed.
+   */
+  ZGGraphTransaction beginTransaction() {
+    return new ZGGraphTransaction(beginTransaction(graphPtr));
+  }
+  native private long beginTransaction(long nativePtr);
+  
   @Override
   public boolean equals(Object o) {
     if (ZGGraph.class.isInstance(o)) {
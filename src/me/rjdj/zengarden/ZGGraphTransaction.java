@@ -0,0 +1,99 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+package me.rjdj.zengarden;
+
+/**
+ * Collects edits of a {@link ZGGraph} and applies them together when committed. A transaction
+ * can only be committed or aborted once, after which it may no longer be used.
+ */
+public class ZGGraphTransaction {
+  
+  private long transactionPtr;
+  
+  protected ZGGraphTransaction(long nativePtr) {
+    transactionPtr = nativePtr;
+  }
+  
+  private void checkNotFinished() {
+    if (transactionPtr == 0) {
+      throw new IllegalStateException("The transaction has already been committed or aborted.");
+    }
+  }
+  
+  /**
+   * Create a new object based on the string description, which is added to the graph when the
+   * transaction is committed.
+   * @return  The new object. If no object could be created, <code>null</code> is returned.
+   */
+  ZGObject addObject(String initString, int canvasX, int canvasY) {
+    if (initString == null) {
+      throw new NullPointerException();
+    }
+    checkNotFinished();
+    long ptr = addObject(initString, canvasX, canvasY, transactionPtr);
+    return (ptr != 0) ? new ZGObject(ptr) : null;
+  }
+  private native long addObject(String initString, int canvasX, int canvasY, long nativePtr);
+  
+  void removeObject(ZGObject object) {
+    if (object == null) {
+      throw new NullPointerException("object may not be null.");
+    }
+    checkNotFinished();
+    removeObject(object.objectPtr, transactionPtr);
+  }
+  native private void removeObject(long objectPtr, long nativePtr);
+  
+  void addConnection(ZGObject fromObject, int outletIndex, ZGObject toObject, int inletIndex) {
+    if (fromObject == null) {
+      throw new NullPointerException("fromObject may not be null.");
+    }
+    if (toObject == null) {
+      throw new NullPointerException("toObject may not be null.");
+    }
+    checkNotFinished();
+    addConnection(fromObject.objectPtr, outletIndex, toObject.objectPtr, inletIndex, transactionPtr);
+  }
+  native private void addConnection(long fromPtr, int outletIndex, long toPtr, int inletIndex, long nativePtr);
+  
+  void removeConnection(ZGObject fromObject, int outletIndex, ZGObject toObject, int inletIndex) {
+    if (fromObject == null) {
+      throw new NullPointerException("fromObject may not be null.");
+    }
+    if (toObject == null) {
+      throw new NullPointerException("toObject may not be null.");
+    }
+    checkNotFinished();
+    removeConnection(fromObject.objectPtr, outletIndex, toObject.objectPtr, inletIndex, transactionPtr);
+  }
+  native private void removeConnection(long fromPtr, int outletIndex, long toPtr, int inletIndex, long nativePtr);
+  
+  /**
+   * Applies all edits.
+   * @return  <code>true</code> if the edits have been applied, or <code>false</code> if any edit
+   * is invalid, in which case none are applied.
+   */
+  boolean commit() {
+    checkNotFinished();
+    boolean isCommitted = commit(transactionPtr);
+    transactionPtr = 0;
+    return isCommitted;
+  }
+  native private boolean commit(long nativePtr);
+  
+  /**
+   * Discards all edits. New objects of the transaction are deleted.
+   */
+  void abort() {
+    checkNotFinished();
+    abort(transactionPtr);
+    transactionPtr = 0;
+  }
+  native private void abort(long nativePtr);
+
+}
@@ -71,6 +71,54 @@ JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGContext_process
 JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGContext_sendMessage
   (JNIEnv *, jobject, jstring, jobject, jlong);
 
+/*
+ * Class:     me_rjdj_zengarden_ZGContext
+ * Method:    sendMidiEvents
+ * Signature: ([F[IJ)I
+ */
+JNIEXPORT jint JNICALL Java_me_rjdj_zengarden_ZGContext_sendMidiEvents
+  (JNIEnv *, jobject, jfloatArray, jintArray, jlong);
+
+/*
+ * Class:     me_rjdj_zengarden_ZGContext
+ * Method:    sendMidiNote
+ * Signature: (IIIDJ)V
+ */
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGContext_sendMidiNote
+  (JNIEnv *, jobject, jint, jint, jint, jdouble, jlong);
+
+/*
+ * Class:     me_rjdj_zengarden_ZGContext
+ * Method:    setControlGranularity
+ * Signature: (IJ)V
+ */
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGContext_setControlGranularity
+  (JNIEnv *, jobject, jint, jlong);
+
+/*
+ * Class:     me_rjdj_zengarden_ZGContext
+ * Method:    setOutboundQueueSize
+ * Signature: (IJ)V
+ */
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGContext_setOutboundQueueSize
+  (JNIEnv *, jobject, jint, jlong);
+
+/*
+ * Class:     me_rjdj_zengarden_ZGContext
+ * Method:    pollOutbound
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_me_rjdj_zengarden_ZGContext_pollOutbound
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     me_rjdj_zengarden_ZGContext
+ * Method:    getOutboundNumDropped
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_me_rjdj_zengarden_ZGContext_getOutboundNumDropped
+  (JNIEnv *, jobject, jlong);
+
 #ifdef __cplusplus
 }
 #endif
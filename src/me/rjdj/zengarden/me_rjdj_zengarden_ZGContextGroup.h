@@ -0,0 +1,61 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class me_rjdj_zengarden_ZGContextGroup */
+
+#ifndef _Included_me_rjdj_zengarden_ZGContextGroup
+#define _Included_me_rjdj_zengarden_ZGContextGroup
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     me_rjdj_zengarden_ZGContextGroup
+ * Method:    newGroup
+ * Signature: (I)J
+ */
+JNIEXPORT jlong JNICALL Java_me_rjdj_zengarden_ZGContextGroup_newGroup
+  (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     me_rjdj_zengarden_ZGContextGroup
+ * Method:    deleteGroup
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGContextGroup_deleteGroup
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     me_rjdj_zengarden_ZGContextGroup
+ * Method:    getNumWorkers
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_me_rjdj_zengarden_ZGContextGroup_getNumWorkers
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     me_rjdj_zengarden_ZGContextGroup
+ * Method:    addContext
+ * Signature: (JLjava/nio/FloatBuffer;Ljava/nio/FloatBuffer;J)V
+ */
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGContextGroup_addContext
+  (JNIEnv *, jobject, jlong, jobject, jobject, jlong);
+
+/*
+ * Class:     me_rjdj_zengarden_ZGContextGroup
+ * Method:    removeContext
+ * Signature: (JJ)V
+ */
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGContextGroup_removeContext
+  (JNIEnv *, jobject, jlong, jlong);
+
+/*
+ * Class:     me_rjdj_zengarden_ZGContextGroup
+ * Method:    process
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGContextGroup_process
+  (JNIEnv *, jobject, jlong);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -55,6 +55,14 @@ JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGGraph_addConnection
 JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGGraph_removeConnection
   (JNIEnv *, jobject, jlong, jint, jlong, jint, jlong);
 
+/*
+ * Class:     me_rjdj_zengarden_ZGGraph
+ * Method:    beginTransaction
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_me_rjdj_zengarden_ZGGraph_beginTransaction
+  (JNIEnv *, jobject, jlong);
+
 #ifdef __cplusplus
 }
 #endif
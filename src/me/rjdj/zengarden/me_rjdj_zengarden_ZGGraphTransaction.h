@@ -0,0 +1,61 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class me_rjdj_zengarden_ZGGraphTransaction */
+
+#ifndef _Included_me_rjdj_zengarden_ZGGraphTransaction
+#define _Included_me_rjdj_zengarden_ZGGraphTransaction
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     me_rjdj_zengarden_ZGGraphTransaction
+ * Method:    addObject
+ * Signature: (Ljava/lang/String;IIJ)J
+ */
+JNIEXPORT jlong JNICALL Java_me_rjdj_zengarden_ZGGraphTransaction_addObject
+  (JNIEnv *, jobject, jstring, jint, jint, jlong);
+
+/*
+ * Class:     me_rjdj_zengarden_ZGGraphTransaction
+ * Method:    removeObject
+ * Signature: (JJ)V
+ */
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGGraphTransaction_removeObject
+  (JNIEnv *, jobject, jlong, jlong);
+
+/*
+ * Class:     me_rjdj_zengarden_ZGGraphTransaction
+ * Method:    addConnection
+ * Signature: (JIJIJ)V
+ */
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGGraphTransaction_addConnection
+  (JNIEnv *, jobject, jlong, jint, jlong, jint, jlong);
+
+/*
+ * Class:     me_rjdj_zengarden_ZGGraphTransaction
+ * Method:    removeConnection
+ * Signature: (JIJIJ)V
+ */
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGGraphTransaction_removeConnection
+  (JNIEnv *, jobject, jlong, jint, jlong, jint, jlong);
+
+/*
+ * Class:     me_rjdj_zengarden_ZGGraphTransaction
+ * Method:    commit
+ * Signature: (J)Z
+ */
+JNIEXPORT jboolean JNICALL Java_me_rjdj_zengarden_ZGGraphTransaction_commit
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     me_rjdj_zengarden_ZGGraphTransaction
+ * Method:    abort
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGGraphTransaction_abort
+  (JNIEnv *, jobject, jlong);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -185,3 +185,46 @@ JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGContext_process
   env->ReleasePrimitiveArrayCritical(jinputBuffer, cinputBuffer, JNI_ABORT);
   env->ReleasePrimitiveArrayCritical(joutputBuffer, coutputBuffer, JNI_ABORT);
 }
+
+JNIEXPORT jint JNICALL Java_me_rjdj_zengarden_ZGContext_sendMidiEvents
+    (JNIEnv *env, jobject jobj, jfloatArray jblockIndices, jintArray jvalues, jlong nativePtr) {
+  int numEvents = env->GetArrayLength(jblockIndices);
+  float *cblockIndices = env->GetFloatArrayElements(jblockIndices, NULL);
+  jint *cvalues = env->GetIntArrayElements(jvalues, NULL);
+  ZGMidiEvent events[numEvents+1];
+  for (int i = 0; i < numEvents; i++) {
+    events[i].blockIndex = cblockIndices[i];
+    events[i].type = (unsigned char) cvalues[4*i];
+    events[i].channel = (unsigned char) cvalues[4*i+1];
+    events[i].value0 = (unsigned short) cvalues[4*i+2];
+    events[i].value1 = (unsigned short) cvalues[4*i+3];
+  }
+  env->ReleaseFloatArrayElements(jblockIndices, cblockIndices, JNI_ABORT);
+  env->ReleaseIntArrayElements(jvalues, cvalues, JNI_ABORT);
+  return (jint) zg_context_send_midi_events((ZGContext *) nativePtr, events, (unsigned int) numEvents);
+}
+
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGContext_sendMidiNote
+    (JNIEnv *env, jobject jobj, jint channel, jint noteNumber, jint velocity, jdouble blockIndex, jlong nativePtr) {
+  zg_context_send_midinote((ZGContext *) nativePtr, channel, noteNumber, velocity, blockIndex);
+}
+
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGContext_setControlGranularity
+    (JNIEnv *env, jobject jobj, jint numSamples, jlong nativePtr) {
+  zg_context_set_control_granularity((ZGContext *) nativePtr, (unsigned int) numSamples);
+}
+
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGContext_setOutboundQueueSize
+    (JNIEnv *env, jobject jobj, jint numBytes, jlong nativePtr) {
+  zg_context_set_outbound_queue_size((ZGContext *) nativePtr, (unsigned int) numBytes);
+}
+
+JNIEXPORT jint JNICALL Java_me_rjdj_zengarden_ZGContext_pollOutbound
+    (JNIEnv *env, jobject jobj, jlong nativePtr) {
+  return (jint) zg_context_poll_outbound((ZGContext *) nativePtr);
+}
+
+JNIEXPORT jint JNICALL Java_me_rjdj_zengarden_ZGContext_getOutboundNumDropped
+    (JNIEnv *env, jobject jobj, jlong nativePtr) {
+  return (jint) zg_context_get_outbound_num_dropped((ZGContext *) nativePtr);
+}
@@ -0,0 +1,43 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#include "me_rjdj_zengarden_ZGContextGroup.h"
+#include "ZenGarden.h"
+
+JNIEXPORT jlong JNICALL Java_me_rjdj_zengarden_ZGContextGroup_newGroup
+    (JNIEnv *env, jobject jobj, jint numWorkers) {
+  return (jlong) zg_context_group_new((unsigned int) numWorkers);
+}
+
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGContextGroup_deleteGroup
+    (JNIEnv *env, jobject jobj, jlong nativePtr) {
+  zg_context_group_delete((ZGContextGroup *) nativePtr);
+}
+
+JNIEXPORT jint JNICALL Java_me_rjdj_zengarden_ZGContextGroup_getNumWorkers
+    (JNIEnv *env, jobject jobj, jlong nativePtr) {
+  return (jint) zg_context_group_get_num_workers((ZGContextGroup *) nativePtr);
+}
+
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGContextGroup_addContext
+    (JNIEnv *env, jobject jobj, jlong contextPtr, jobject jinputBuffer, jobject joutputBuffer, jlong nativePtr) {
+  // the direct buffers are kept alive by the Java object while the context is in the group
+  float *cinputBuffer = (float *) env->GetDirectBufferAddress(jinputBuffer);
+  float *coutputBuffer = (float *) env->GetDirectBufferAddress(joutputBuffer);
+  zg_context_group_add_context((ZGContextGroup *) nativePtr, (ZGContext *) contextPtr,
+      cinputBuffer, coutputBuffer);
+}
+
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGContextGroup_removeContext
+    (JNIEnv *env, jobject jobj, jlong contextPtr, jlong nativePtr) {
+  zg_context_group_remove_context((ZGContextGroup *) nativePtr, (ZGContext *) contextPtr);
+}
+
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGContextGroup_process
+    (JNIEnv *env, jobject jobj, jlong nativePtr) {
+  zg_context_group_process((ZGContextGroup *) nativePtr);
+}
@@ -41,6 +41,11 @@ JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGGraph_removeConnection
   zg_graph_remove_connection((ZGGraph *) graphPtr, (ZGObject *) fromObjectPtr, outletIndex, (ZGObject *) toObjectPtr, inletIndex);
 }
 
+JNIEXPORT jlong JNICALL Java_me_rjdj_zengarden_ZGGraph_beginTransaction
+    (JNIEnv *env, jobject jobj, jlong nativePtr) {
+  return (jlong) zg_graph_transaction_begin((ZGGraph *) nativePtr);
+}
+
 JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGGraph_attach
     (JNIEnv *env, jobject jobj, jlong nativePtr) {
   zg_graph_attach((ZGGraph *) nativePtr);
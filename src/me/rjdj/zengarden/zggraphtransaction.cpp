@@ -0,0 +1,43 @@
+/*
+ *  Copyright 2015, 2016 AudioGaming
+ *
+ *  This file is a part of the ZenGarden fork by AudioGaming
+ *
+ */
+
+#include "me_rjdj_zengarden_ZGGraphTransaction.h"
+#include "ZenGarden.h"
+
+JNIEXPORT jlong JNICALL Java_me_rjdj_zengarden_ZGGraphTransaction_addObject
+    (JNIEnv *env, jobject jobj, jstring jinitString, jint canvasX, jint canvasY, jlong nativePtr) {
+  const char *cinitString = env->GetStringUTFChars(jinitString, NULL);
+  ZGObject *zgObject = zg_graph_transaction_add_new_object((ZGGraphTransaction *) nativePtr,
+      cinitString, canvasX, canvasY);
+  env->ReleaseStringUTFChars(jinitString, cinitString);
+  return (jlong) zgObject;
+}
+
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGGraphTransaction_removeObject
+    (JNIEnv *env, jobject jobj, jlong objectPtr, jlong nativePtr) {
+  zg_graph_transaction_remove_object((ZGGraphTransaction *) nativePtr, (ZGObject *) objectPtr);
+}
+
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGGraphTransaction_addConnection
+    (JNIEnv *env, jobject jobj, jlong fromObjectPtr, jint outletIndex, jlong toObjectPtr, jint inletIndex, jlong nativePtr) {
+  zg_graph_transaction_add_connection((ZGGraphTransaction *) nativePtr, (ZGObject *) fromObjectPtr, outletIndex, (ZGObject *) toObjectPtr, inletIndex);
+}
+
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGGraphTransaction_removeConnection
+    (JNIEnv *env, jobject jobj, jlong fromObjectPtr, jint outletIndex, jlong toObjectPtr, jint inletIndex, jlong nativePtr) {
+  zg_graph_transaction_remove_connection((ZGGraphTransaction *) nativePtr, (ZGObject *) fromObjectPtr, outletIndex, (ZGObject *) toObjectPtr, inletIndex);
+}
+
+JNIEXPORT jboolean JNICALL Java_me_rjdj_zengarden_ZGGraphTransaction_commit
+    (JNIEnv *env, jobject jobj, jlong nativePtr) {
+  return zg_graph_transaction_commit((ZGGraphTransaction *) nativePtr) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZGGraphTransaction_abort
+    (JNIEnv *env, jobject jobj, jlong nativePtr) {
+  zg_graph_transaction_abort((ZGGraphTransaction *) nativePtr);
+}
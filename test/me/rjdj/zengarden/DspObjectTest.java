@@ -64,11 +64,26 @@ public class DspObjectTest implements ZenGardenListener {
     if (ais != null) ais.close(); // no matter what, be sure to close the audio input stream
   }
   
+  @Test
+  public void testDspClone() {
+    genericDspTest("DspClone.pd");
+  }
+  
   @Test
   public void testDspCos() {
     genericDspTest("DspCos.pd");
   }
   
+  @Test
+  public void testDspFold() {
+    genericDspTest("DspFold.pd");
+  }
+  
+  @Test
+  public void testDspHighpassSignal() {
+    genericDspTest("DspHighpassSignal.pd");
+  }
+  
   @Test
   public void testDspInletOutlet() {
     genericDspTest("DspInletOutlet.pd");
@@ -79,6 +94,11 @@ public class DspObjectTest implements ZenGardenListener {
     genericDspTest("DspLine.pd");
   }
 
+  @Test
+  public void testDspLowpassSignal() {
+    genericDspTest("DspLowpassSignal.pd");
+  }
+  
   @Test
   public void testDspOsc() {
     genericDspTest("DspOsc.pd");
@@ -102,6 +122,11 @@ public class DspObjectTest implements ZenGardenListener {
     genericDspTest("DspThrowCatch.pd");
   }
   
+  @Test
+  public void testDspVCF() {
+    genericDspTest("DspVCF.pd");
+  }
+  
   @Test
   public void testDspWrap() {
     genericDspTest("DspWrap.pd");
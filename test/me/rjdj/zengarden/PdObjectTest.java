@@ -91,6 +91,11 @@ public class PdObjectTest implements ZenGardenListener {
     genericMessageTest("MessageBang.pd");
   }
 
+  @Test
+  public void testMessageBendin() {
+    genericMessageTest("MessageBendin.pd");
+  }
+
   @Test
   public void testMessageChange() {
     genericMessageTest("MessageChange.pd");
@@ -101,11 +106,21 @@ public class PdObjectTest implements ZenGardenListener {
     genericMessageTest("MessageClip.pd");
   }
 
+  @Test
+  public void testMessageClone() {
+    genericMessageTest("MessageClone.pd");
+  }
+
   @Test
   public void testMessageCosine() {
     genericMessageTest("MessageCosine.pd");
   }
   
+  @Test
+  public void testMessageCtlin() {
+    genericMessageTest("MessageCtlin.pd");
+  }
+  
   @Test
   public void testMessageDiv() {
     genericMessageTest("MessageDiv.pd");
@@ -131,6 +146,16 @@ public class PdObjectTest implements ZenGardenListener {
     genericMessageTest("MessageDelay.pd", 2000.0f);
   }
 
+  @Test
+  public void testMessageEnvelope() {
+    genericMessageTest("MessageEnvelope.pd", 10.0f);
+  }
+
+  @Test
+  public void testMessageEnvelopeSparse() {
+    genericMessageTest("MessageEnvelopeSparse.pd", 10.0f);
+  }
+
   @Test
   public void testMessageEqualsEquals() {
     genericMessageTest("MessageEqualsEquals.pd");
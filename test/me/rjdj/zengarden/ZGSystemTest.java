@@ -23,6 +23,7 @@
 package me.rjdj.zengarden;
 
 import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
 import static org.junit.Assert.assertNotNull;
 import static org.junit.Assert.assertNull;
 import static org.junit.Assert.assertTrue;
@@ -34,7 +35,12 @@ import org.junit.Before;
 import org.junit.Test;
 
 import java.io.File;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.FloatBuffer;
+import java.util.ArrayList;
 import java.util.HashSet;
+import java.util.List;
 
 public class ZGSystemTest {
   
@@ -104,7 +110,142 @@ public class ZGSystemTest {
     obj0.remove(); // remove osc~ alltogether, should remove all remaining connections
     assertEquals(0, obj1.getIncomingConnections(1).size()); // 0 connections at right dac~ inlet
   }
+
+  /**
+   * A [catch~] whose only [throw~] is removed falls silent, and hears a new [throw~] of the same
+   * name.
+   */
+  @Test
+  public void testRemoveThrow() {
+    ZGContext context = new ZGContext(NUM_INPUT_CHANNELS, NUM_OUTPUT_CHANNELS, BLOCK_SIZE, SAMPLE_RATE);
+    ZGGraph graph = context.newGraph();
+    ZGObject osc = graph.addObject("osc~ 440");
+    ZGObject throwObj = graph.addObject("throw~ t");
+    ZGObject catchObj = graph.addObject("catch~ t");
+    ZGObject dac = graph.addObject("dac~");
+    graph.addConnection(osc, 0, throwObj, 0);
+    graph.addConnection(catchObj, 0, dac, 0);
+    graph.addConnection(catchObj, 0, dac, 1);
+    graph.attach();
+    assertTrue(processPeak(context, 4) > 32000);
+    
+    throwObj.remove();
+    assertEquals(0, processPeak(context, 4));
+    
+    throwObj = graph.addObject("throw~ t");
+    graph.addConnection(osc, 0, throwObj, 0);
+    assertTrue(processPeak(context, 4) > 32000);
+  }
   
+  /** Processes the given number of blocks and returns the largest absolute output sample. */
+  private static int processPeak(ZGContext context, int numBlocks) {
+    int peak = 0;
+    for (int i = 0; i < numBlocks; i++) {
+      context.process(INPUT_BUFFER, OUTPUT_BUFFER);
+      for (int j = 0; j < OUTPUT_BUFFER.length; j++) {
+        peak = Math.max(peak, Math.abs(OUTPUT_BUFFER[j]));
+      }
+    }
+    return peak;
+  }
+
+  /**
+   * The edits of a committed transaction are applied together, and removed objects lose all of
+   * their connections.
+   */
+  @Test
+  public void testTransactionCommit() {
+    ZGContext context = new ZGContext(NUM_INPUT_CHANNELS, NUM_OUTPUT_CHANNELS, BLOCK_SIZE, SAMPLE_RATE);
+    ZGGraph graph = context.newGraph();
+    graph.attach();
+    ZGGraphTransaction transaction = graph.beginTransaction();
+    ZGObject obj0 = transaction.addObject("osc~ 440", 0, 0);
+    ZGObject obj1 = transaction.addObject("*~ 0.5", 0, 0);
+    ZGObject obj2 = transaction.addObject("dac~", 0, 0);
+    transaction.addConnection(obj0, 0, obj1, 0);
+    transaction.addConnection(obj1, 0, obj2, 0);
+    assertEquals(0, obj2.getIncomingConnections(0).size()); // nothing is applied before the commit
+    assertTrue(transaction.commit());
+    assertEquals(1, obj0.getOutgoingConnections(0).size()); // 1 connection at osc~ outlet
+    assertEquals(1, obj2.getIncomingConnections(0).size()); // 1 connection at left dac~ inlet
+    context.process(INPUT_BUFFER, OUTPUT_BUFFER);
+
+    // replace *~ with a direct connection
+    transaction = graph.beginTransaction();
+    transaction.removeObject(obj1);
+    transaction.addConnection(obj0, 0, obj2, 1);
+    assertTrue(transaction.commit());
+    assertEquals(1, obj0.getOutgoingConnections(0).size()); // 1 connection at osc~ outlet
+    assertEquals(0, obj2.getIncomingConnections(0).size()); // 0 connections at left dac~ inlet
+    assertEquals(1, obj2.getIncomingConnections(1).size()); // 1 connection at right dac~ inlet
+    context.process(INPUT_BUFFER, OUTPUT_BUFFER);
+  }
+
+  /**
+   * If any edit of a transaction is invalid then none are applied, including those before it.
+   */
+  @Test
+  public void testTransactionRollback() {
+    ZGContext context = new ZGContext(NUM_INPUT_CHANNELS, NUM_OUTPUT_CHANNELS, BLOCK_SIZE, SAMPLE_RATE);
+    ZGGraph graph = context.newGraph();
+    ZGObject obj0 = graph.addObject("osc~ 440");
+    ZGObject obj1 = graph.addObject("dac~");
+    ZGObject obj2 = graph.addObject("float");
+
+    // connects a removed object
+    ZGGraphTransaction transaction = graph.beginTransaction();
+    ZGObject obj3 = transaction.addObject("sig~ 1", 0, 0);
+    transaction.addConnection(obj3, 0, obj1, 1);
+    transaction.addConnection(obj0, 0, obj1, 0);
+    transaction.removeObject(obj0);
+    transaction.addConnection(obj0, 0, obj1, 1);
+    assertFalse(transaction.commit());
+    assertEquals(0, obj0.getOutgoingConnections(0).size()); // 0 connections at osc~ outlet
+    assertEquals(0, obj1.getIncomingConnections(0).size()); // 0 connections at left dac~ inlet
+    assertEquals(0, obj1.getIncomingConnections(1).size()); // 0 connections at right dac~ inlet
+
+    // connects a nonexistent outlet
+    transaction = graph.beginTransaction();
+    transaction.addConnection(obj0, 0, obj1, 0);
+    transaction.addConnection(obj0, 1, obj1, 1);
+    assertFalse(transaction.commit());
+    assertEquals(0, obj0.getOutgoingConnections(0).size()); // 0 connections at osc~ outlet
+
+    // connects a signal outlet to a message inlet
+    transaction = graph.beginTransaction();
+    transaction.addConnection(obj0, 0, obj1, 0);
+    transaction.addConnection(obj0, 0, obj2, 0);
+    assertFalse(transaction.commit());
+    assertEquals(0, obj0.getOutgoingConnections(0).size()); // 0 connections at osc~ outlet
+
+    // the objects are unchanged and can still be connected
+    graph.addConnection(obj0, 0, obj1, 0);
+    assertEquals(1, obj1.getIncomingConnections(0).size()); // 1 connection at left dac~ inlet
+  }
+
+  /**
+   * An aborted transaction applies no edits, and it cannot be used afterwards.
+   */
+  @Test(expected=IllegalStateException.class)
+  public void testTransactionAbort() {
+    ZGContext context = new ZGContext(NUM_INPUT_CHANNELS, NUM_OUTPUT_CHANNELS, BLOCK_SIZE, SAMPLE_RATE);
+    ZGGraph graph = context.newGraph();
+    ZGObject obj0 = graph.addObject("osc~ 440");
+    ZGObject obj1 = graph.addObject("dac~");
+
+    ZGGraphTransaction transaction = graph.beginTransaction();
+    ZGObject obj2 = transaction.addObject("sig~ 1", 0, 0);
+    transaction.addConnection(obj2, 0, obj1, 1);
+    transaction.addConnection(obj0, 0, obj1, 0);
+    transaction.abort();
+    assertEquals(0, obj0.getOutgoingConnections(0).size()); // 0 connections at osc~ outlet
+    assertEquals(0, obj1.getIncomingConnections(0).size()); // 0 connections at left dac~ inlet
+    assertEquals(0, obj1.getIncomingConnections(1).size()); // 0 connections at right dac~ inlet
+
+    // this throws an IllegalStateException, which is expected
+    transaction.commit();
+  }
+
   /**
    * Register the PATCH_TO_TEST receiver and send a message to the TEST_TO_PATCH receiver in the patch.
    * The patch should send the same message back to the test. The PATCH_TO_TEST receiver is then
@@ -163,6 +304,244 @@ public class ZGSystemTest {
     context.process(INPUT_BUFFER, OUTPUT_BUFFER);
   }
   
+  /**
+   * Midi events are delivered in order of their position in the next block, and at its start if the
+   * position is outside of the block. Notes are sent to the receivers of their channel and to the
+   * omni receiver. Notes sent with <code>sendMidiNote()</code> are clamped to the valid range.
+   */
+  @Test
+  public void testSendMidiEvents() {
+    final List<String> receiverNames = new ArrayList<String>();
+    final List<Message> messages = new ArrayList<Message>();
+    ZGContext context = new ZGContext(NUM_INPUT_CHANNELS, NUM_OUTPUT_CHANNELS, BLOCK_SIZE, SAMPLE_RATE);
+    context.addListener(new ZenGardenAdapter() {
+      @Override
+      public void onMessage(String receiverName, Message message) {
+        receiverNames.add(receiverName);
+        messages.add(message);
+      }
+    });
+    context.registerReceiver("zg_notein_omni");
+    context.registerReceiver("zg_notein_3");
+    context.registerReceiver("zg_ctlin");
+    context.registerReceiver("zg_bendin");
+    
+    assertEquals(4, context.sendMidiEvents(
+        new MidiEvent(32.0f, MidiEvent.NOTE, 3, 60, 100),
+        new MidiEvent(8.0f, MidiEvent.CONTROL_CHANGE, 0, 7, 90),
+        new MidiEvent(100.0f, MidiEvent.PITCH_BEND, 1, 10000, 0), // after the end of the block
+        new MidiEvent(-4.0f, MidiEvent.NOTE, 5, 62, 0))); // before the start of the block
+    context.process(INPUT_BUFFER, OUTPUT_BUFFER);
+    
+    double msPerSample = 1000.0 / SAMPLE_RATE;
+    assertMidiMessage("zg_bendin", 0.0, new float[] {10000.0f, 1.0f}, receiverNames.get(0), messages.get(0));
+    assertMidiMessage("zg_notein_omni", 0.0, new float[] {62.0f, 0.0f, 5.0f}, receiverNames.get(1), messages.get(1));
+    assertMidiMessage("zg_ctlin", 8.0 * msPerSample, new float[] {90.0f, 7.0f, 0.0f},
+        receiverNames.get(2), messages.get(2));
+    assertMidiMessage("zg_notein_3", 32.0 * msPerSample, new float[] {60.0f, 100.0f, 3.0f},
+        receiverNames.get(3), messages.get(3));
+    assertMidiMessage("zg_notein_omni", 32.0 * msPerSample, new float[] {60.0f, 100.0f, 3.0f},
+        receiverNames.get(4), messages.get(4));
+    assertEquals(5, messages.size());
+    
+    // the channel, note and velocity are clamped
+    context.sendMidiNote(20, 200, -5, 16.0);
+    context.process(INPUT_BUFFER, OUTPUT_BUFFER);
+    assertMidiMessage("zg_notein_omni", (BLOCK_SIZE + 16.0) * msPerSample, new float[] {127.0f, 0.0f, 15.0f},
+        receiverNames.get(5), messages.get(5));
+    assertEquals(6, messages.size());
+  }
+  
+  private static void assertMidiMessage(String expectedReceiverName, double expectedTimestamp,
+      float[] expectedValues, String receiverName, Message message) {
+    assertEquals(expectedReceiverName, receiverName);
+    assertEquals(expectedTimestamp, message.getTimestamp(), 1e-6);
+    assertEquals(expectedValues.length, message.getNumElements());
+    for (int i = 0; i < expectedValues.length; i++) {
+      assertEquals(expectedValues[i], message.getFloat(i), 0.0f);
+    }
+  }
+  
+  /**
+   * While an outbound queue is enabled, print output and messages to registered receivers are only
+   * delivered by <code>pollOutbound()</code>, in the order in which they were generated. Messages
+   * which do not fit into the queue are dropped and counted. Once the queue is disabled, output is
+   * delivered directly again.
+   */
+  @Test
+  public void testOutboundQueue() {
+    final List<String> events = new ArrayList<String>();
+    ZGContext context = new ZGContext(NUM_INPUT_CHANNELS, NUM_OUTPUT_CHANNELS, BLOCK_SIZE, SAMPLE_RATE);
+    context.addListener(new ZenGardenAdapter() {
+      @Override
+      public void onPrintStd(String message) {
+        events.add(message);
+      }
+      
+      @Override
+      public void onMessage(String receiverName, Message message) {
+        events.add(receiverName + " " + Float.toString(message.getFloat(0)));
+      }
+    });
+    context.registerReceiver(PATCH_TO_TEST);
+    
+    // [t f f] prints each message before sending it on to PATCH_TO_TEST
+    ZGGraph graph = context.newGraph();
+    ZGObject receiveObj = graph.addObject("r " + TEST_TO_PATCH);
+    ZGObject triggerObj = graph.addObject("t f f");
+    ZGObject printObj = graph.addObject("print a");
+    ZGObject sendObj = graph.addObject("s " + PATCH_TO_TEST);
+    graph.addConnection(receiveObj, 0, triggerObj, 0);
+    graph.addConnection(triggerObj, 1, printObj, 0);
+    graph.addConnection(triggerObj, 0, sendObj, 0);
+    graph.attach();
+    
+    context.setOutboundQueueSize(1024);
+    context.sendMessage(TEST_TO_PATCH, new Message(0.0, 1.0f));
+    context.sendMessage(TEST_TO_PATCH, new Message(0.0, 2.0f));
+    context.process(INPUT_BUFFER, OUTPUT_BUFFER);
+    assertEquals(0, events.size()); // nothing is delivered from within process()
+    assertEquals(4, context.pollOutbound());
+    assertEquals("[@ 0.000ms] a: 1", events.get(0));
+    assertEquals(PATCH_TO_TEST + " 1.0", events.get(1));
+    assertEquals("[@ 0.000ms] a: 2", events.get(2));
+    assertEquals(PATCH_TO_TEST + " 2.0", events.get(3));
+    assertEquals(0, context.pollOutbound()); // the queue is empty
+    assertEquals(0, context.getOutboundNumDropped());
+    
+    // a 32 byte queue only has space for the first print record of the block
+    events.clear();
+    context.setOutboundQueueSize(32);
+    for (int i = 0; i < 3; i++) {
+      context.sendMessage(TEST_TO_PATCH, new Message(0.0, 3.0f + i));
+    }
+    context.process(INPUT_BUFFER, OUTPUT_BUFFER);
+    assertEquals(1, context.pollOutbound());
+    assertEquals(5, context.getOutboundNumDropped());
+    assertEquals(1, events.size());
+    assertEquals("[@ 1.451ms] a: 3", events.get(0));
+    
+    // without a queue, output is delivered directly
+    events.clear();
+    context.setOutboundQueueSize(0);
+    context.sendMessage(TEST_TO_PATCH, new Message(0.0, 9.0f));
+    context.process(INPUT_BUFFER, OUTPUT_BUFFER);
+    assertEquals(2, events.size());
+    assertEquals(0, context.pollOutbound());
+    assertEquals(0, context.getOutboundNumDropped());
+  }
+  
+  /**
+   * Messages to a signal object take effect at the start of their control period. Messages within
+   * the same period are applied one after another, such that only the last one is heard. With a
+   * granularity of the block size, all messages of a block are applied at its start.
+   */
+  @Test
+  public void testControlGranularity() {
+    ZGContext context = new ZGContext(NUM_INPUT_CHANNELS, NUM_OUTPUT_CHANNELS, BLOCK_SIZE, SAMPLE_RATE);
+    ZGGraph graph = context.newGraph();
+    ZGObject receiveObj = graph.addObject("r " + TEST_TO_PATCH);
+    ZGObject sigObj = graph.addObject("sig~");
+    ZGObject dacObj = graph.addObject("dac~");
+    graph.addConnection(receiveObj, 0, sigObj, 0);
+    graph.addConnection(sigObj, 0, dacObj, 0);
+    graph.attach();
+    
+    // sample-accurate by default
+    sendRamp(context, 0);
+    context.process(INPUT_BUFFER, OUTPUT_BUFFER);
+    assertLeftOutput(0.0f, 0, 10);
+    assertLeftOutput(0.25f, 10, 12);
+    assertLeftOutput(0.5f, 12, 20);
+    assertLeftOutput(0.75f, 20, BLOCK_SIZE);
+    
+    // the messages at 10 and 12 share the period starting at 8, that at 20 moves to 16
+    context.setControlGranularity(8);
+    sendMessageAt(context, 1, 0, 0.0f);
+    sendRamp(context, 1);
+    context.process(INPUT_BUFFER, OUTPUT_BUFFER);
+    assertLeftOutput(0.0f, 0, 8);
+    assertLeftOutput(0.5f, 8, 16);
+    assertLeftOutput(0.75f, 16, BLOCK_SIZE);
+    
+    // the granularity is limited to the block size
+    context.setControlGranularity(1000);
+    sendMessageAt(context, 2, 0, 0.0f);
+    sendRamp(context, 2);
+    context.process(INPUT_BUFFER, OUTPUT_BUFFER);
+    assertLeftOutput(0.75f, 0, BLOCK_SIZE);
+  }
+  
+  /** Sends 0.25, 0.5 and 0.75 to arrive at samples 10, 12 and 20 of the given block. */
+  private static void sendRamp(ZGContext context, int blockIndex) {
+    sendMessageAt(context, blockIndex, 10, 0.25f);
+    sendMessageAt(context, blockIndex, 12, 0.5f);
+    sendMessageAt(context, blockIndex, 20, 0.75f);
+  }
+  
+  private static void sendMessageAt(ZGContext context, int blockIndex, int sampleIndex, float value) {
+    // half a sample early, such that rounding up to the next sample is robust
+    double timestamp = (blockIndex * BLOCK_SIZE + sampleIndex - 0.5) * 1000.0 / SAMPLE_RATE;
+    context.sendMessage(TEST_TO_PATCH, new Message(Math.max(0.0, timestamp), value));
+  }
+  
+  private static void assertLeftOutput(float expectedValue, int fromIndex, int toIndex) {
+    for (int i = fromIndex; i < toIndex; i++) {
+      assertEquals(expectedValue * 32767.0f, OUTPUT_BUFFER[NUM_OUTPUT_CHANNELS * i], 1.0f);
+    }
+  }
+  
+  /**
+   * Contexts processed by a group produce the same output as a context processed on its own, no
+   * matter how many of the requested worker threads could be started.
+   */
+  @Test
+  public void testContextGroup() {
+    ZGContextGroup group = new ZGContextGroup(4);
+    assertTrue(group.getNumWorkers() >= 1 && group.getNumWorkers() <= 4);
+    
+    ZGContext[] contexts = new ZGContext[6];
+    FloatBuffer[] outputBuffers = new FloatBuffer[contexts.length];
+    for (int i = 0; i < contexts.length; i++) {
+      contexts[i] = newOscillatorContext();
+      outputBuffers[i] = newDirectFloatBuffer(NUM_OUTPUT_CHANNELS * BLOCK_SIZE);
+      group.addContext(contexts[i], newDirectFloatBuffer(NUM_INPUT_CHANNELS * BLOCK_SIZE),
+          outputBuffers[i]);
+    }
+    ZGContext reference = newOscillatorContext();
+    
+    for (int k = 0; k < 16; k++) {
+      group.process();
+      reference.process(INPUT_BUFFER, OUTPUT_BUFFER);
+      for (int i = 0; i < contexts.length; i++) {
+        for (int j = 0; j < BLOCK_SIZE; j++) {
+          // the reference output is 16-bit and channel-interleaved
+          assertEquals(OUTPUT_BUFFER[NUM_OUTPUT_CHANNELS*j] / 32767.0f, outputBuffers[i].get(j), 2.0f / 32767.0f);
+        }
+      }
+    }
+    
+    for (int i = 0; i < contexts.length; i++) {
+      group.removeContext(contexts[i]);
+    }
+  }
+  
+  /** Returns a context with an attached graph playing a 440Hz sine on all output channels. */
+  private ZGContext newOscillatorContext() {
+    ZGContext context = new ZGContext(NUM_INPUT_CHANNELS, NUM_OUTPUT_CHANNELS, BLOCK_SIZE, SAMPLE_RATE);
+    ZGGraph graph = context.newGraph();
+    ZGObject osc = graph.addObject("osc~ 440");
+    ZGObject dac = graph.addObject("dac~");
+    graph.addConnection(osc, 0, dac, 0);
+    graph.addConnection(osc, 0, dac, 1);
+    graph.attach();
+    return context;
+  }
+  
+  private static FloatBuffer newDirectFloatBuffer(int length) {
+    return ByteBuffer.allocateDirect(4 * length).order(ByteOrder.nativeOrder()).asFloatBuffer();
+  }
+  
   @Test(expected=IllegalArgumentException.class)
   public void testMessage() {
     Message message = new Message(0.0, 0.5f);